@@ -1,11 +1,26 @@
 #include "byte_sink.hpp"
 
+#include <cerrno>
+#include <cstdio>
 #include <iostream>
+#include <sys/uio.h>
+#include <unistd.h>
 
 namespace silva {
   // stream_t
 
-  void byte_sink_t::write(span_t<const byte_t> data)
+  void byte_sink_t::write(const span_t<const byte_t> data)
+  {
+    if (data.size() <= span.size()) {
+      std::copy(data.begin(), data.end(), span.begin());
+      span = span.subspan(data.size());
+    }
+    else {
+      on_write_overflow(data);
+    }
+  }
+
+  void byte_sink_t::on_write_overflow(span_t<const byte_t> data)
   {
     bool first = true;
     while (!data.empty()) {
@@ -20,31 +35,207 @@ namespace silva {
     }
   }
 
+  void byte_sink_t::flush() {}
+
   void byte_sink_t::write_str(string_view_t data)
   {
     return write(span_t<const byte_t>((const byte_t*)data.data(), data.size()));
   }
 
-  // stream_stdout_t
+  void byte_sink_t::vformat(const fmt::string_view fmt, const fmt::format_args args)
+  {
+    const size_t size = fmt::vformat_to_n((char*)span.data(), span.size(), fmt, args).size;
+    if (size > span.size()) {
+      // Whatever was formatted into "span" so far is not part of the content yet, so it may be
+      // dropped by on_out_of_span().
+      on_out_of_span(size);
+      if (size > span.size()) {
+        fmt::memory_buffer temp;
+        fmt::vformat_to(fmt::appender(temp), fmt, args);
+        write_str(string_view_t{temp.data(), temp.size()});
+        return;
+      }
+      fmt::vformat_to_n((char*)span.data(), span.size(), fmt, args);
+    }
+    span = span.subspan(size);
+  }
+
+  namespace {
+    // Writes all of "iov" to "fd", continuing after partial writes and interrupts. Returns the
+    // errno of the first failed write, zero otherwise.
+    int fd_write_all(const int fd, span_t<iovec> iov)
+    {
+      while (!iov.empty()) {
+        const ssize_t written = ::writev(fd, iov.data(), iov.size());
+        if (written < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          return errno;
+        }
+        size_t left = written;
+        while (!iov.empty() && left >= iov.front().iov_len) {
+          left -= iov.front().iov_len;
+          iov = iov.subspan(1);
+        }
+        if (!iov.empty()) {
+          iov.front().iov_base = (char*)iov.front().iov_base + left;
+          iov.front().iov_len -= left;
+        }
+      }
+      return 0;
+    }
+
+    int fd_write_all(const int fd,
+                     const span_t<const byte_t> first,
+                     const span_t<const byte_t> second)
+    {
+      array_fixed_t<iovec, 2> iov{{
+          {.iov_base = (void*)first.data(), .iov_len = first.size()},
+          {.iov_base = (void*)second.data(), .iov_len = second.size()},
+      }};
+      return fd_write_all(fd, iov);
+    }
+  }
+
+  // byte_sink_fd_t
 
-  byte_sink_stdout_t::byte_sink_stdout_t(const index_t init_buffer_size) : buffer(init_buffer_size)
+  byte_sink_fd_t::byte_sink_fd_t(const int fd, const index_t init_buffer_size)
+    : fd(fd), buffer(std::max(init_buffer_size, index_t(1)))
   {
     span = buffer;
   }
-  byte_sink_stdout_t::~byte_sink_stdout_t()
+  byte_sink_fd_t::~byte_sink_fd_t()
   {
-    on_out_of_span();
+    flush();
   }
 
-  void byte_sink_stdout_t::on_out_of_span(const index_t size_hint)
+  void byte_sink_fd_t::write_fd(const span_t<const byte_t> first,
+                                const span_t<const byte_t> second)
+  {
+    if (error_number != 0) {
+      return;
+    }
+    if (sync_stdio) {
+      std::cout.flush();
+      std::fflush(stdout);
+    }
+    error_number = fd_write_all(fd, first, second);
+  }
+
+  void byte_sink_fd_t::flush()
   {
     const index_t curr_used = buffer.size() - span.size();
-    const string_view_t data((const char*)buffer.data(), curr_used);
-    std::cout << data << std::flush;
-    buffer.resize(std::max<index_t>(size_hint, buffer.size()));
+    write_fd(span_t<const byte_t>(buffer).subspan(0, curr_used), {});
     span = buffer;
   }
 
+  void byte_sink_fd_t::on_out_of_span(const index_t)
+  {
+    // Data that doesn't fit into the buffer goes through on_write_overflow(), so there's no need
+    // to grow the buffer.
+    flush();
+  }
+
+  void byte_sink_fd_t::on_write_overflow(const span_t<const byte_t> data)
+  {
+    if (data.size() < buffer.size()) {
+      byte_sink_t::on_write_overflow(data);
+    }
+    else {
+      const index_t curr_used = buffer.size() - span.size();
+      write_fd(span_t<const byte_t>(buffer).subspan(0, curr_used), data);
+      span = buffer;
+    }
+  }
+
+  // byte_sink_stdout_t
+
+  byte_sink_stdout_t::byte_sink_stdout_t(const index_t init_buffer_size)
+    : byte_sink_fd_t(STDOUT_FILENO, init_buffer_size)
+  {
+    sync_stdio = true;
+  }
+
+  // byte_sink_fd_async_t
+
+  byte_sink_fd_async_t::byte_sink_fd_async_t(const int fd, const index_t init_buffer_size)
+    : fd(fd)
+    , buffer(std::max(init_buffer_size, index_t(1)))
+    , pending(buffer.size())
+    , writer([this] { writer_loop(); })
+  {
+    span = buffer;
+  }
+  byte_sink_fd_async_t::~byte_sink_fd_async_t()
+  {
+    flush();
+    {
+      std::lock_guard lock(mutex);
+      stop = true;
+    }
+    cv.notify_all();
+    writer.join();
+  }
+
+  int byte_sink_fd_async_t::error_number() const
+  {
+    std::lock_guard lock(mutex);
+    return _error_number;
+  }
+
+  void byte_sink_fd_async_t::hand_over(const index_t size_hint)
+  {
+    const index_t curr_used = buffer.size() - span.size();
+    if (curr_used > 0) {
+      {
+        std::unique_lock lock(mutex);
+        cv.wait(lock, [this] { return !has_pending; });
+        std::swap(buffer, pending);
+        pending_size = curr_used;
+        has_pending  = true;
+      }
+      cv.notify_all();
+    }
+    if (index_t(buffer.size()) < size_hint) {
+      buffer.resize(size_hint);
+    }
+    span = buffer;
+  }
+
+  void byte_sink_fd_async_t::flush()
+  {
+    hand_over(0);
+    std::unique_lock lock(mutex);
+    cv.wait(lock, [this] { return !has_pending; });
+  }
+
+  void byte_sink_fd_async_t::on_out_of_span(const index_t size_hint)
+  {
+    hand_over(size_hint);
+  }
+
+  void byte_sink_fd_async_t::writer_loop()
+  {
+    std::unique_lock lock(mutex);
+    while (true) {
+      cv.wait(lock, [this] { return has_pending || stop; });
+      if (!has_pending) {
+        return;
+      }
+      const bool skip = (_error_number != 0);
+      lock.unlock();
+      const auto data = span_t<const byte_t>(pending).subspan(0, pending_size);
+      const int rv    = skip ? 0 : fd_write_all(fd, data, {});
+      lock.lock();
+      if (rv != 0) {
+        _error_number = rv;
+      }
+      has_pending = false;
+      cv.notify_all();
+    }
+  }
+
   // stream_memory_t
 
   byte_sink_memory_t::byte_sink_memory_t(const index_t init_buffer_size) : buffer(init_buffer_size)
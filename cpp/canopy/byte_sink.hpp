@@ -3,7 +3,10 @@
 #include "array.hpp"
 #include "string.hpp"
 
+#include <condition_variable>
 #include <fmt/format.h>
+#include <mutex>
+#include <thread>
 
 namespace silva {
   struct byte_sink_t {
@@ -12,21 +15,94 @@ namespace silva {
     void write(span_t<const byte_t>);
     void write_str(string_view_t);
 
+    // Formats directly into "span". Only if the result doesn't fit even after on_out_of_span() is
+    // it formatted into a temporary buffer and passed to write().
     template<typename... T>
     void format(fmt::format_string<T...> fmt, T&&... args);
+    void vformat(fmt::string_view fmt, fmt::format_args args);
 
     static constexpr index_t min_buffer_size = 64;
 
+    // Default buffer size of the sinks that pass their content on to a file descriptor.
+    static constexpr index_t default_fd_buffer_size = 64 * 1024;
+
+    // Passes on the content in front of "span" (if the sink does that) and makes "span" non-empty
+    // again, at least "size_hint" bytes if possible.
     virtual void on_out_of_span(index_t size_hint = 0) = 0;
+
+    // Called by write() for data that doesn't fit into "span". By default, the data is copied into
+    // "span" piece by piece, calling on_out_of_span() in between.
+    virtual void on_write_overflow(span_t<const byte_t>);
+
+    // Passes on everything written so far, for sinks that pass their content on at all (e.g.,
+    // before waiting for input that the output asked for). Does nothing by default.
+    virtual void flush();
   };
 
-  struct byte_sink_stdout_t : public byte_sink_t {
+  // Writes to a file descriptor once the buffer is full. Data that is at least as large as the
+  // buffer is passed to writev() together with the buffered data, without being copied.
+  struct byte_sink_fd_t : public byte_sink_t {
+    int fd = -1;
     array_t<byte_t> buffer;
 
-    byte_sink_stdout_t(index_t init_buffer_size = min_buffer_size);
-    ~byte_sink_stdout_t();
+    // If set, the stdio and iostream buffers are flushed before each write to "fd". So output that
+    // went through them before it was written to this sink also comes out before it. Output that
+    // went through them later but before the next flush() of this sink still comes out first.
+    bool sync_stdio = false;
+
+    // The errno of the first failed write. Once set, all further output is dropped.
+    int error_number = 0;
+
+    explicit byte_sink_fd_t(int fd, index_t init_buffer_size = default_fd_buffer_size);
+    ~byte_sink_fd_t();
+
+    void flush() override;
+
+    void on_out_of_span(index_t = 0) override;
+    void on_write_overflow(span_t<const byte_t>) override;
+
+   private:
+    void write_fd(span_t<const byte_t> first, span_t<const byte_t> second);
+  };
+
+  struct byte_sink_stdout_t : public byte_sink_fd_t {
+    byte_sink_stdout_t(index_t init_buffer_size = default_fd_buffer_size);
+  };
+
+  // Like byte_sink_fd_t, but the writes happen on a background thread. The sink has two buffers:
+  // while one of them is being written, the other one is filled. Producers only wait for I/O if
+  // they fill a buffer faster than the background thread writes the other one.
+  struct byte_sink_fd_async_t : public byte_sink_t {
+    int fd = -1;
+
+    explicit byte_sink_fd_async_t(int fd, index_t init_buffer_size = default_fd_buffer_size);
+    ~byte_sink_fd_async_t();
+
+    // Waits until everything that was written to the sink so far has been written to "fd".
+    void flush() override;
+
+    // The errno of the first failed write. Once set, all further output is dropped.
+    int error_number() const;
 
     void on_out_of_span(index_t = 0) final;
+
+   private:
+    array_t<byte_t> buffer;
+
+    // Only accessed by the background thread while "has_pending" is set.
+    array_t<byte_t> pending;
+    index_t pending_size = 0;
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    bool has_pending  = false;
+    bool stop         = false;
+    int _error_number = 0;
+
+    std::jthread writer;
+
+    void hand_over(index_t size_hint);
+    void writer_loop();
   };
 
   struct byte_sink_memory_t : public byte_sink_t {
@@ -52,7 +128,6 @@ namespace silva {
   template<typename... Args>
   void byte_sink_t::format(fmt::format_string<Args...> fmt, Args&&... args)
   {
-    const auto temp = fmt::format(fmt, std::forward<Args>(args)...);
-    write_str(temp);
+    vformat(fmt, fmt::make_format_args(args...));
   }
 }
@@ -1,7 +1,13 @@
 #include "byte_sink.hpp"
 
+#include "time.hpp"
+
 #include <catch2/catch_all.hpp>
 
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
 namespace silva::test {
   TEST_CASE("stream_stdout_t")
   {
@@ -20,4 +26,83 @@ namespace silva::test {
       CHECK(byte_sink.content_str() == "Hello 42 World\nTest\n");
     }
   }
+
+  namespace {
+    // Writes lines of varying length, some of them larger than the buffer of the sink, to a
+    // temporary file and compares the file's content with the expected output.
+    template<typename ByteSink>
+    void test_fd_sink(const index_t init_buf_size)
+    {
+      std::FILE* file = std::tmpfile();
+      REQUIRE(file != nullptr);
+      string_t expected;
+      {
+        ByteSink byte_sink(fileno(file), init_buf_size);
+        for (index_t i = 0; i < 1'000; ++i) {
+          const string_t padding(i % 300, 'x');
+          byte_sink.format("line {} {}\n", i, padding);
+          expected += fmt::format("line {} {}\n", i, padding);
+        }
+        const string_t large(100'000, 'y');
+        byte_sink.write_str(large);
+        byte_sink.write_str("end");
+        expected += large;
+        expected += "end";
+      }
+      string_t actual;
+      std::rewind(file);
+      for (int c = std::fgetc(file); c != EOF; c = std::fgetc(file)) {
+        actual.push_back(char(c));
+      }
+      std::fclose(file);
+      CHECK(actual == expected);
+    }
+  }
+
+  TEST_CASE("byte_sink_fd_t", "[byte_sink_fd_t]")
+  {
+    for (const index_t init_buf_size: {1, 4, 64, 1'000, 64 * 1'024}) {
+      INFO("init_buf_size = " << init_buf_size);
+      test_fd_sink<byte_sink_fd_t>(init_buf_size);
+      test_fd_sink<byte_sink_fd_async_t>(init_buf_size);
+    }
+  }
+
+  TEST_CASE("byte-sink-performance", "[byte_sink_t][.]")
+  {
+    constexpr index_t num_lines = 10'000'000;
+    const int fd                = ::open("/dev/null", O_WRONLY);
+    REQUIRE(fd >= 0);
+    const auto run = [&](const string_view_t name, auto&& func) {
+      const auto start = time_point_t::now();
+      func();
+      const auto end = time_point_t::now();
+      fmt::println("{:40} {}", name, end - start);
+    };
+    run("byte_sink_fd_t, fmt::format + write_str", [&] {
+      byte_sink_fd_t byte_sink(fd);
+      for (index_t i = 0; i < num_lines; ++i) {
+        byte_sink.write_str(fmt::format("line {} of {}\n", i, num_lines));
+      }
+    });
+    run("byte_sink_fd_t", [&] {
+      byte_sink_fd_t byte_sink(fd);
+      for (index_t i = 0; i < num_lines; ++i) {
+        byte_sink.format("line {} of {}\n", i, num_lines);
+      }
+    });
+    run("byte_sink_fd_async_t", [&] {
+      byte_sink_fd_async_t byte_sink(fd);
+      for (index_t i = 0; i < num_lines; ++i) {
+        byte_sink.format("line {} of {}\n", i, num_lines);
+      }
+    });
+    run("byte_sink_memory_t", [&] {
+      byte_sink_memory_t byte_sink;
+      for (index_t i = 0; i < num_lines; ++i) {
+        byte_sink.format("line {} of {}\n", i, num_lines);
+      }
+    });
+    ::close(fd);
+  }
 }
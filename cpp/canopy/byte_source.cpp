@@ -0,0 +1,209 @@
+#include "byte_source.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace silva {
+  // byte_source_t
+
+  bool byte_source_t::ensure(const index_t size)
+  {
+    while (index_t(span.size()) < size && !is_eof) {
+      on_read_more(size);
+    }
+    return index_t(span.size()) >= size;
+  }
+
+  optional_t<byte_t> byte_source_t::peek()
+  {
+    if (!ensure(1)) {
+      return std::nullopt;
+    }
+    return span.front();
+  }
+
+  span_t<const byte_t> byte_source_t::peek(const index_t size)
+  {
+    ensure(size);
+    return span.first(std::min<size_t>(size, span.size()));
+  }
+
+  optional_t<byte_t> byte_source_t::get()
+  {
+    if (!ensure(1)) {
+      return std::nullopt;
+    }
+    const byte_t retval = span.front();
+    span                = span.subspan(1);
+    return retval;
+  }
+
+  bool byte_source_t::read_until(const byte_t delimiter, string_t& out)
+  {
+    while (true) {
+      const void* found =
+          span.empty() ? nullptr : std::memchr(span.data(), int(delimiter), span.size());
+      const size_t size =
+          found != nullptr ? (static_cast<const byte_t*>(found) - span.data()) + 1 : span.size();
+      out.append((const char*)span.data(), size);
+      span = span.subspan(size);
+      if (found != nullptr) {
+        return true;
+      }
+      if (is_eof) {
+        return false;
+      }
+      on_read_more();
+    }
+  }
+
+  string_t byte_source_t::read_all()
+  {
+    string_t retval;
+    while (true) {
+      retval.append((const char*)span.data(), span.size());
+      span = {};
+      if (is_eof) {
+        return retval;
+      }
+      on_read_more();
+    }
+  }
+
+  // byte_source_fd_t
+
+  byte_source_fd_t::byte_source_fd_t(const int fd, const index_t init_buffer_size)
+    : fd(fd), buffer(std::max(init_buffer_size, min_buffer_size))
+  {
+  }
+
+  void byte_source_fd_t::on_read_more(const index_t size_hint)
+  {
+    // The unconsumed bytes are moved to the front of the buffer, the rest is filled from "fd".
+    const index_t kept = span.size();
+    if (kept > 0 && span.data() != buffer.data()) {
+      std::memmove(buffer.data(), span.data(), kept);
+    }
+    const index_t wanted = std::max(size_hint, index_t(1));
+    if (index_t(buffer.size()) < kept + wanted) {
+      buffer.resize(std::max<index_t>(kept + wanted, buffer.size() * 2));
+    }
+    index_t filled = kept;
+    while (filled < kept + wanted) {
+      const ssize_t rv = ::read(fd, buffer.data() + filled, buffer.size() - filled);
+      if (rv < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        error_number = errno;
+        is_eof       = true;
+        break;
+      }
+      if (rv == 0) {
+        is_eof = true;
+        break;
+      }
+      filled += rv;
+    }
+    span = span_t<const byte_t>(buffer).subspan(0, filled);
+  }
+
+  // byte_source_stdin_t
+
+  byte_source_stdin_t::byte_source_stdin_t(const index_t init_buffer_size)
+    : byte_source_fd_t(STDIN_FILENO, init_buffer_size)
+  {
+  }
+
+  // byte_source_file_t
+
+  byte_source_file_t::byte_source_file_t(const int fd, const index_t init_buffer_size)
+    : byte_source_fd_t(fd, init_buffer_size)
+  {
+  }
+  byte_source_file_t::~byte_source_file_t()
+  {
+    ::close(fd);
+  }
+
+  expected_t<unique_ptr_t<byte_source_file_t>>
+  byte_source_file_t::open(const filepath_t& filepath, const index_t init_buffer_size)
+  {
+    const int fd = ::open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+    SILVA_EXPECT(fd >= 0,
+                 MINOR,
+                 "Could not open file '{}' for reading: {}",
+                 filepath.string(),
+                 std::strerror(errno));
+    // Only a hint, so failure is not an error.
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    return unique_ptr_t<byte_source_file_t>(new byte_source_file_t(fd, init_buffer_size));
+  }
+
+  // byte_source_mmap_t
+
+  byte_source_mmap_t::~byte_source_mmap_t()
+  {
+    if (mapping != nullptr) {
+      ::munmap(mapping, mapping_size);
+    }
+  }
+
+  expected_t<unique_ptr_t<byte_source_mmap_t>> byte_source_mmap_t::open(const filepath_t& filepath)
+  {
+    const int fd = ::open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+    SILVA_EXPECT(fd >= 0,
+                 MINOR,
+                 "Could not open file '{}' for reading: {}",
+                 filepath.string(),
+                 std::strerror(errno));
+    struct stat st{};
+    const int rv_stat = ::fstat(fd, &st);
+    if (rv_stat != 0 || !S_ISREG(st.st_mode)) {
+      ::close(fd);
+      SILVA_EXPECT(false, MINOR, "Could not map '{}', it is not a regular file", filepath.string());
+    }
+    unique_ptr_t<byte_source_mmap_t> retval(new byte_source_mmap_t);
+    if (st.st_size > 0) {
+      void* mapping        = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      const int mmap_errno = errno;
+      ::close(fd);
+      SILVA_EXPECT(mapping != MAP_FAILED,
+                   MINOR,
+                   "Could not map file '{}': {}",
+                   filepath.string(),
+                   std::strerror(mmap_errno));
+      ::madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+      retval->mapping      = mapping;
+      retval->mapping_size = st.st_size;
+      retval->span         = span_t<const byte_t>(static_cast<const byte_t*>(mapping), st.st_size);
+    }
+    else {
+      ::close(fd);
+    }
+    retval->is_eof = true;
+    return retval;
+  }
+
+  void byte_source_mmap_t::on_read_more(const index_t)
+  {
+    is_eof = true;
+  }
+
+  // byte_source_memory_t
+
+  byte_source_memory_t::byte_source_memory_t(string_t content) : buffer(std::move(content))
+  {
+    span   = span_t<const byte_t>((const byte_t*)buffer.data(), buffer.size());
+    is_eof = true;
+  }
+
+  void byte_source_memory_t::on_read_more(const index_t)
+  {
+    is_eof = true;
+  }
+}
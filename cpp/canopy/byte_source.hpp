@@ -1,39 +1,101 @@
 #pragma once
 
+#include "array.hpp"
 #include "expected.hpp"
 #include "types.hpp"
 
-#include <fmt/format.h>
-
 namespace silva {
   struct byte_source_t {
-    span_t<byte_t> span;
+    // Bytes that were read ahead but haven't been consumed yet.
+    span_t<const byte_t> span;
+
+    // Set once on_read_more() found nothing more to read. There may still be bytes in "span".
     bool is_eof = false;
 
     static constexpr index_t min_buffer_size = 64;
 
+    // Default buffer size of the sources that read from a file descriptor.
+    static constexpr index_t default_fd_buffer_size = 256 * 1024;
+
+    virtual ~byte_source_t() = default;
+
+    // Reads more bytes into "span", keeping the ones that are still in there, if possible until
+    // "span" has at least "size_hint" bytes. Sets "is_eof" if there was nothing more to read.
     virtual void on_read_more(index_t size_hint = 0) = 0;
+
+    // Reads until "span" has at least "size" bytes or the end is reached. Returns whether "span"
+    // has at least "size" bytes.
+    bool ensure(index_t size);
+
+    // The next byte or the next "size" bytes (fewer at the end), without consuming them. The
+    // returned span is valid until the next call to on_read_more().
+    optional_t<byte_t> peek();
+    span_t<const byte_t> peek(index_t size);
+
+    // Consumes the next byte.
+    optional_t<byte_t> get();
+
+    // Consumes the bytes up to and including the next "delimiter", or up to the end, and appends
+    // them to "out". Returns whether "delimiter" was found.
+    bool read_until(byte_t delimiter, string_t& out);
+
+    // Consumes everything that is left.
+    string_t read_all();
   };
 
-  struct byte_source_stdin_t : public byte_source_t {
-    vector_t<byte_t> buffer;
+  // Reads from a file descriptor with read(), up to "buffer.size()" bytes at a time.
+  struct byte_source_fd_t : public byte_source_t {
+    int fd = -1;
+    array_t<byte_t> buffer;
 
-    byte_source_stdin_t(index_t init_buffer_size = min_buffer_size);
-    ~byte_source_stdin_t();
+    // The errno of the first failed read, which also sets "is_eof".
+    int error_number = 0;
 
-    void on_read_more(index_t = 0) final;
+    explicit byte_source_fd_t(int fd, index_t init_buffer_size = default_fd_buffer_size);
+
+    void on_read_more(index_t = 0) override;
   };
 
-  struct byte_source_memory_t : public byte_source_t {
-    vector_t<byte_t> buffer;
+  struct byte_source_stdin_t : public byte_source_fd_t {
+    byte_source_stdin_t(index_t init_buffer_size = default_fd_buffer_size);
+  };
 
-    byte_source_memory_t(index_t init_buffer_size = min_buffer_size);
+  // Owns the file descriptor of a file that was opened for sequential reading.
+  struct byte_source_file_t : public byte_source_fd_t {
+    ~byte_source_file_t();
+
+    // Errors:
+    //  - MINOR: File could not be opened.
+    static expected_t<unique_ptr_t<byte_source_file_t>>
+    open(const filepath_t&, index_t init_buffer_size = default_fd_buffer_size);
+
+   private:
+    byte_source_file_t(int fd, index_t init_buffer_size);
+  };
+
+  // Maps a regular file into memory. "span" covers the whole file right away, so there are no
+  // copies and no system calls while reading.
+  struct byte_source_mmap_t : public byte_source_t {
+    ~byte_source_mmap_t();
+
+    // Errors:
+    //  - MINOR: File could not be opened, is not a regular file, or could not be mapped.
+    static expected_t<unique_ptr_t<byte_source_mmap_t>> open(const filepath_t&);
 
     void on_read_more(index_t = 0) final;
+
+   private:
+    void* mapping       = nullptr;
+    size_t mapping_size = 0;
+
+    byte_source_mmap_t() = default;
   };
-}
 
-// IMPLEMENTATION
+  struct byte_source_memory_t : public byte_source_t {
+    string_t buffer;
 
-namespace silva {
+    explicit byte_source_memory_t(string_t content);
+
+    void on_read_more(index_t = 0) final;
+  };
 }
@@ -0,0 +1,132 @@
+#include "byte_source.hpp"
+
+#include "filesystem.hpp"
+#include "time.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace silva::test {
+  namespace {
+    string_t make_lines(const index_t num_lines)
+    {
+      string_t retval;
+      for (index_t i = 0; i < num_lines; ++i) {
+        retval += fmt::format("line {}\n", i);
+      }
+      return retval;
+    }
+
+    void check_read_until(byte_source_t& source, const string_t& expected)
+    {
+      string_t actual;
+      index_t num_lines = 0;
+      while (source.read_until(byte_t('\n'), actual)) {
+        num_lines += 1;
+      }
+      CHECK(num_lines == std::ranges::count(expected, '\n'));
+      CHECK(actual == expected);
+      CHECK(!source.get().has_value());
+    }
+  }
+
+  TEST_CASE("byte-source", "[byte_source_t]")
+  {
+    temp_dir_t td;
+    const filepath_t path       = td.get_dir_path() / "lines.txt";
+    const filepath_t path_empty = td.get_dir_path() / "empty.txt";
+    const string_t content      = make_lines(10'000);
+    SILVA_REQUIRE(write_file(path, content));
+    SILVA_REQUIRE(write_file(path_empty, ""));
+
+    for (const index_t init_buffer_size: {1, 7, 64, 4'096}) {
+      INFO("init_buffer_size = " << init_buffer_size);
+      auto source = SILVA_REQUIRE(byte_source_file_t::open(path, init_buffer_size));
+      CHECK(source->peek() == byte_t('l'));
+      CHECK(source->peek(4).size() == 4);
+      check_read_until(*source, content);
+    }
+    {
+      auto source = SILVA_REQUIRE(byte_source_file_t::open(path, 5));
+      CHECK(source->ensure(100));
+      CHECK(source->span.size() >= 100);
+      CHECK(!source->ensure(content.size() + 1));
+      CHECK(source->is_eof);
+      CHECK(source->error_number == 0);
+      CHECK(source->read_all() == content);
+    }
+    {
+      auto source = SILVA_REQUIRE(byte_source_mmap_t::open(path));
+      CHECK(source->span.size() == content.size());
+      check_read_until(*source, content);
+    }
+    {
+      auto source = SILVA_REQUIRE(byte_source_mmap_t::open(path_empty));
+      CHECK(source->read_all() == "");
+    }
+    CHECK(!byte_source_mmap_t::open(td.get_dir_path() / "missing.txt").has_value());
+    CHECK(!byte_source_mmap_t::open("/dev/null").has_value());
+    CHECK(SILVA_REQUIRE(read_file(path)) == content);
+    CHECK(SILVA_REQUIRE(read_file("/dev/null")) == "");
+    CHECK(SILVA_REQUIRE(read_file(path_empty)) == "");
+    if (std::filesystem::exists("/proc/self/status")) {
+      CHECK(SILVA_REQUIRE(read_file("/proc/self/status")).starts_with("Name:"));
+    }
+    {
+      byte_source_memory_t source(content);
+      check_read_until(source, content);
+    }
+  }
+
+  TEST_CASE("byte-source-performance", "[byte_source_t][.]")
+  {
+    temp_dir_t td;
+    const filepath_t path  = td.get_dir_path() / "lines.txt";
+    const string_t content = make_lines(10'000'000);
+    SILVA_REQUIRE(write_file(path, content));
+
+    const auto run = [&](const string_view_t name, auto&& func) {
+      const auto start       = time_point_t::now();
+      const index_t checksum = func();
+      const auto end         = time_point_t::now();
+      fmt::println("{:40} {}  ({})", name, end - start, checksum);
+    };
+    run("std::getc", [&] {
+      std::FILE* file = std::fopen(path.c_str(), "r");
+      index_t retval  = 0;
+      for (int c = std::getc(file); c != EOF; c = std::getc(file)) {
+        retval += c;
+      }
+      std::fclose(file);
+      return retval;
+    });
+    run("byte_source_file_t::get", [&] {
+      auto source    = SILVA_REQUIRE(byte_source_file_t::open(path));
+      index_t retval = 0;
+      while (const auto next = source->get()) {
+        retval += std::to_integer<index_t>(*next);
+      }
+      return retval;
+    });
+    run("byte_source_mmap_t::get", [&] {
+      auto source    = SILVA_REQUIRE(byte_source_mmap_t::open(path));
+      index_t retval = 0;
+      while (const auto next = source->get()) {
+        retval += std::to_integer<index_t>(*next);
+      }
+      return retval;
+    });
+    run("byte_source_file_t::read_until", [&] {
+      auto source    = SILVA_REQUIRE(byte_source_file_t::open(path));
+      index_t retval = 0;
+      string_t line;
+      while (source->read_until(byte_t('\n'), line)) {
+        retval += line.size();
+        line.clear();
+      }
+      return retval;
+    });
+  }
+}
@@ -3,11 +3,24 @@
 #include "sprite.hpp"
 
 namespace silva {
+  template<typename T>
+  class context_capture_t;
+
+  template<typename T>
+  class context_adopt_t;
+
+  // Each thread has its own stack of contexts. If "T::context_use_default" is set, the bottom of
+  // each thread's stack is a default-constructed T that is owned by that thread. Work that is
+  // handed to another thread doesn't see the contexts of the thread that handed it over, unless
+  // they are carried along with context_capture_t and context_adopt_t.
   template<typename T>
   class context_t : public menhir_t {
     T* parent = nullptr;
 
-    static T* current;
+    friend class context_capture_t<T>;
+    friend class context_adopt_t<T>;
+
+    static thread_local T* current;
     static T* init_current();
     T* get_pointer();
 
@@ -24,13 +37,44 @@ namespace silva {
     static ptr_t<const T> get()
       requires(!T::context_mutable_get);
   };
+
+  // The context of type T that is current on the thread constructing the context_capture_t. The
+  // captured context must outlive all context_adopt_t that make it current.
+  template<typename T>
+  class context_capture_t {
+    T* captured = context_t<T>::current;
+
+    friend class context_adopt_t<T>;
+
+   public:
+    context_capture_t() = default;
+
+    // Like context_t<T>::get(), but for the captured context.
+    auto get() const;
+  };
+
+  // Makes a captured context current on the calling thread, on top of whatever was current before,
+  // until the context_adopt_t is destroyed. Several threads may adopt the same context at the same
+  // time, so this is only safe if nobody modifies the context meanwhile. Mutable contexts (e.g.,
+  // ones that collect results) should rather be created once per thread and merged afterwards.
+  template<typename T>
+  class context_adopt_t {
+    T* prev = nullptr;
+
+   public:
+    explicit context_adopt_t(const context_capture_t<T>&);
+    ~context_adopt_t();
+
+    context_adopt_t(const context_adopt_t&)            = delete;
+    context_adopt_t& operator=(const context_adopt_t&) = delete;
+  };
 }
 
 // IMPLEMENTATION
 
 namespace silva {
   template<typename T>
-  T* context_t<T>::current = context_t<T>::init_current();
+  thread_local T* context_t<T>::current = context_t<T>::init_current();
 
   template<typename T>
   T* context_t<T>::init_current()
@@ -42,7 +86,7 @@ namespace silva {
     });
 
     if constexpr (T::context_use_default) {
-      static T default_context{};
+      static thread_local T default_context{};
       return &default_context;
     }
     else {
@@ -102,4 +146,24 @@ namespace silva {
       return current ? current->get_pointer()->ptr() : nullptr;
     }
   }
+
+  template<typename T>
+  auto context_capture_t<T>::get() const
+  {
+    using result_t = std::conditional_t<T::context_mutable_get, ptr_t<T>, ptr_t<const T>>;
+    return captured ? result_t{captured->ptr()} : result_t{};
+  }
+
+  template<typename T>
+  context_adopt_t<T>::context_adopt_t(const context_capture_t<T>& capture)
+    : prev(context_t<T>::current)
+  {
+    context_t<T>::current = capture.captured;
+  }
+
+  template<typename T>
+  context_adopt_t<T>::~context_adopt_t()
+  {
+    context_t<T>::current = prev;
+  }
 }
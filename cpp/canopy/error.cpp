@@ -7,18 +7,121 @@
 #include <utility>
 
 namespace silva {
-  string_t to_string(const error_tree_t::node_t& node,
-                     const any_vector_t<pretty_string_t, move_ctor_t, dtor_t>& av)
+  string_t to_string(const error_tree_t::node_t& node, const memento_vector_t& av)
   {
     array_t<string_t> args;
+    if (node.site != nullptr && !node.site->format.empty()) {
+      args.emplace_back(node.site->format);
+    }
     const auto end = av.index_iter_at(node.memento_buffer_offset_end);
     for (auto it = av.index_iter_at(node.memento_buffer_offset); it != end; ++it) {
       args.push_back(av.apply(*it, silva::pretty_string));
     }
+    if (node.site != nullptr && args.empty()) {
+      return node.site->default_message();
+    }
     string_t message = format_vector(args);
     return message;
   }
 
+  namespace impl {
+    index_t copy_subtree_materialized(const error_tree_t& tree,
+                                      const memento_vector_t& any_vector,
+                                      const index_t root,
+                                      error_tree_t& new_tree,
+                                      memento_vector_t& new_any_vector)
+    {
+      const error_tree_t::node_t& root_node = tree.nodes[root];
+      hash_map_t<any_vector_index_t, any_vector_index_t> offset_mapping;
+      {
+        const auto end = any_vector.index_iter_at(root_node.memento_buffer_offset_end);
+        for (auto ai = any_vector.index_iter_at(root_node.memento_buffer_begin); ai != end; ++ai) {
+          string_t x          = any_vector.apply(*ai, pretty_string);
+          offset_mapping[*ai] = new_any_vector.push_back(std::move(x));
+        }
+        offset_mapping[root_node.memento_buffer_offset_end] = new_any_vector.next_index();
+      }
+      const auto& map_offset = [&offset_mapping](any_vector_index_t& offset) {
+        const auto it = offset_mapping.find(offset);
+        SILVA_ASSERT(it != offset_mapping.end());
+        offset = it->second;
+      };
+      const index_t begin = root_node.children_begin;
+      const index_t delta = index_t(new_tree.nodes.size()) - begin;
+      for (index_t i = begin; i <= root; ++i) {
+        error_tree_t::node_t node = tree.nodes[i];
+        node.children_begin += delta;
+        map_offset(node.memento_buffer_offset);
+        map_offset(node.memento_buffer_offset_end);
+        map_offset(node.memento_buffer_begin);
+        new_tree.nodes.push_back(node);
+      }
+      return root + delta;
+    }
+  }
+
+  void error_context_t::drop(const index_t node_index)
+  {
+    SILVA_ASSERT(0 <= node_index && node_index < index_t(tree.nodes.size()));
+    error_tree_t::node_t& dropped_node = tree.nodes[node_index];
+    dropped_node.is_dropped            = true;
+    owners[node_index]                 = nullptr;
+    if (node_index + 1 < index_t(tree.nodes.size())) {
+      num_dropped_nodes += node_index - dropped_node.children_begin + 1;
+      if (num_dropped_nodes >= compact_min_dropped_nodes &&
+          2 * num_dropped_nodes >= index_t(tree.nodes.size())) {
+        compact();
+      }
+      return;
+    }
+    while (!tree.nodes.empty() && tree.nodes.back().is_dropped) {
+      const error_tree_t::node_t node = tree.nodes.back();
+      any_vector.resize_down_to(node.memento_buffer_begin);
+      tree.nodes.resize(node.children_begin);
+      owners.resize(node.children_begin);
+    }
+    num_dropped_nodes = std::min(num_dropped_nodes, index_t(tree.nodes.size()));
+  }
+
+  void error_context_t::compact()
+  {
+    // Even if nothing can be done, this restarts the count, so that the cost of calling compact()
+    // stays proportional to the number of dropped nodes.
+    num_dropped_nodes = 0;
+
+    // Top-level subtrees that are still in use, from the back.
+    array_t<index_t> roots;
+    for (index_t end = tree.nodes.size(); end > 0; end = tree.nodes[end - 1].children_begin) {
+      if (!tree.nodes[end - 1].is_dropped) {
+        if (owners[end - 1] == nullptr) {
+          return;
+        }
+        roots.push_back(end - 1);
+      }
+    }
+
+    error_tree_t new_tree;
+    memento_vector_t new_any_vector;
+    array_t<error_t*> new_owners;
+    for (auto rit = roots.rbegin(); rit != roots.rend(); ++rit) {
+      const index_t root     = *rit;
+      const index_t new_root = impl::copy_subtree_materialized(tree,
+                                                               any_vector,
+                                                               root,
+                                                               new_tree,
+                                                               new_any_vector);
+      for (index_t i = tree.nodes[root].children_begin; i <= root; ++i) {
+        new_owners.push_back(owners[i]);
+      }
+      error_t* owner = owners[root];
+      SILVA_ASSERT(owner->context.get() == this && owner->node_index == root);
+      owner->node_index = new_root;
+    }
+    tree       = std::move(new_tree);
+    any_vector = std::move(new_any_vector);
+    owners     = std::move(new_owners);
+  }
+
   error_context_t::~error_context_t()
   {
     SILVA_ASSERT(tree.nodes.empty());
@@ -35,6 +138,9 @@ namespace silva {
                    const error_level_t error_level)
     : context(context), node_index(node_index), level(error_level)
   {
+    if (!context.is_nullptr()) {
+      this->context->owners[node_index] = this;
+    }
   }
 
   error_t::error_t(error_t&& other)
@@ -42,6 +148,9 @@ namespace silva {
     , node_index(std::exchange(other.node_index, 0))
     , level(std::exchange(other.level, error_level_t::NO_ERROR))
   {
+    if (!context.is_nullptr()) {
+      context->owners[node_index] = this;
+    }
   }
 
   error_t& error_t::operator=(error_t&& other)
@@ -58,20 +167,22 @@ namespace silva {
     std::swap(context, other.context);
     std::swap(node_index, other.node_index);
     std::swap(level, other.level);
+    if (!context.is_nullptr()) {
+      context->owners[node_index] = this;
+    }
+    if (!other.context.is_nullptr()) {
+      other.context->owners[other.node_index] = &other;
+    }
   }
 
   void error_t::clear()
   {
     if (!context.is_nullptr()) {
-      SILVA_ASSERT(context->tree.nodes.size() == node_index + 1);
-      const auto& node       = context->tree.nodes[node_index];
-      const index_t new_size = node.children_begin;
-      context->any_vector.resize_down_to(node.memento_buffer_begin);
-      context->tree.nodes.resize(new_size);
+      context->drop(node_index);
       context.clear();
       node_index = 0;
-      level      = error_level_t::NO_ERROR;
     }
+    level = error_level_t::NO_ERROR;
   }
 
   bool error_t::is_empty() const
@@ -82,12 +193,45 @@ namespace silva {
   void error_t::release()
   {
     if (!context.is_nullptr()) {
+      context->owners[node_index] = nullptr;
       context.clear();
       node_index = 0;
       level      = error_level_t::NO_ERROR;
     }
   }
 
+  detached_error_t error_t::detach() &&
+  {
+    detached_error_t retval{.level = level};
+    if (!context.is_nullptr()) {
+      impl::copy_subtree_materialized(context->tree,
+                                      context->any_vector,
+                                      node_index,
+                                      retval.tree,
+                                      retval.any_vector);
+    }
+    clear();
+    return retval;
+  }
+
+  error_t detached_error_t::attach() &&
+  {
+    if (tree.nodes.empty()) {
+      return error_t(error_context_ptr_t{}, 0, level);
+    }
+    auto context       = error_context_t::get();
+    const index_t root = impl::copy_subtree_materialized(tree,
+                                                         any_vector,
+                                                         tree.nodes.size() - 1,
+                                                         context->tree,
+                                                         context->any_vector);
+    context->owners.resize(root + 1, nullptr);
+    error_t retval(context, root, level);
+    tree.nodes.clear();
+    any_vector.clear();
+    return retval;
+  }
+
   namespace impl {
     void to_string_plain(const error_context_t* error_context,
                          string_t& retval,
@@ -107,6 +251,9 @@ namespace silva {
 
   string_or_view_t error_t::to_string_plain() const
   {
+    if (context.is_nullptr()) {
+      return string_or_view_t{string_view_t{"unrecorded error\n"}};
+    }
     string_t retval;
     impl::to_string_plain(context.get(), retval, node_index, 0);
     return string_or_view_t{std::move(retval)};
@@ -192,6 +339,9 @@ namespace silva {
 
   string_or_view_t error_t::to_string_structured() const
   {
+    if (context.is_nullptr()) {
+      return to_string_plain();
+    }
     string_t retval;
     array_t<index_t> box_levels;
     impl::to_string_struct(context.get(), retval, box_levels, node_index, impl::state_t::NONE);
@@ -205,8 +355,11 @@ namespace silva {
 
   void error_t::materialize()
   {
+    if (context.is_nullptr()) {
+      return;
+    }
     auto& any_vector = context->any_vector;
-    any_vector_t<pretty_string_t, move_ctor_t, dtor_t> new_any_vector;
+    memento_vector_t new_any_vector;
     hash_map_t<any_vector_index_t, any_vector_index_t> offset_mapping;
     {
       for (const auto avi: any_vector.index_range()) {
@@ -240,6 +393,9 @@ namespace silva {
 
   void error_nursery_t::add_child_error(error_t child_error)
   {
+    if (child_error.is_empty()) {
+      return;
+    }
     const auto& child_node = context->tree.nodes[child_error.node_index];
     if (num_children == 0) {
       last_node_index      = child_error.node_index;
@@ -247,7 +403,8 @@ namespace silva {
       memento_buffer_begin = child_node.memento_buffer_begin;
     }
     else {
-      SILVA_ASSERT(last_node_index && *last_node_index + 1 == child_node.children_begin);
+      const index_t child_begin = context->tree.skip_dropped_before(child_node.children_begin);
+      SILVA_ASSERT(last_node_index && *last_node_index + 1 == child_begin);
       last_node_index = child_error.node_index;
     }
     num_children += 1;
@@ -7,13 +7,44 @@
 #include "pretty_write.hpp"
 
 namespace silva {
+  struct error_t;
+  struct detached_error_t;
+
+  using memento_vector_t = any_vector_t<pretty_string_t, move_ctor_t, dtor_t>;
 
   struct error_context_t : public context_t<error_context_t> {
     constexpr static bool context_use_default = true;
     constexpr static bool context_mutable_get = true;
 
     error_tree_t tree;
-    any_vector_t<pretty_string_t, move_ctor_t, dtor_t> any_vector;
+    memento_vector_t any_vector;
+
+    // The error_t whose root node is at the same index in "tree.nodes", if any, so that compact()
+    // can tell it where its node went.
+    array_t<error_t*> owners;
+
+    // If set, make_error() and error_nursery_t don't record errors below MAJOR that have no
+    // recorded children. They hand out unrecorded errors instead, which only have a level. For code
+    // that reports failures by other means, e.g., seed::error_policy_t::FURTHEST_FAILURE.
+    bool skip_minor_errors = false;
+
+    // Number of nodes in the subtrees that were marked as dropped since the last compact().
+    index_t num_dropped_nodes = 0;
+
+    // Once at least this many nodes (and at least half of all nodes) are marked as dropped, they
+    // are reclaimed by compact().
+    constexpr static index_t compact_min_dropped_nodes = 1024;
+
+    // Called when the error with the given root node is cleared. Errors are usually dropped in
+    // LIFO order, so that their nodes and mementos can be popped off right away. Otherwise the node
+    // is only marked as dropped, and its subtree is reclaimed once all errors after it are dropped
+    // too, or by compact().
+    void drop(index_t node_index);
+
+    // Moves the errors that are still in use down over the subtrees of dropped errors in between,
+    // materializing their mementos on the way. Does nothing while an error_nursery_t has children
+    // that aren't owned by any error_t yet.
+    void compact();
 
     ~error_context_t();
   };
@@ -35,6 +66,7 @@ namespace silva {
 
     void clear();
 
+    // Also true for unrecorded errors (see error_context_t::skip_minor_errors).
     bool is_empty() const;
 
     void release();
@@ -49,6 +81,23 @@ namespace silva {
 
     // Rewrite the error to resolve all pointers/references.
     void materialize();
+
+    // Moves the error out of the error_context_t of the calling thread (see detached_error_t).
+    detached_error_t detach() &&;
+  };
+
+  // An error that doesn't belong to any error_context_t, with all its mementos materialized. Each
+  // error_t lives in the error_context_t of the thread that created it, and only that thread may
+  // use it. To report an error on another thread, the creating thread detaches it, hands over the
+  // detached_error_t, and the other thread attaches it to its own error_context_t.
+  struct detached_error_t {
+    // The subtree of the error, with the error's own node last. Empty for unrecorded errors.
+    error_tree_t tree;
+    memento_vector_t any_vector;
+    error_level_t level = error_level_t::NO_ERROR;
+
+    // Moves the error into the error_context_t of the calling thread.
+    error_t attach() &&;
   };
 
   struct error_nursery_t {
@@ -68,6 +117,10 @@ namespace silva {
     template<typename... MementoArgs>
     error_t finish(error_level_t, MementoArgs&&...) &&;
 
+    // Like finish(), but for an error created at the given site (see error_site_t).
+    template<typename... MementoArgs>
+    error_t finish_at(const error_site_t*, error_level_t, MementoArgs&&...) &&;
+
     error_t finish_single_child_as_is(error_level_t) &&;
 
     template<typename... MementoArgs>
@@ -76,6 +129,12 @@ namespace silva {
 
   template<typename... MementoArgs>
   error_t make_error(error_level_t, span_t<error_t> child_errors, MementoArgs&&...);
+
+  template<typename... MementoArgs>
+  error_t make_error_at(const error_site_t*,
+                        error_level_t,
+                        span_t<error_t> child_errors,
+                        MementoArgs&&...);
 }
 
 // IMPLEMENTATION
@@ -90,6 +149,7 @@ namespace silva {
     context->any_vector.resize_down_to(node.memento_buffer_offset);
     (context->any_vector.push_back(std::forward<MementoArgs>(memento_args)), ...);
     node.memento_buffer_offset_end = context->any_vector.next_index();
+    node.site                      = nullptr;
   }
 
   template<typename... MementoArgs>
@@ -104,19 +164,50 @@ namespace silva {
     return std::move(nursery).finish(error_level, std::forward<MementoArgs>(memento_args)...);
   }
 
+  template<typename... MementoArgs>
+  error_t make_error_at(const error_site_t* site,
+                        const error_level_t error_level,
+                        span_t<error_t> child_errors,
+                        MementoArgs&&... memento_args)
+  {
+    error_nursery_t nursery;
+    for (error_t& error: child_errors) {
+      nursery.add_child_error(std::move(error));
+    }
+    return std::move(nursery).finish_at(site,
+                                        error_level,
+                                        std::forward<MementoArgs>(memento_args)...);
+  }
+
   template<typename... MementoArgs>
   error_t error_nursery_t::finish(const error_level_t error_level, MementoArgs&&... memento_args) &&
   {
+    return std::move(*this).finish_at(nullptr,
+                                      error_level,
+                                      std::forward<MementoArgs>(memento_args)...);
+  }
+
+  template<typename... MementoArgs>
+  error_t error_nursery_t::finish_at(const error_site_t* site,
+                                     const error_level_t error_level,
+                                     MementoArgs&&... memento_args) &&
+  {
+    if (num_children == 0 && error_level < error_level_t::MAJOR && context->skip_minor_errors) {
+      return error_t(error_context_ptr_t{}, 0, error_level);
+    }
     const index_t new_node_index = context->tree.nodes.size();
-    SILVA_ASSERT(!last_node_index || *last_node_index + 1 == new_node_index);
+    SILVA_ASSERT(!last_node_index ||
+                 *last_node_index + 1 == context->tree.skip_dropped_before(new_node_index));
     const auto mbo = context->any_vector.next_index();
     (context->any_vector.push_back(std::forward<MementoArgs>(memento_args)), ...);
+    context->owners.push_back(nullptr);
     context->tree.nodes.push_back(error_tree_t::node_t{
         .num_children              = num_children,
         .children_begin            = children_begin.value_or(new_node_index),
         .memento_buffer_offset     = mbo,
         .memento_buffer_offset_end = context->any_vector.next_index(),
         .memento_buffer_begin      = memento_buffer_begin.value_or(mbo),
+        .site                      = site,
     });
     error_t retval(context, new_node_index, error_level);
     release();
@@ -2,6 +2,9 @@
 
 #include <catch2/catch_all.hpp>
 
+#include <atomic>
+#include <thread>
+
 namespace silva::test {
   using enum error_level_t;
 
@@ -95,4 +98,113 @@ scope final 3
       CHECK(result.as_string_view() == expected.substr(1));
     }
   }
+
+  TEST_CASE("error-drop-out-of-order", "[error_t]")
+  {
+    error_context_t error_context;
+    {
+      auto a = make_error(MINOR, {}, "a");
+      auto b = make_error(MINOR, {}, "b");
+      auto c = make_error(MINOR, {}, "c");
+      b.clear();
+      CHECK(error_context.tree.nodes.size() == 3);
+
+      array_t<silva::error_t> errors;
+      errors.push_back(std::move(a));
+      errors.push_back(std::move(c));
+      auto d = make_error(MINOR, errors, "d");
+      CHECK(d.to_string_plain().as_string_view() == "  a\n  c\nd\n");
+
+      auto e = make_error(MINOR, {}, "e");
+      d.clear();
+      CHECK(error_context.tree.nodes.size() == 5);
+      e.clear();
+      CHECK(error_context.tree.nodes.empty());
+      CHECK(error_context.any_vector.is_empty());
+    }
+    {
+      // Keeping only the latest error never lets the dropped ones reach the back.
+      silva::error_t latest = make_error(MINOR, {}, "{}", 0);
+      for (index_t i = 1; i < 10 * error_context_t::compact_min_dropped_nodes; ++i) {
+        latest = make_error(MINOR, {}, "{}", i);
+      }
+      const index_t max_num_nodes = 2 * error_context_t::compact_min_dropped_nodes;
+      CHECK(index_t(error_context.tree.nodes.size()) <= max_num_nodes);
+      CHECK(latest.to_string_plain().as_string_view() == "10239\n");
+    }
+    CHECK(error_context.tree.nodes.empty());
+    CHECK(error_context.any_vector.is_empty());
+  }
+
+  TEST_CASE("error-detach-attach", "[error_t][detached_error_t]")
+  {
+    detached_error_t detached;
+    bool is_emptied = false;
+    std::thread([&] {
+      const string_t name = "inner";
+      array_t<silva::error_t> errors;
+      errors.push_back(make_error(MINOR, {}, "{} {}", name, 1));
+      errors.push_back(make_error(MINOR, {}, "{} {}", name, 2));
+      auto error = make_error(MAJOR, errors, "outer");
+      detached   = std::move(error).detach();
+      is_emptied = error_context_t::get()->tree.nodes.empty();
+    }).join();
+    CHECK(is_emptied);
+    CHECK(detached.tree.nodes.size() == 3);
+    CHECK(detached.level == MAJOR);
+
+    error_context_t error_context;
+    {
+      const silva::error_t error = std::move(detached).attach();
+      CHECK(error.level == MAJOR);
+      CHECK(error.to_string_plain().as_string_view() == "  inner 1\n  inner 2\nouter\n");
+      CHECK(error_context.tree.nodes.size() == 3);
+    }
+    CHECK(error_context.tree.nodes.empty());
+    CHECK(error_context.any_vector.is_empty());
+  }
+
+  TEST_CASE("error-detach-attach-threads", "[error_t][detached_error_t]")
+  {
+    // Errors are created and detached on 16 threads while each thread keeps an older error alive,
+    // so the detached nodes are never simply all nodes of that thread. The main thread attaches
+    // them in order and compares them to the same errors created locally.
+    const auto make_nested = [](const index_t i) {
+      array_t<silva::error_t> errors;
+      for (index_t j = 0; j < i % 4; ++j) {
+        errors.push_back(make_error(MINOR, {}, "error {} child {}", i, j));
+      }
+      return make_error(i % 2 == 0 ? MINOR : MAJOR, errors, "error {}", i);
+    };
+
+    constexpr index_t num_threads = 16;
+    constexpr index_t num_errors  = 1024;
+    array_t<detached_error_t> detached(num_errors);
+    std::atomic<index_t> num_not_emptied = 0;
+    {
+      array_t<std::jthread> threads;
+      for (index_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+          const silva::error_t older = make_error(MINOR, {}, "older {}", t);
+          for (index_t i = t; i < num_errors; i += num_threads) {
+            detached[i] = make_nested(i).detach();
+          }
+          if (error_context_t::get()->tree.nodes.size() != 1) {
+            num_not_emptied += 1;
+          }
+        });
+      }
+    }
+    CHECK(num_not_emptied == 0);
+
+    error_context_t error_context;
+    for (index_t i = 0; i < num_errors; ++i) {
+      const silva::error_t error    = std::move(detached[i]).attach();
+      const silva::error_t expected = make_nested(i);
+      CHECK(error.level == expected.level);
+      CHECK(error.to_string_plain().as_string() == expected.to_string_plain().as_string());
+    }
+    CHECK(error_context.tree.nodes.empty());
+    CHECK(error_context.any_vector.is_empty());
+  }
 }
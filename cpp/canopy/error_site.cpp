@@ -0,0 +1,20 @@
+#include "error_site.hpp"
+
+#include <fmt/format.h>
+
+namespace silva {
+  string_t error_site_t::default_message() const
+  {
+    const string_view_t what = (kind == kind_t::EXPECT) ? "unexpected" : "while calling";
+    if (expr_str.size() > max_expr_str_len) {
+      return fmt::format("{} [{}...] at [{}:{}]",
+                         what,
+                         expr_str.substr(0, max_expr_str_len),
+                         file,
+                         line);
+    }
+    else {
+      return fmt::format("{} [{}] at [{}:{}]", what, expr_str, file, line);
+    }
+  }
+}
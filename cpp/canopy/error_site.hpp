@@ -0,0 +1,69 @@
+#pragma once
+
+#include "error_level.hpp"
+#include "string.hpp"
+#include "types.hpp"
+
+namespace silva {
+  // Static descriptor of one expansion of SILVA_EXPECT() or SILVA_EXPECT_FWD(), see
+  // SILVA_ERROR_SITE(). Creating an error at that site only stores a pointer to its descriptor,
+  // together with the raw arguments. The message is only formatted once it is read.
+  struct error_site_t {
+    enum class kind_t {
+      EXPECT,
+      EXPECT_FWD,
+    };
+    kind_t kind = kind_t::EXPECT;
+
+    string_view_t file;
+    index_t line = 0;
+
+    // Text of the condition (SILVA_EXPECT) or of the expression (SILVA_EXPECT_FWD).
+    string_view_t expr_str;
+
+    // If the first optional argument is a string literal, it is the format of the message and not
+    // stored with each error. Empty otherwise, in which case the (optional) arguments are stored
+    // as they are.
+    string_view_t format;
+
+    // The message of an error that was created without any optional arguments.
+    string_t default_message() const;
+
+    constexpr static index_t max_expr_str_len = 30;
+  };
+}
+
+// Declares the error_site_t "__silva_site" for the current line. The optional arguments are those
+// of SILVA_EXPECT() after the error-level, or those of SILVA_EXPECT_FWD() after the expression.
+#define SILVA_ERROR_SITE(kind_value, expr_str_value, ...)                                          \
+  static constexpr silva::error_site_t __silva_site                                                \
+  {                                                                                                \
+    .kind     = silva::error_site_t::kind_t::kind_value,                                           \
+    .file     = __FILE__,                                                                          \
+    .line     = __LINE__,                                                                          \
+    .expr_str = expr_str_value,                                                                    \
+    .format   = silva::impl::error_site_format(__VA_OPT__(SILVA_FIRST_ARG(__VA_ARGS__))),         \
+  }
+
+#define SILVA_FIRST_ARG(...)             SILVA_FIRST_ARG_IMPL(__VA_ARGS__, )
+#define SILVA_FIRST_ARG_IMPL(first, ...) first
+
+// IMPLEMENTATION
+
+namespace silva::impl {
+  constexpr string_view_t error_site_format()
+  {
+    return {};
+  }
+
+  constexpr string_view_t error_site_format(const error_level_t)
+  {
+    return {};
+  }
+
+  template<index_t N>
+  constexpr string_view_t error_site_format(const char (&format)[N])
+  {
+    return string_view_t{format, N - 1};
+  }
+}
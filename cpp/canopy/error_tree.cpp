@@ -3,4 +3,11 @@
 #include "format.hpp"
 
 namespace silva {
+  index_t error_tree_t::skip_dropped_before(index_t node_end) const
+  {
+    while (node_end > 0 && nodes[node_end - 1].is_dropped) {
+      node_end = nodes[node_end - 1].children_begin;
+    }
+    return node_end;
+  }
 }
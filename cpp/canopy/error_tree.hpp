@@ -2,6 +2,7 @@
 
 #include "any_vector.hpp"
 #include "assert.hpp"
+#include "error_site.hpp"
 
 namespace silva {
   enum class tree_event_t {
@@ -29,9 +30,21 @@ namespace silva {
       any_vector_index_t memento_buffer_offset;
       any_vector_index_t memento_buffer_offset_end;
       any_vector_index_t memento_buffer_begin;
+
+      // Where the error was created, if by SILVA_EXPECT() or SILVA_EXPECT_FWD(). Then the mementos
+      // are only the arguments that aren't already part of the error_site_t.
+      const error_site_t* site = nullptr;
+
+      // The error of this node was dropped while later nodes were still in use. Its subtree stays
+      // in "nodes" (and is skipped by the visitors) until it can be reclaimed from the back.
+      bool is_dropped = false;
     };
     array_t<node_t> nodes;
 
+    // Skips the subtrees of dropped nodes that directly precede "node_end", i.e., returns the end
+    // of the last subtree before "node_end" that is still in use.
+    index_t skip_dropped_before(index_t node_end) const;
+
     template<typename Visitor>
       requires std::invocable<Visitor, span_t<const tree_branch_t>, tree_event_t>
     void visit_subtree(Visitor, index_t start_node_index = 0) const;
@@ -106,7 +119,7 @@ namespace silva {
       if (node_index <= begin_node_index) {
         break;
       }
-      node_index -= 1;
+      node_index = skip_dropped_before(node_index) - 1;
     }
 
     const optional_t<index_t> maybe_new_child_index = clean_stack_till(begin_node_index);
@@ -125,7 +138,7 @@ namespace silva {
     const node_t& parent_node = nodes[parent_node_index];
     index_t curr_node_index   = parent_node_index;
     for (index_t child_index = 0; child_index < parent_node.num_children; ++child_index) {
-      curr_node_index -= 1;
+      curr_node_index = skip_dropped_before(curr_node_index) - 1;
       visitor(curr_node_index, child_index);
       curr_node_index = nodes[curr_node_index].children_begin;
     }
@@ -141,7 +154,7 @@ namespace silva {
     {
       const auto& parent_node = et.nodes[parent_node_index];
       if (child_index < parent_node.num_children) {
-        const index_t child_node_index      = prev_child_node_begin - 1;
+        const index_t child_node_index      = et.skip_dropped_before(prev_child_node_begin) - 1;
         const index_t next_child_node_begin = et.nodes[child_node_index].children_begin;
         error_tree_visit_children_reversed(et,
                                            visitor,
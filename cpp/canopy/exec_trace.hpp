@@ -1,22 +1,41 @@
 #pragma once
 
+#include "fast_clock.hpp"
 #include "source_location.hpp"
-#include "time.hpp"
 #include "tree.hpp"
 #include "tree_nursery.hpp"
 
 namespace silva {
+  // Records the nested scopes that a program goes through. Only the last "capacity" scopes are
+  // kept, in a ring buffer, so that traces of huge runs stay usable. Users that only trace
+  // optionally should decide so once up front (e.g., by selecting a traced or an untraced version
+  // of a function), so that the untraced version doesn't even call scope().
   template<typename T>
   struct exec_trace_t {
     struct item_t {
-      time_point_t tp_entry;
-      time_point_t tp_exit;
+      // Raw fast_clock_t ticks, "ticks_exit" is fast_ticks_none while the scope is still open.
+      fast_ticks_t ticks_entry = fast_ticks_none;
+      fast_ticks_t ticks_exit  = fast_ticks_none;
       source_location_t sl;
       index_t depth = 0;
       T data        = {};
+
+      // Time spent in the scope, or none if it is still open.
+      optional_t<time_span_t> duration() const;
     };
+    index_t capacity = 64 * 1024;
+
+    // Scope number "i" is in "items[i % capacity]", for the last "items.size()" scopes entered.
+    // Huge parses enter more scopes than fit into an index_t, hence the wider counter.
     array_t<item_t> items;
-    index_t depth = 0;
+    int64_t num_entered = 0;
+    index_t depth       = 0;
+
+    // Number of scopes whose items have been overwritten.
+    int64_t num_dropped() const;
+
+    // Receives the data of scopes whose items have already been overwritten.
+    T discarded = {};
 
     struct scope_t;
     template<typename... Args>
@@ -36,9 +55,10 @@ namespace silva {
 namespace silva {
   template<typename T>
   struct exec_trace_t<T>::scope_t {
-    exec_trace_t* et   = nullptr;
-    index_t item_index = 0;
+    exec_trace_t* et     = nullptr;
+    int64_t scope_number = 0;
 
+    item_t* item() const;
     T* operator->();
 
     ~scope_t();
@@ -49,10 +69,35 @@ namespace silva {
     exec_trace_t<T>::item_t item;
   };
 
+  template<typename T>
+  optional_t<time_span_t> exec_trace_t<T>::item_t::duration() const
+  {
+    if (ticks_exit == fast_ticks_none) {
+      return std::nullopt;
+    }
+    return fast_clock_t::to_time_span(ticks_exit - ticks_entry);
+  }
+
+  template<typename T>
+  int64_t exec_trace_t<T>::num_dropped() const
+  {
+    return num_entered - int64_t(items.size());
+  }
+
+  template<typename T>
+  exec_trace_t<T>::item_t* exec_trace_t<T>::scope_t::item() const
+  {
+    if (scope_number < et->num_dropped()) {
+      return nullptr;
+    }
+    return &(et->items[scope_number % et->capacity]);
+  }
+
   template<typename T>
   T* exec_trace_t<T>::scope_t::operator->()
   {
-    return &(et->items[item_index].data);
+    item_t* it = item();
+    return (it != nullptr) ? &(it->data) : &(et->discarded);
   }
 
   template<typename T>
@@ -60,22 +105,31 @@ namespace silva {
   exec_trace_t<T>::scope_t exec_trace_t<T>::scope(source_location_t sloc, Args&&... args)
   {
     depth += 1;
-    const index_t item_index = items.size();
-    items.push_back(item_t{
-        .tp_entry = time_point_t::now(),
-        .tp_exit  = time_point_none,
-        .sl       = sloc,
-        .depth    = depth,
-        .data     = T{std::forward<Args>(args)...},
-    });
-    return scope_t{.et = this, .item_index = item_index};
+    const int64_t scope_number = num_entered;
+    num_entered += 1;
+    item_t item{
+        .ticks_entry = fast_clock_t::now(),
+        .ticks_exit  = fast_ticks_none,
+        .sl          = sloc,
+        .depth       = depth,
+        .data        = T{std::forward<Args>(args)...},
+    };
+    if (index_t(items.size()) < capacity) {
+      items.push_back(std::move(item));
+    }
+    else {
+      items[scope_number % capacity] = std::move(item);
+    }
+    return scope_t{.et = this, .scope_number = scope_number};
   }
 
   template<typename T>
   exec_trace_t<T>::scope_t::~scope_t()
   {
     et->depth -= 1;
-    et->items[item_index].tp_exit = time_point_t::now();
+    if (item_t* it = item(); it != nullptr) {
+      it->ticks_exit = fast_clock_t::now();
+    }
   }
 
   namespace impl {
@@ -137,7 +191,9 @@ namespace silva {
       }
       return {};
     };
-    for (const auto& item: items) {
+    // Scopes whose parents have already been dropped become children of the root.
+    for (int64_t i = num_dropped(); i < num_entered; ++i) {
+      const item_t& item = items[i % capacity];
       SILVA_EXPECT_FWD(pop_stack(item.depth));
       SILVA_EXPECT_FWD(nursery.push_stake())->item = item;
     }
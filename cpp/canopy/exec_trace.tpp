@@ -23,6 +23,23 @@ namespace silva::test {
         func_1();
         func_1();
       }
+
+      void func_3()
+      {
+        auto ets = SILVA_EXEC_TRACE_SCOPE(et, "func_3");
+        func_2();
+        ets->name += "!";
+      }
+
+      string_t to_string()
+      {
+        auto etr = SILVA_REQUIRE(et.as_tree("ROOT"));
+        tree_span_t ets{etr};
+        return SILVA_REQUIRE(ets.to_string([&](string_t& curr_line, auto& path) {
+          const data_t& dd = ets.subspan_at(path.back().node_index).node_at(0).item.data;
+          curr_line += fmt::format("{} / {}", dd.name, dd.success);
+        }));
+      }
     };
   }
 
@@ -32,12 +49,12 @@ namespace silva::test {
     widget.func_2();
     widget.func_1();
     widget.func_2();
-    auto etr = SILVA_REQUIRE(widget.et.as_tree("ROOT"));
-    tree_span_t ets{etr};
-    const string_t estr = SILVA_REQUIRE(ets.to_string([&](string_t& curr_line, auto& path) {
-      const widget_t::data_t& dd = ets.subspan_at(path.back().node_index).node_at(0).item.data;
-      curr_line += fmt::format("{} / {}", dd.name, dd.success);
-    }));
+    const string_t estr = widget.to_string();
+    CHECK(widget.et.num_dropped() == 0);
+    for (const auto& item: widget.et.items) {
+      REQUIRE(item.duration().has_value());
+      CHECK(item.duration()->nanos >= 0);
+    }
     const string_view_t expected = R"(
 [0]ROOT / false
   [0]func_2 / false
@@ -50,4 +67,44 @@ namespace silva::test {
 )";
     CHECK(estr == expected.substr(1));
   }
+
+  TEST_CASE("exec-trace-ring-buffer", "[exec_trace_t]")
+  {
+    widget_t widget;
+    widget.et.capacity = 3;
+    widget.func_3();
+    widget.func_1();
+    CHECK(widget.et.num_entered == 5);
+    CHECK(widget.et.num_dropped() == 2);
+    CHECK(widget.et.discarded.name == "!");
+    const string_view_t expected = R"(
+[0]ROOT / false
+  [0]func_1 / true
+  [1]func_1 / true
+  [2]func_1 / true
+)";
+    CHECK(widget.to_string() == expected.substr(1));
+  }
+
+  TEST_CASE("exec-trace-ring-buffer-huge", "[exec_trace_t]")
+  {
+    // As if more scopes had already been entered than fit into 32 bits (a multiple of the capacity,
+    // as the items are still empty).
+    const int64_t num_before = (int64_t(1) << 31) - 2;
+    widget_t widget;
+    widget.et.capacity    = 3;
+    widget.et.num_entered = num_before;
+    widget.func_3();
+    widget.func_1();
+    CHECK(widget.et.num_entered == num_before + 5);
+    CHECK(widget.et.num_dropped() == num_before + 2);
+    CHECK(widget.et.discarded.name == "!");
+    const string_view_t expected = R"(
+[0]ROOT / false
+  [0]func_1 / true
+  [1]func_1 / true
+  [2]func_1 / true
+)";
+    CHECK(widget.to_string() == expected.substr(1));
+  }
 }
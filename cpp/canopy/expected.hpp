@@ -1,10 +1,12 @@
 #pragma once
 
 #include "error.hpp"
+#include "error_site.hpp"
 
 #include <expected>
 #include <fmt/base.h>
 #include <fmt/format.h>
+#include <type_traits>
 
 namespace silva {
   template<typename T>
@@ -36,28 +38,24 @@ namespace silva {
 //  - SILVA_EXPECT(0 < x, MINOR, "x too small");
 //  - SILVA_EXPECT(0 < x, MINOR, "x (={}) must be positive", x);
 //
-#define SILVA_EXPECT_IMPL(return_stmt, condition, error_level, ...)                   \
-  do {                                                                                \
-    using enum silva::error_level_t;                                                  \
-    static_assert(silva::error_level_is_primary(error_level));                        \
-    if (!(condition)) {                                                               \
-      return_stmt std::unexpected(silva::impl::silva_expect(__FILE__,                 \
-                                                            __LINE__,                 \
-                                                            error_level,              \
-                                                            #condition __VA_OPT__(, ) \
-                                                                __VA_ARGS__));        \
-    }                                                                                 \
+#define SILVA_EXPECT_IMPL(return_stmt, condition, error_level, ...)                               \
+  do {                                                                                            \
+    using enum silva::error_level_t;                                                              \
+    static_assert(silva::error_level_is_primary(error_level));                                    \
+    if (!(condition)) {                                                                           \
+      SILVA_ERROR_SITE(EXPECT, #condition __VA_OPT__(, ) __VA_ARGS__);                            \
+      return_stmt std::unexpected(                                                                \
+          silva::impl::silva_expect(__silva_site, error_level __VA_OPT__(, ) __VA_ARGS__));       \
+    }                                                                                             \
   } while (false)
 #define SILVA_EXPECT(...) SILVA_EXPECT_IMPL(return, __VA_ARGS__)
 
-#define SILVA_EXPECT_NURSERY_BREAK(error_nursery, condition, error_level, ...)        \
-  if (!(condition)) {                                                                 \
-    error_nursery.add_child_error(silva::impl::silva_expect(__FILE__,                 \
-                                                            __LINE__,                 \
-                                                            error_level,              \
-                                                            #condition __VA_OPT__(, ) \
-                                                                __VA_ARGS__));        \
-    break;                                                                            \
+#define SILVA_EXPECT_NURSERY_BREAK(error_nursery, condition, error_level, ...)                    \
+  if (!(condition)) {                                                                             \
+    SILVA_ERROR_SITE(EXPECT, #condition __VA_OPT__(, ) __VA_ARGS__);                              \
+    error_nursery.add_child_error(                                                                \
+        silva::impl::silva_expect(__silva_site, error_level __VA_OPT__(, ) __VA_ARGS__));         \
+    break;                                                                                        \
   }
 
 // Semantics:
@@ -83,11 +81,10 @@ namespace silva {
         __silva_result.error().materialize();                                                      \
       }                                                                                            \
       using enum error_level_t;                                                                    \
-      return_stmt std::unexpected(silva::impl::silva_expect_fwd(__FILE__,                          \
-                                                                __LINE__,                          \
-                                                                std::move(__silva_result).error(), \
-                                                                #expression __VA_OPT__(, )         \
-                                                                    __VA_ARGS__));                 \
+      SILVA_ERROR_SITE(EXPECT_FWD, #expression __VA_OPT__(, ) __VA_ARGS__);                        \
+      return_stmt std::unexpected(silva::impl::silva_expect_fwd(__silva_site,                      \
+                                                                std::move(__silva_result).error()  \
+                                                                    __VA_OPT__(, ) __VA_ARGS__));  \
       return_stmt_2;                                                                               \
     }                                                                                              \
     *std::move(__silva_result);                                                                    \
@@ -204,93 +201,51 @@ namespace silva {
 }
 
 namespace silva::impl {
-  constexpr index_t max_expr_str_len = 30;
+  // A string literal as the first optional argument is the format of the message, which is then
+  // already part of the error_site_t (see SILVA_ERROR_SITE()).
+  template<typename T>
+  concept error_site_format_c = std::is_array_v<std::remove_cvref_t<T>>;
 
-  inline error_t silva_expect(char const* file,
-                              const long line,
-                              const error_level_t error_level,
-                              char const* expr_str)
+  template<typename... Args>
+  error_t silva_expect(const error_site_t& site, const error_level_t error_level, Args&&... args)
   {
-    const string_view_t expr_sv{expr_str};
-    if (expr_sv.size() > max_expr_str_len) {
-      return make_error(error_level,
-                        {},
-                        "unexpected [{}...] at [{}:{}]",
-                        expr_sv.substr(0, max_expr_str_len),
-                        string_view_t{file},
-                        line);
-    }
-    else {
-      return make_error(error_level,
-                        {},
-                        "unexpected [{}] at [{}:{}]",
-                        expr_sv,
-                        string_view_t{file},
-                        line);
-    }
+    return make_error_at(&site, error_level, {}, std::forward<Args>(args)...);
   }
 
-  template<typename... Args>
-    requires(sizeof...(Args) >= 1)
-  error_t silva_expect(char const* file,
-                       const long line,
+  template<error_site_format_c Format, typename... Args>
+  error_t silva_expect(const error_site_t& site,
                        const error_level_t error_level,
-                       char const* expr_str,
+                       Format&&,
                        Args&&... args)
   {
-    return make_error(error_level, {}, std::forward<Args>(args)...);
+    return make_error_at(&site, error_level, {}, std::forward<Args>(args)...);
   }
 
   template<typename... Args>
-  error_t silva_expect_fwd(char const* file,
-                           const long line,
+  error_t silva_expect_fwd(const error_site_t& site,
                            error_t error,
-                           char const* expr_str,
                            const error_level_t error_level,
                            Args&&... args)
   {
     const error_level_t new_error_level = std::max(error.level, error_level);
     std::array<error_t, 1> error_array{std::move(error)};
-    if constexpr (sizeof...(Args) >= 1) {
-      error = make_error(new_error_level, error_array, std::forward<Args>(args)...);
-    }
-    else {
-      const string_view_t expr_sv{expr_str};
-      if (expr_sv.size() > max_expr_str_len) {
-        error = make_error(new_error_level,
-                           error_array,
-                           "while calling [{}...] at [{}:{}]",
-                           expr_sv.substr(0, max_expr_str_len),
-                           string_view_t{file},
-                           line);
-      }
-      else {
-        error = make_error(new_error_level,
-                           error_array,
-                           "while calling [{}] at [{}:{}]",
-                           expr_sv,
-                           string_view_t{file},
-                           line);
-      }
-    }
-    return std::move(error);
+    return make_error_at(&site, new_error_level, error_array, std::forward<Args>(args)...);
   }
 
-  template<typename... Args>
-  error_t silva_expect_fwd(char const* file,
-                           const long line,
-                           error_t error,
-                           char const* expr_str,
-                           Args&&... args)
+  template<error_site_format_c Format, typename... Args>
+  error_t silva_expect_fwd(const error_site_t& site, error_t error, Format&&, Args&&... args)
   {
-    return silva_expect_fwd(file,
-                            line,
+    return silva_expect_fwd(site,
                             std::move(error),
-                            expr_str,
                             error_level_t::NO_ERROR,
                             std::forward<Args>(args)...);
   }
 
+  inline error_t silva_expect_fwd(const error_site_t& site, error_t error)
+  {
+    return silva_expect_fwd(site, std::move(error), error_level_t::NO_ERROR);
+  }
+
   template<typename... Args>
   void silva_expect_fwd_as(error_t& error, const error_level_t error_level, Args&&... args)
   {
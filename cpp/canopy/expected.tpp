@@ -1,4 +1,5 @@
 #include "expected.hpp"
+#include "time.hpp"
 
 #include <catch2/catch_all.hpp>
 
@@ -15,6 +16,12 @@ namespace silva::test {
     return y + 2;
   }
 
+  expected_t<int> forward_n(const int n)
+  {
+    SILVA_EXPECT(n > 0, MINOR);
+    return SILVA_EXPECT_FWD(forward_n(n - 1)) + 1;
+  }
+
   TEST_CASE("expected", "[expected_t]")
   {
     {
@@ -33,4 +40,38 @@ failed calling func_1(-4)
       CHECK(result_str == expected.substr(1));
     }
   }
+
+  TEST_CASE("expected-error-site", "[expected_t][error_site_t]")
+  {
+    const string_t result_str = SILVA_REQUIRE_ERROR(forward_n(10));
+    const auto count          = [&](const string_view_t needle) {
+      index_t retval = 0;
+      index_t pos    = result_str.find(needle);
+      while (pos != index_t(string_t::npos)) {
+        retval += 1;
+        pos = result_str.find(needle, pos + 1);
+      }
+      return retval;
+    };
+    CHECK(count("unexpected [n > 0] at [") == 1);
+    CHECK(count("while calling [forward_n(n - 1)] at [") == 10);
+    CHECK(count("expected.tpp:") == 11);
+  }
+
+  TEST_CASE("expected-error-site-performance", "[expected_t][error_site_t][.]")
+  {
+    constexpr index_t repetitions = 100'000;
+    index_t num_errors            = 0;
+    const auto start              = time_point_t::now();
+    for (index_t i = 0; i < repetitions; ++i) {
+      const expected_t<int> result = forward_n(10);
+      num_errors += result.has_value() ? 0 : 1;
+    }
+    const auto took = time_point_t::now() - start;
+    CHECK(num_errors == repetitions);
+    fmt::println("{} errors forwarded through 10 levels: {} ({} ns each)",
+                 repetitions,
+                 took,
+                 took.nanos / repetitions);
+  }
 }
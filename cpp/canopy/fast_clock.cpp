@@ -0,0 +1,46 @@
+#include "fast_clock.hpp"
+
+#include <cmath>
+
+namespace silva {
+  namespace {
+    double calibrate_nanos_per_tick()
+    {
+#if defined(__x86_64__)
+      // Spins for a few milliseconds. Both clocks are read twice in a row at each end, so that the
+      // reading of the timestamp counter is taken right between two readings of the system clock.
+      const auto sample = []() -> tuple_t<time_repr_t, fast_ticks_t> {
+        const time_point_t tp_before = time_point_t::now();
+        const fast_ticks_t ticks     = fast_clock_t::now();
+        const time_point_t tp_after  = time_point_t::now();
+        return {(tp_before.nanos_since_epoch + tp_after.nanos_since_epoch) / 2, ticks};
+      };
+      constexpr time_repr_t duration = 5'000'000;
+      const auto [nanos_0, ticks_0]  = sample();
+      tuple_t<time_repr_t, fast_ticks_t> end;
+      do {
+        end = sample();
+      } while (std::get<0>(end) - nanos_0 < duration);
+      return double(std::get<0>(end) - nanos_0) / double(std::get<1>(end) - ticks_0);
+#elif defined(__aarch64__)
+      // The counter frequency is known exactly.
+      uint64_t frequency;
+      asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+      return 1'000'000'000.0 / double(frequency);
+#else
+      return 1.0;
+#endif
+    }
+  }
+
+  double fast_clock_t::nanos_per_tick()
+  {
+    static const double retval = calibrate_nanos_per_tick();
+    return retval;
+  }
+
+  time_span_t fast_clock_t::to_time_span(const fast_ticks_t ticks)
+  {
+    return time_span_t{time_repr_t(std::llround(double(ticks) * nanos_per_tick()))};
+  }
+}
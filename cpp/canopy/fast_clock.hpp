@@ -0,0 +1,50 @@
+#pragma once
+
+#include "time.hpp"
+#include "types.hpp"
+
+#if defined(__x86_64__)
+#  include <x86intrin.h>
+#elif !defined(__aarch64__)
+#  include <chrono>
+#endif
+
+namespace silva {
+  // Raw reading of the CPU's timestamp counter: "rdtsc" on x86-64, "cntvct_el0" on AArch64, and
+  // std::chrono::steady_clock nanoseconds elsewhere. Reading the counter costs a few nanoseconds
+  // and never enters the kernel, so it's cheap enough to be read on entry and exit of every traced
+  // or profiled scope. Ticks are only comparable within a process (and, on x86-64, assume an
+  // invariant TSC, which all recent CPUs have).
+  using fast_ticks_t = int64_t;
+
+  constexpr inline fast_ticks_t fast_ticks_none = std::numeric_limits<fast_ticks_t>::min();
+
+  struct fast_clock_t {
+    static fast_ticks_t now();
+
+    // Length of a tick. The first call calibrates the counter against time_point_t, which takes a
+    // few milliseconds, so it should only happen at report time.
+    static double nanos_per_tick();
+
+    static time_span_t to_time_span(fast_ticks_t);
+  };
+}
+
+// IMPLEMENTATION
+
+namespace silva {
+  inline fast_ticks_t fast_clock_t::now()
+  {
+#if defined(__x86_64__)
+    return fast_ticks_t(__rdtsc());
+#elif defined(__aarch64__)
+    uint64_t retval;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(retval));
+    return fast_ticks_t(retval);
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+  }
+}
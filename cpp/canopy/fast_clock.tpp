@@ -0,0 +1,43 @@
+#include "fast_clock.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <thread>
+
+namespace silva::test {
+  TEST_CASE("fast-clock", "[fast_clock_t]")
+  {
+    const fast_ticks_t ticks_0 = fast_clock_t::now();
+    const time_point_t tp_0    = time_point_t::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const fast_ticks_t ticks_1 = fast_clock_t::now();
+    const time_point_t tp_1    = time_point_t::now();
+    CHECK(ticks_1 > ticks_0);
+    CHECK(fast_clock_t::nanos_per_tick() > 0.0);
+
+    // The sleep may be interrupted by other threads, so only rough agreement is expected.
+    const time_span_t fast_span = fast_clock_t::to_time_span(ticks_1 - ticks_0);
+    const time_span_t span      = tp_1 - tp_0;
+    CHECK(fast_span.nanos > span.nanos * 8 / 10);
+    CHECK(fast_span.nanos < span.nanos * 12 / 10);
+  }
+
+  TEST_CASE("fast-clock-performance", "[fast_clock_t][.]")
+  {
+    constexpr index_t num_iterations = 10'000'000;
+    const auto run                   = [&](const string_view_t name, const auto& func) {
+      time_repr_t sink = 0;
+      const auto start = time_point_t::now();
+      for (index_t i = 0; i < num_iterations; ++i) {
+        sink ^= func();
+      }
+      const auto took = time_point_t::now() - start;
+      fmt::println("{:24}  {}  {:.1f} ns/call  ({})",
+                   name,
+                   took,
+                   double(took.nanos) / double(num_iterations),
+                   sink & 1);
+    };
+    run("fast_clock_t::now", [] { return fast_clock_t::now(); });
+    run("time_point_t::now", [] { return time_point_t::now().nanos_since_epoch; });
+  }
+}
@@ -1,21 +1,29 @@
 #include "filesystem.hpp"
 
 #include "assert.hpp"
+#include "byte_source.hpp"
 
 #include <unistd.h>
 
 #include <fstream>
-#include <sstream>
 
 namespace silva {
   expected_t<string_t> read_file(const filepath_t& filename)
   {
-    std::ifstream file(filename);
-    SILVA_EXPECT(file.is_open(), MINOR, "Could not open file '{}' for reading", filename.string());
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    SILVA_EXPECT(file.good(), MINOR, "Error reading from file '{}'", filename.string());
-    return std::move(buffer).str();
+    // Regular files are mapped and copied into the string in one go, everything else (e.g., pipes)
+    // is read in chunks. So are regular files of size zero, as files in procfs or sysfs report
+    // that size even though reading them gives content.
+    if (auto mapped = byte_source_mmap_t::open(filename);
+        mapped.has_value() && !mapped.value()->span.empty()) {
+      return mapped.value()->read_all();
+    }
+    auto source     = SILVA_EXPECT_FWD(byte_source_file_t::open(filename));
+    string_t retval = source->read_all();
+    SILVA_EXPECT(source->error_number == 0,
+                 MINOR,
+                 "Error reading from file '{}'",
+                 filename.string());
+    return retval;
   }
 
   expected_t<void> write_file(const filepath_t& filename, const string_view_t content)
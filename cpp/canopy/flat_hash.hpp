@@ -0,0 +1,583 @@
+#pragma once
+
+#include "assert.hpp"
+#include "hash.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+namespace silva {
+  // Open-addressing hash-tables in the style of Abseil's SwissTable, using the hash_t and equal_t
+  // customization points like hash_map_t and hash_set_t. All slots live in one array, next to an
+  // array of control bytes that say whether each slot is empty, deleted, or full, and for full
+  // slots also hold 7 bits of the key's hash. A lookup compares the control bytes of a group of 16
+  // slots at once (with SSE2 if available) and only looks at the keys whose bits match.
+  //
+  // Unlike hash_map_t and hash_set_t, inserting may move all elements, so references and iterators
+  // are only valid until the next insertion. Lookups accept any type that hashes and compares like
+  // the key (e.g., string_view_t for string_t). clear() keeps the memory and, for trivially
+  // destructible elements, doesn't visit the slots.
+  template<typename Key, typename Value>
+  class flat_hash_map_t;
+
+  template<typename T>
+  class flat_hash_set_t;
+}
+
+// IMPLEMENTATION
+
+namespace silva::impl {
+  using flat_hash_ctrl_t = int8_t;
+
+  constexpr flat_hash_ctrl_t flat_hash_ctrl_empty   = -128;
+  constexpr flat_hash_ctrl_t flat_hash_ctrl_deleted = -2;
+
+  constexpr index_t flat_hash_group_size = 16;
+
+  // Bit i is set iff the control byte of slot i of the group matches.
+  struct flat_hash_group_t {
+#if defined(__SSE2__)
+    __m128i ctrl;
+
+    explicit flat_hash_group_t(const flat_hash_ctrl_t* p)
+      : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))
+    {
+    }
+
+    uint32_t match(const flat_hash_ctrl_t h2) const
+    {
+      return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+    }
+
+    uint32_t match_empty() const { return match(flat_hash_ctrl_empty); }
+
+    // Empty and deleted are the only negative values below -1.
+    uint32_t match_empty_or_deleted() const
+    {
+      return _mm_movemask_epi8(_mm_cmplt_epi8(ctrl, _mm_set1_epi8(-1)));
+    }
+#else
+    const flat_hash_ctrl_t* ctrl;
+
+    explicit flat_hash_group_t(const flat_hash_ctrl_t* p) : ctrl(p) {}
+
+    uint32_t match(const flat_hash_ctrl_t h2) const
+    {
+      uint32_t retval = 0;
+      for (index_t i = 0; i < flat_hash_group_size; ++i) {
+        retval |= uint32_t(ctrl[i] == h2) << i;
+      }
+      return retval;
+    }
+
+    uint32_t match_empty() const { return match(flat_hash_ctrl_empty); }
+
+    uint32_t match_empty_or_deleted() const
+    {
+      uint32_t retval = 0;
+      for (index_t i = 0; i < flat_hash_group_size; ++i) {
+        retval |= uint32_t(ctrl[i] < -1) << i;
+      }
+      return retval;
+    }
+#endif
+  };
+
+  // Many hash_impl() overloads return their argument as is, so the bits are mixed before they're
+  // split into the group index ("h1") and the 7 bits in the control byte ("h2").
+  struct flat_hash_bits_t {
+    uint64_t h1         = 0;
+    flat_hash_ctrl_t h2 = 0;
+
+    explicit flat_hash_bits_t(const hash_value_t hv)
+    {
+      const uint64_t mixed = uint64_t(hv) * 0x9e37'79b9'7f4a'7c15ull;
+      h1                   = mixed ^ (mixed >> 32);
+      h2                   = flat_hash_ctrl_t(mixed >> 57);
+    }
+  };
+
+  // "Policy" gives the key_type and value_type of the table and extracts the key of a value.
+  template<typename Policy>
+  class flat_hash_table_t {
+   public:
+    using key_type   = typename Policy::key_type;
+    using value_type = typename Policy::value_type;
+
+    template<bool is_const>
+    class iterator_base_t {
+      friend class flat_hash_table_t;
+      template<bool>
+      friend class iterator_base_t;
+      using table_t = std::conditional_t<is_const, const flat_hash_table_t, flat_hash_table_t>;
+      table_t* table = nullptr;
+      index_t index  = 0;
+
+      iterator_base_t(table_t* table, const index_t index) : table(table), index(index) {}
+
+     public:
+      using difference_type   = std::ptrdiff_t;
+      using value_type        = typename Policy::value_type;
+      using reference         = std::conditional_t<is_const, const value_type&, value_type&>;
+      using pointer           = std::conditional_t<is_const, const value_type*, value_type*>;
+      using iterator_category = std::forward_iterator_tag;
+
+      iterator_base_t() = default;
+      operator iterator_base_t<true>() const
+        requires(!is_const)
+      {
+        return {table, index};
+      }
+
+      reference operator*() const { return table->_slots[index]; }
+      pointer operator->() const { return &table->_slots[index]; }
+
+      iterator_base_t& operator++()
+      {
+        index = table->next_full(index + 1);
+        return *this;
+      }
+      iterator_base_t operator++(int)
+      {
+        iterator_base_t retval = *this;
+        ++(*this);
+        return retval;
+      }
+
+      friend bool operator==(const iterator_base_t& lhs, const iterator_base_t& rhs)
+      {
+        return lhs.index == rhs.index;
+      }
+    };
+    using iterator       = iterator_base_t<false>;
+    using const_iterator = iterator_base_t<true>;
+
+    flat_hash_table_t() = default;
+    flat_hash_table_t(const flat_hash_table_t&);
+    flat_hash_table_t(flat_hash_table_t&&) noexcept;
+    flat_hash_table_t& operator=(const flat_hash_table_t&);
+    flat_hash_table_t& operator=(flat_hash_table_t&&) noexcept;
+    ~flat_hash_table_t();
+
+    bool empty() const { return _size == 0; }
+    index_t size() const { return _size; }
+    index_t capacity() const { return _capacity; }
+
+    iterator begin() { return {this, next_full(0)}; }
+    iterator end() { return {this, _capacity}; }
+    const_iterator begin() const { return {this, next_full(0)}; }
+    const_iterator end() const { return {this, _capacity}; }
+
+    template<typename Q>
+    iterator find(const Q&);
+    template<typename Q>
+    const_iterator find(const Q&) const;
+    template<typename Q>
+    bool contains(const Q&) const;
+    template<typename Q>
+    index_t count(const Q&) const;
+
+    template<typename Q>
+    index_t erase(const Q&);
+    iterator erase(iterator);
+    iterator erase(const_iterator);
+
+    // Destroys all elements but keeps the memory.
+    void clear();
+
+    // Makes room for at least this many elements without rehashing.
+    void reserve(index_t);
+
+   protected:
+    iterator iterator_at(const index_t index) { return {this, index}; }
+
+    // Returns the index of the slot with the given key, or -1.
+    template<typename Q>
+    index_t find_index(const Q&) const;
+
+    // If there is no element with the given key, calls "construct(value_type*)" to construct one
+    // in a free slot. Returns the index of the element and whether it was constructed.
+    template<typename Q, typename Construct>
+    pair_t<index_t, bool> find_or_construct(const Q&, Construct&&);
+
+   private:
+    flat_hash_ctrl_t* _ctrl = nullptr;
+    value_type* _slots      = nullptr;
+    index_t _capacity       = 0;
+    index_t _size           = 0;
+    index_t _num_deleted    = 0;
+
+    index_t next_full(index_t) const;
+    index_t find_free(const flat_hash_bits_t&) const;
+    void erase_at(index_t);
+    void rehash(index_t new_capacity);
+    void deallocate();
+
+    constexpr static index_t max_load(const index_t capacity) { return capacity - capacity / 8; }
+  };
+
+  template<typename Policy>
+  flat_hash_table_t<Policy>::flat_hash_table_t(const flat_hash_table_t& other)
+  {
+    reserve(other.size());
+    for (const value_type& x: other) {
+      find_or_construct(Policy::key(x), [&](value_type* p) { std::construct_at(p, x); });
+    }
+  }
+
+  template<typename Policy>
+  flat_hash_table_t<Policy>::flat_hash_table_t(flat_hash_table_t&& other) noexcept
+    : _ctrl(std::exchange(other._ctrl, nullptr))
+    , _slots(std::exchange(other._slots, nullptr))
+    , _capacity(std::exchange(other._capacity, 0))
+    , _size(std::exchange(other._size, 0))
+    , _num_deleted(std::exchange(other._num_deleted, 0))
+  {
+  }
+
+  template<typename Policy>
+  flat_hash_table_t<Policy>& flat_hash_table_t<Policy>::operator=(const flat_hash_table_t& other)
+  {
+    if (this != &other) {
+      flat_hash_table_t temp(other);
+      *this = std::move(temp);
+    }
+    return *this;
+  }
+
+  template<typename Policy>
+  flat_hash_table_t<Policy>&
+  flat_hash_table_t<Policy>::operator=(flat_hash_table_t&& other) noexcept
+  {
+    if (this != &other) {
+      deallocate();
+      _ctrl        = std::exchange(other._ctrl, nullptr);
+      _slots       = std::exchange(other._slots, nullptr);
+      _capacity    = std::exchange(other._capacity, 0);
+      _size        = std::exchange(other._size, 0);
+      _num_deleted = std::exchange(other._num_deleted, 0);
+    }
+    return *this;
+  }
+
+  template<typename Policy>
+  flat_hash_table_t<Policy>::~flat_hash_table_t()
+  {
+    deallocate();
+  }
+
+  template<typename Policy>
+  void flat_hash_table_t<Policy>::deallocate()
+  {
+    if (_capacity == 0) {
+      return;
+    }
+    clear();
+    delete[] _ctrl;
+    std::allocator<value_type>{}.deallocate(_slots, _capacity);
+    _ctrl     = nullptr;
+    _slots    = nullptr;
+    _capacity = 0;
+  }
+
+  template<typename Policy>
+  template<typename Q>
+  auto flat_hash_table_t<Policy>::find(const Q& key) -> iterator
+  {
+    const index_t index = find_index(key);
+    return {this, index < 0 ? _capacity : index};
+  }
+
+  template<typename Policy>
+  template<typename Q>
+  auto flat_hash_table_t<Policy>::find(const Q& key) const -> const_iterator
+  {
+    const index_t index = find_index(key);
+    return {this, index < 0 ? _capacity : index};
+  }
+
+  template<typename Policy>
+  template<typename Q>
+  bool flat_hash_table_t<Policy>::contains(const Q& key) const
+  {
+    return find_index(key) >= 0;
+  }
+
+  template<typename Policy>
+  template<typename Q>
+  index_t flat_hash_table_t<Policy>::count(const Q& key) const
+  {
+    return find_index(key) >= 0 ? 1 : 0;
+  }
+
+  template<typename Policy>
+  template<typename Q>
+  index_t flat_hash_table_t<Policy>::erase(const Q& key)
+  {
+    const index_t index = find_index(key);
+    if (index < 0) {
+      return 0;
+    }
+    erase_at(index);
+    return 1;
+  }
+
+  template<typename Policy>
+  auto flat_hash_table_t<Policy>::erase(const iterator it) -> iterator
+  {
+    return erase(const_iterator{it});
+  }
+
+  template<typename Policy>
+  auto flat_hash_table_t<Policy>::erase(const const_iterator it) -> iterator
+  {
+    erase_at(it.index);
+    return {this, next_full(it.index + 1)};
+  }
+
+  template<typename Policy>
+  void flat_hash_table_t<Policy>::clear()
+  {
+    if constexpr (!std::is_trivially_destructible_v<value_type>) {
+      for (index_t i = next_full(0); i < _capacity; i = next_full(i + 1)) {
+        std::destroy_at(&_slots[i]);
+      }
+    }
+    if (_capacity > 0) {
+      std::memset(_ctrl, flat_hash_ctrl_empty, _capacity);
+    }
+    _size        = 0;
+    _num_deleted = 0;
+  }
+
+  template<typename Policy>
+  void flat_hash_table_t<Policy>::reserve(const index_t num_elements)
+  {
+    index_t new_capacity = std::max(_capacity, flat_hash_group_size);
+    while (max_load(new_capacity) < num_elements) {
+      new_capacity *= 2;
+    }
+    if (new_capacity != _capacity) {
+      rehash(new_capacity);
+    }
+  }
+
+  template<typename Policy>
+  template<typename Q>
+  index_t flat_hash_table_t<Policy>::find_index(const Q& key) const
+  {
+    if (_size == 0) {
+      return -1;
+    }
+    const flat_hash_bits_t bits(hash(key));
+    const uint64_t group_mask = _capacity / flat_hash_group_size - 1;
+    uint64_t group_index      = bits.h1 & group_mask;
+    for (uint64_t step = 1;; ++step) {
+      const index_t base = index_t(group_index) * flat_hash_group_size;
+      const flat_hash_group_t group(_ctrl + base);
+      for (uint32_t matches = group.match(bits.h2); matches != 0; matches &= matches - 1) {
+        const index_t index = base + std::countr_zero(matches);
+        if (equal(Policy::key(_slots[index]), key)) {
+          return index;
+        }
+      }
+      if (group.match_empty() != 0) {
+        return -1;
+      }
+      group_index = (group_index + step) & group_mask;
+    }
+  }
+
+  template<typename Policy>
+  index_t flat_hash_table_t<Policy>::find_free(const flat_hash_bits_t& bits) const
+  {
+    const uint64_t group_mask = _capacity / flat_hash_group_size - 1;
+    uint64_t group_index      = bits.h1 & group_mask;
+    for (uint64_t step = 1;; ++step) {
+      const index_t base   = index_t(group_index) * flat_hash_group_size;
+      const uint32_t frees = flat_hash_group_t(_ctrl + base).match_empty_or_deleted();
+      if (frees != 0) {
+        return base + std::countr_zero(frees);
+      }
+      group_index = (group_index + step) & group_mask;
+    }
+  }
+
+  template<typename Policy>
+  template<typename Q, typename Construct>
+  pair_t<index_t, bool> flat_hash_table_t<Policy>::find_or_construct(const Q& key,
+                                                                      Construct&& construct)
+  {
+    const index_t found = find_index(key);
+    if (found >= 0) {
+      return {found, false};
+    }
+    if (_size + _num_deleted + 1 > max_load(_capacity)) {
+      // Rehashing in place gets rid of the deleted slots, if there are enough of them.
+      const bool is_mostly_deleted = _num_deleted > _size;
+      rehash(is_mostly_deleted ? _capacity : std::max(2 * _capacity, flat_hash_group_size));
+    }
+    const flat_hash_bits_t bits(hash(key));
+    const index_t index = find_free(bits);
+    construct(&_slots[index]);
+    if (_ctrl[index] == flat_hash_ctrl_deleted) {
+      _num_deleted -= 1;
+    }
+    _ctrl[index] = bits.h2;
+    _size += 1;
+    return {index, true};
+  }
+
+  template<typename Policy>
+  index_t flat_hash_table_t<Policy>::next_full(index_t index) const
+  {
+    while (index < _capacity && _ctrl[index] < 0) {
+      index += 1;
+    }
+    return index;
+  }
+
+  template<typename Policy>
+  void flat_hash_table_t<Policy>::erase_at(const index_t index)
+  {
+    std::destroy_at(&_slots[index]);
+    _size -= 1;
+    // Lookups stop at the first group with an empty slot. If this slot's group has one, no lookup
+    // ever went past it, so the slot can become empty instead of deleted.
+    const index_t base = index - index % flat_hash_group_size;
+    if (flat_hash_group_t(_ctrl + base).match_empty() != 0) {
+      _ctrl[index] = flat_hash_ctrl_empty;
+    }
+    else {
+      _ctrl[index] = flat_hash_ctrl_deleted;
+      _num_deleted += 1;
+    }
+  }
+
+  template<typename Policy>
+  void flat_hash_table_t<Policy>::rehash(const index_t new_capacity)
+  {
+    flat_hash_table_t old(std::move(*this));
+    _ctrl     = new flat_hash_ctrl_t[new_capacity];
+    _slots    = std::allocator<value_type>{}.allocate(new_capacity);
+    _capacity = new_capacity;
+    std::memset(_ctrl, flat_hash_ctrl_empty, new_capacity);
+    for (index_t i = old.next_full(0); i < old._capacity; i = old.next_full(i + 1)) {
+      value_type& x = old._slots[i];
+      const flat_hash_bits_t bits(hash(Policy::key(x)));
+      const index_t index = find_free(bits);
+      std::construct_at(&_slots[index], std::move(x));
+      _ctrl[index] = bits.h2;
+      _size += 1;
+    }
+  }
+}
+
+namespace silva {
+  namespace impl {
+    template<typename Key, typename Value>
+    struct flat_hash_map_policy_t {
+      using key_type   = Key;
+      using value_type = pair_t<Key, Value>;
+      static const Key& key(const value_type& x) { return x.first; }
+    };
+
+    template<typename T>
+    struct flat_hash_set_policy_t {
+      using key_type   = T;
+      using value_type = T;
+      static const T& key(const T& x) { return x; }
+    };
+  }
+
+  template<typename Key, typename Value>
+  class flat_hash_map_t : public impl::flat_hash_table_t<impl::flat_hash_map_policy_t<Key, Value>> {
+    using base_t = impl::flat_hash_table_t<impl::flat_hash_map_policy_t<Key, Value>>;
+
+   public:
+    using typename base_t::const_iterator;
+    using typename base_t::iterator;
+    using typename base_t::value_type;
+    using mapped_type = Value;
+
+    template<typename Q, typename... Args>
+    pair_t<iterator, bool> try_emplace(Q&& key, Args&&... args)
+    {
+      const auto [index, inserted] = this->find_or_construct(key, [&](value_type* p) {
+        std::construct_at(p,
+                          std::piecewise_construct,
+                          std::forward_as_tuple(std::forward<Q>(key)),
+                          std::forward_as_tuple(std::forward<Args>(args)...));
+      });
+      return {this->iterator_at(index), inserted};
+    }
+
+    template<typename Q, typename... Args>
+    pair_t<iterator, bool> emplace(Q&& key, Args&&... args)
+    {
+      return try_emplace(std::forward<Q>(key), std::forward<Args>(args)...);
+    }
+
+    pair_t<iterator, bool> insert(const value_type& x) { return try_emplace(x.first, x.second); }
+    pair_t<iterator, bool> insert(value_type&& x)
+    {
+      return try_emplace(std::move(x.first), std::move(x.second));
+    }
+
+    template<typename Q>
+    Value& operator[](Q&& key)
+    {
+      return try_emplace(std::forward<Q>(key)).first->second;
+    }
+
+    template<typename Q>
+    Value& at(const Q& key)
+    {
+      const auto it = this->find(key);
+      SILVA_ASSERT(it != this->end());
+      return it->second;
+    }
+
+    template<typename Q>
+    const Value& at(const Q& key) const
+    {
+      const auto it = this->find(key);
+      SILVA_ASSERT(it != this->end());
+      return it->second;
+    }
+  };
+
+  template<typename T>
+  class flat_hash_set_t : public impl::flat_hash_table_t<impl::flat_hash_set_policy_t<T>> {
+    using base_t = impl::flat_hash_table_t<impl::flat_hash_set_policy_t<T>>;
+
+   public:
+    using typename base_t::const_iterator;
+    using typename base_t::iterator;
+    using typename base_t::value_type;
+
+    template<typename... Args>
+    pair_t<iterator, bool> emplace(Args&&... args)
+    {
+      return insert(T(std::forward<Args>(args)...));
+    }
+
+    pair_t<iterator, bool> insert(const T& x) { return emplace(T(x)); }
+    pair_t<iterator, bool> insert(T&& x)
+    {
+      const auto [index, inserted] = this->find_or_construct(x, [&](value_type* p) {
+        std::construct_at(p, std::move(x));
+      });
+      return {this->iterator_at(index), inserted};
+    }
+  };
+}
@@ -0,0 +1,82 @@
+#include "flat_hash.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <random>
+
+namespace silva::test {
+  // So that containers of them move rather than copy the tables when they reallocate.
+  static_assert(std::is_nothrow_move_constructible_v<flat_hash_map_t<string_t, index_t>>);
+  static_assert(std::is_nothrow_move_assignable_v<flat_hash_set_t<index_t>>);
+
+  TEST_CASE("flat-hash-map", "[flat_hash_map_t]")
+  {
+    flat_hash_map_t<string_t, index_t> fhm;
+    CHECK(fhm.empty());
+    CHECK(fhm.find("abc") == fhm.end());
+    fhm["abc"] = 1;
+    CHECK(fhm.emplace(string_view_t{"def"}, 2).second);
+    CHECK(!fhm.emplace("def", 3).second);
+    CHECK(fhm.size() == 2);
+    CHECK(fhm.at(string_view_t{"abc"}) == 1);
+    CHECK(fhm.find(string_t{"def"})->second == 2);
+    CHECK(!fhm.contains("xyz"));
+    CHECK(fhm.erase("abc") == 1);
+    CHECK(fhm.erase("abc") == 0);
+
+    const flat_hash_map_t<string_t, index_t> copy = fhm;
+    fhm.clear();
+    CHECK(fhm.empty());
+    CHECK(fhm.capacity() > 0);
+    CHECK(copy.size() == 1);
+    CHECK(copy.at("def") == 2);
+  }
+
+  TEST_CASE("flat-hash-map-random", "[flat_hash_map_t]")
+  {
+    flat_hash_map_t<index_t, index_t> fhm;
+    hash_map_t<index_t, index_t> expected;
+    std::mt19937 rng(42);
+    for (index_t i = 0; i < 100'000; ++i) {
+      const index_t key = rng() % 2'000;
+      switch (rng() % 3) {
+        case 0:
+          fhm[key]      = i;
+          expected[key] = i;
+          break;
+        case 1:
+          REQUIRE(fhm.erase(key) == index_t(expected.erase(key)));
+          break;
+        case 2: {
+          const auto it = fhm.find(key);
+          REQUIRE((it == fhm.end()) == !expected.contains(key));
+          if (it != fhm.end()) {
+            REQUIRE(it->second == expected.at(key));
+          }
+          break;
+        }
+      }
+    }
+    REQUIRE(fhm.size() == index_t(expected.size()));
+    for (const auto& [key, value]: fhm) {
+      CHECK(expected.at(key) == value);
+    }
+    for (auto it = fhm.begin(); it != fhm.end();) {
+      it = (it->first % 2 == 0) ? fhm.erase(it) : std::next(it);
+    }
+    for (const auto& [key, value]: fhm) {
+      CHECK(key % 2 == 1);
+    }
+  }
+
+  TEST_CASE("flat-hash-set", "[flat_hash_set_t]")
+  {
+    flat_hash_set_t<string_t> fhs;
+    CHECK(fhs.emplace("a").second);
+    CHECK(fhs.insert(string_t{"b"}).second);
+    CHECK(!fhs.emplace("a").second);
+    CHECK(fhs.size() == 2);
+    CHECK(fhs.contains(string_view_t{"b"}));
+    CHECK(fhs.count("c") == 0);
+  }
+}
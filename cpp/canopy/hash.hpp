@@ -4,6 +4,7 @@
 #include "string.hpp"
 #include "variant.hpp"
 
+#include <cstring>
 #include <typeindex>
 #include <unordered_map>
 #include <unordered_set>
@@ -33,6 +34,22 @@ namespace silva {
   template<typename T>
   using hash_set_t = std::unordered_set<T, hash_t, equal_t>;
 
+  // 64-bit hash of "size" bytes in the style of wyhash. Inputs of up to 16 bytes are covered by a
+  // few overlapping loads, longer inputs are consumed 16 bytes at a time, with three independent
+  // lanes for inputs above 48 bytes. All string types hash their characters with this function.
+  hash_value_t hash_bytes(const void* data, std::size_t size, uint64_t seed = 0);
+
+  // Multiplies "a" and "b" to 128 bits and folds the two halves together.
+  uint64_t hash_mix(uint64_t a, uint64_t b);
+
+  // Hashes a composite key one member at a time, e.g.
+  //
+  //   hash_combiner_t hc;
+  //   hc.combine(hash(x.parent_name));
+  //   hc.combine(hash(x.base_name));
+  //   return hc.value;
+  //
+  // Each step mixes the full state, so the result depends on the order of the members.
   struct hash_combiner_t {
     hash_value_t value = 0;
     void combine(hash_value_t);
@@ -77,19 +94,104 @@ namespace silva {
     return lhs == rhs;
   }
 
+  namespace impl {
+    constexpr uint64_t hash_secret[4] = {
+        0x2d35'8dcc'aa6c'78a5ull,
+        0x8bb8'4b93'962e'acc9ull,
+        0x4b33'a62e'd433'd4a3ull,
+        0x4d5a'2da5'1de1'aa47ull,
+    };
+
+    inline uint64_t hash_read_8(const unsigned char* p)
+    {
+      uint64_t retval;
+      std::memcpy(&retval, p, 8);
+      return retval;
+    }
+
+    inline uint64_t hash_read_4(const unsigned char* p)
+    {
+      uint32_t retval;
+      std::memcpy(&retval, p, 4);
+      return retval;
+    }
+
+    // Reads 1, 2, or 3 bytes.
+    inline uint64_t hash_read_3(const unsigned char* p, const std::size_t size)
+    {
+      return (uint64_t(p[0]) << 16) | (uint64_t(p[size >> 1]) << 8) | uint64_t(p[size - 1]);
+    }
+  }
+
+  inline uint64_t hash_mix(const uint64_t a, const uint64_t b)
+  {
+    const unsigned __int128 product = (unsigned __int128)(a) * b;
+    return uint64_t(product) ^ uint64_t(product >> 64);
+  }
+
+  inline hash_value_t hash_bytes(const void* const data, const std::size_t size, uint64_t seed)
+  {
+    using impl::hash_secret;
+    using impl::hash_read_8;
+    using impl::hash_read_4;
+    const auto* p = static_cast<const unsigned char*>(data);
+    seed ^= hash_mix(seed ^ hash_secret[0], hash_secret[1]);
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (size <= 16) {
+      if (size >= 4) {
+        const std::size_t offset = (size >> 3) << 2;
+        a = (hash_read_4(p) << 32) | hash_read_4(p + offset);
+        b = (hash_read_4(p + size - 4) << 32) | hash_read_4(p + size - 4 - offset);
+      }
+      else if (size > 0) {
+        a = impl::hash_read_3(p, size);
+      }
+    }
+    else {
+      std::size_t left = size;
+      if (left > 48) {
+        uint64_t seed_1 = seed;
+        uint64_t seed_2 = seed;
+        do {
+          seed   = hash_mix(hash_read_8(p) ^ hash_secret[1], hash_read_8(p + 8) ^ seed);
+          seed_1 = hash_mix(hash_read_8(p + 16) ^ hash_secret[2], hash_read_8(p + 24) ^ seed_1);
+          seed_2 = hash_mix(hash_read_8(p + 32) ^ hash_secret[3], hash_read_8(p + 40) ^ seed_2);
+          p += 48;
+          left -= 48;
+        } while (left > 48);
+        seed ^= seed_1 ^ seed_2;
+      }
+      while (left > 16) {
+        seed = hash_mix(hash_read_8(p) ^ hash_secret[1], hash_read_8(p + 8) ^ seed);
+        p += 16;
+        left -= 16;
+      }
+      // The last 16 bytes of the input, which may overlap with the ones already consumed.
+      a = hash_read_8(p + left - 16);
+      b = hash_read_8(p + left - 8);
+    }
+    a ^= hash_secret[1];
+    b ^= seed;
+    const unsigned __int128 product = (unsigned __int128)(a) * b;
+    a                               = uint64_t(product);
+    b                               = uint64_t(product >> 64);
+    return hash_mix(a ^ hash_secret[0] ^ size, b ^ hash_secret[1]);
+  }
+
   inline void hash_combiner_t::combine(const hash_value_t x)
   {
-    value ^= x + 0x9e3779b9 + (value << 6) + (value >> 2);
+    value = hash_mix(value ^ impl::hash_secret[0], uint64_t(x) ^ impl::hash_secret[1]);
   }
 
   inline hash_value_t hash_impl(const string_t& x)
   {
-    return std::hash<string_view_t>{}(x);
+    return hash_bytes(x.data(), x.size());
   }
 
   inline hash_value_t hash_impl(const string_view_t& x)
   {
-    return std::hash<string_view_t>{}(x);
+    return hash_bytes(x.data(), x.size());
   }
 
   template<typename T>
@@ -104,7 +206,7 @@ namespace silva {
   hash_value_t hash_impl(T x)
   {
     if constexpr (std::same_as<std::remove_cv_t<std::remove_pointer_t<T>>, char>) {
-      return std::hash<string_view_t>{}(string_view_t{x});
+      return hash_bytes(x, std::strlen(x));
     }
     else {
       return hash_value_t(x);
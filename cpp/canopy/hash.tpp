@@ -1,7 +1,12 @@
 #include "hash.hpp"
 
+#include "time.hpp"
+
 #include <catch2/catch_all.hpp>
 
+#include <algorithm>
+#include <random>
+
 TEST_CASE("hash")
 {
   silva::hash('a');
@@ -26,4 +31,120 @@ namespace silva::test {
     hash(tuple_t<int, int, int>{0, 1, 2});
     hash(variant_t<int, int, int>{});
   }
+
+  namespace {
+    // For each bit of the input, flips it and records which bits of the output change. Returns
+    // the lowest and highest probability of any output bit to flip.
+    template<typename HashFunc>
+    pair_t<double, double> avalanche_range(const index_t num_samples,
+                                           const index_t num_input_bytes,
+                                           HashFunc hash_func)
+    {
+      std::mt19937_64 rng(42);
+      array_t<unsigned char> input(num_input_bytes);
+      array_t<index_t> flip_counts(64, 0);
+      for (index_t sample = 0; sample < num_samples; ++sample) {
+        for (auto& x: input) {
+          x = static_cast<unsigned char>(rng());
+        }
+        const uint64_t base = hash_func(input);
+        for (index_t bit = 0; bit < num_input_bytes * 8; ++bit) {
+          input[bit / 8] ^= (1u << (bit % 8));
+          const uint64_t diff = base ^ hash_func(input);
+          input[bit / 8] ^= (1u << (bit % 8));
+          for (index_t j = 0; j < 64; ++j) {
+            flip_counts[j] += (diff >> j) & 1;
+          }
+        }
+      }
+      const double num_trials = double(num_samples) * num_input_bytes * 8;
+      const auto [lo, hi]     = std::ranges::minmax(flip_counts);
+      return {lo / num_trials, hi / num_trials};
+    }
+  }
+
+  TEST_CASE("hash-bytes", "[hash_bytes]")
+  {
+    string_t buffer;
+    for (index_t i = 0; i < 200; ++i) {
+      buffer.push_back(char('a' + i % 26));
+    }
+    hash_set_t<hash_value_t> prefix_hashes;
+    for (index_t len = 0; len <= index_t(buffer.size()); ++len) {
+      const string_view_t prefix{buffer.data(), std::size_t(len)};
+      const hash_value_t hv = hash(prefix);
+      CHECK(hv == hash(string_t{prefix}));
+      CHECK(hv == hash_bytes(prefix.data(), prefix.size()));
+      CHECK(hv != hash_bytes(prefix.data(), prefix.size(), 1));
+      prefix_hashes.insert(hv);
+
+      // Every single byte is part of the hash, in particular the ones of overlapping loads.
+      string_t changed{prefix};
+      for (index_t i = 0; i < len; ++i) {
+        changed[i] ^= 1;
+        CHECK(hash(changed) != hv);
+        changed[i] ^= 1;
+      }
+    }
+    CHECK(prefix_hashes.size() == buffer.size() + 1);
+  }
+
+  TEST_CASE("hash-avalanche", "[hash_bytes][hash_combiner_t]")
+  {
+    for (const index_t num_input_bytes: {1, 3, 4, 8, 13, 16, 17, 40, 48, 49, 100}) {
+      INFO("num_input_bytes = " << num_input_bytes);
+      const auto [lo, hi] = avalanche_range(200, num_input_bytes, [](const auto& input) {
+        return hash_bytes(input.data(), input.size());
+      });
+      CHECK(lo > 0.4);
+      CHECK(hi < 0.6);
+    }
+    const auto [lo, hi] = avalanche_range(200, 16, [](const auto& input) {
+      uint64_t first  = 0;
+      uint64_t second = 0;
+      std::memcpy(&first, input.data(), 8);
+      std::memcpy(&second, input.data() + 8, 8);
+      hash_combiner_t hc;
+      hc.combine(first);
+      hc.combine(second);
+      return hc.value;
+    });
+    CHECK(lo > 0.4);
+    CHECK(hi < 0.6);
+
+    hash_combiner_t hc_1, hc_2;
+    hc_1.combine(1);
+    hc_1.combine(2);
+    hc_2.combine(2);
+    hc_2.combine(1);
+    CHECK(hc_1.value != hc_2.value);
+  }
+
+  TEST_CASE("hash-performance", "[hash_bytes][.]")
+  {
+    constexpr index_t total_bytes = 256 * 1024 * 1024;
+    const string_t buffer(64 * 1024 + 64, 'x');
+    for (const index_t len: {4, 8, 16, 32, 64, 256, 1024, 64 * 1024}) {
+      const index_t num_iterations = total_bytes / len;
+      const auto run               = [&](const string_view_t name, const auto& func) {
+        hash_value_t sink = 0;
+        const auto start  = time_point_t::now();
+        for (index_t i = 0; i < num_iterations; ++i) {
+          // Varying the offset keeps the compiler from hoisting the hash out of the loop.
+          sink ^= func(string_view_t{buffer.data() + (i & 63), std::size_t(len)});
+        }
+        const auto took = time_point_t::now() - start;
+        fmt::println("{:24} len {:6}  {}  {:.2f} GB/s  ({})",
+                     name,
+                     len,
+                     took,
+                     double(total_bytes) / double(took.nanos),
+                     sink & 1);
+      };
+      run("hash_bytes", [](const string_view_t x) { return hash_bytes(x.data(), x.size()); });
+      run("std::hash<string_view>", [](const string_view_t x) {
+        return std::hash<string_view_t>{}(x);
+      });
+    }
+  }
 }
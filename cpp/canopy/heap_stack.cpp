@@ -0,0 +1,150 @@
+#include "heap_stack.hpp"
+
+#include "assert.hpp"
+
+#include <exception>
+#include <limits>
+#include <memory>
+#include <ucontext.h>
+
+#if defined(__SANITIZE_ADDRESS__)
+#define SILVA_HEAP_STACK_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define SILVA_HEAP_STACK_ASAN 1
+#endif
+#endif
+
+#ifdef SILVA_HEAP_STACK_ASAN
+#include <sanitizer/common_interface_defs.h>
+#endif
+
+#if defined(__SANITIZE_THREAD__)
+#define SILVA_HEAP_STACK_TSAN 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define SILVA_HEAP_STACK_TSAN 1
+#endif
+#endif
+
+#ifdef SILVA_HEAP_STACK_TSAN
+#include <sanitizer/tsan_interface.h>
+#endif
+
+namespace silva::impl {
+  namespace {
+    struct heap_stack_frame_t {
+      void (*func)(void*) = nullptr;
+      void* data          = nullptr;
+
+      char* stack         = nullptr;
+      index_t stack_bytes = 0;
+
+      ucontext_t caller_context{};
+      ucontext_t callee_context{};
+      std::exception_ptr exception;
+
+      const void* caller_stack_bottom = nullptr;
+      size_t caller_stack_size        = 0;
+
+      // TSan's view of the two stacks (see SILVA_HEAP_STACK_TSAN).
+      void* caller_fiber = nullptr;
+      void* callee_fiber = nullptr;
+
+      heap_stack_frame_t* prev = nullptr;
+    };
+
+    thread_local heap_stack_frame_t* heap_stack_frame_current = nullptr;
+
+    void heap_stack_trampoline()
+    {
+      heap_stack_frame_t* frame = heap_stack_frame_current;
+#ifdef SILVA_HEAP_STACK_ASAN
+      __sanitizer_finish_switch_fiber(nullptr,
+                                      &frame->caller_stack_bottom,
+                                      &frame->caller_stack_size);
+#endif
+      try {
+        frame->func(frame->data);
+      }
+      catch (...) {
+        frame->exception = std::current_exception();
+      }
+#ifdef SILVA_HEAP_STACK_ASAN
+      // Passing nullptr tells ASan that this stack is about to be destroyed.
+      __sanitizer_start_switch_fiber(nullptr, frame->caller_stack_bottom, frame->caller_stack_size);
+#endif
+#ifdef SILVA_HEAP_STACK_TSAN
+      // Switching back explicitly rather than returning via "uc_link", as TSan would otherwise
+      // record the return from this function on the caller's fiber.
+      __tsan_switch_to_fiber(frame->caller_fiber, 0);
+      swapcontext(&frame->callee_context, &frame->caller_context);
+#endif
+      // Returning continues at "frame->caller_context" via "uc_link".
+    }
+  }
+
+  void heap_stack_run(heap_stack_t& heap_stack, void (*func)(void*), void* data)
+  {
+    const index_t stack_bytes = heap_stack.stack_bytes;
+    SILVA_ASSERT(stack_bytes > 0);
+    heap_stack_frame_t frame{
+        .func        = func,
+        .data        = data,
+        .stack       = heap_stack.memory.get(),
+        .stack_bytes = stack_bytes,
+    };
+    const int rc_get = getcontext(&frame.callee_context);
+    SILVA_ASSERT(rc_get == 0);
+    frame.callee_context.uc_stack.ss_sp   = frame.stack;
+    frame.callee_context.uc_stack.ss_size = stack_bytes;
+    frame.callee_context.uc_link          = &frame.caller_context;
+    makecontext(&frame.callee_context, &heap_stack_trampoline, 0);
+
+    frame.prev               = heap_stack_frame_current;
+    heap_stack_frame_current = &frame;
+#ifdef SILVA_HEAP_STACK_ASAN
+    void* fake_stack = nullptr;
+    __sanitizer_start_switch_fiber(&fake_stack, frame.stack, stack_bytes);
+#endif
+#ifdef SILVA_HEAP_STACK_TSAN
+    frame.caller_fiber = __tsan_get_current_fiber();
+    frame.callee_fiber = __tsan_create_fiber(0);
+    __tsan_switch_to_fiber(frame.callee_fiber, 0);
+#endif
+    const int rc_swap = swapcontext(&frame.caller_context, &frame.callee_context);
+    SILVA_ASSERT(rc_swap == 0);
+#ifdef SILVA_HEAP_STACK_ASAN
+    __sanitizer_finish_switch_fiber(fake_stack, nullptr, nullptr);
+#endif
+#ifdef SILVA_HEAP_STACK_TSAN
+    __tsan_destroy_fiber(frame.callee_fiber);
+#endif
+    heap_stack_frame_current = frame.prev;
+
+    if (frame.exception) {
+      std::rethrow_exception(std::move(frame.exception));
+    }
+  }
+}
+
+namespace silva {
+  void heap_stack_t::resize(const index_t new_stack_bytes)
+  {
+    if (stack_bytes != new_stack_bytes) {
+      memory      = std::make_unique_for_overwrite<char[]>(new_stack_bytes);
+      stack_bytes = new_stack_bytes;
+    }
+  }
+
+  index_t heap_stack_bytes_left()
+  {
+    const impl::heap_stack_frame_t* frame = impl::heap_stack_frame_current;
+    if (frame == nullptr) {
+      return std::numeric_limits<index_t>::max();
+    }
+    // Stacks grow downwards on all supported platforms.
+    const char* stack_pointer = static_cast<const char*>(__builtin_frame_address(0));
+    return index_t(stack_pointer - frame->stack);
+  }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <type_traits>
+#include <utility>
+
+namespace silva {
+  // Runs "func" on the calling thread, but on a freshly heap-allocated stack of "stack_bytes"
+  // bytes. Deeply recursive algorithms (e.g., the Seed interpreter) use this to replace the fixed
+  // and unknown amount of space left on the thread's stack with an explicit memory budget.
+  // Exceptions thrown by "func" are propagated to the caller. Calls may be nested.
+  template<typename Func>
+  std::invoke_result_t<Func> heap_stack_run(index_t stack_bytes, Func&& func);
+
+  // Memory for heap_stack_run() that can be kept across calls, so that many short runs don't each
+  // allocate (and fault in) a stack of their own. A heap_stack_t may only be used by one
+  // heap_stack_run() at a time.
+  struct heap_stack_t {
+    unique_ptr_t<char[]> memory;
+    index_t stack_bytes = 0;
+
+    // Reallocates "memory" unless it already has exactly "stack_bytes" bytes.
+    void resize(index_t stack_bytes);
+  };
+  template<typename Func>
+  std::invoke_result_t<Func> heap_stack_run(heap_stack_t&, Func&& func);
+
+  // Number of bytes left on the innermost heap-stack of the calling thread. Returns the maximum
+  // index_t when not called from inside heap_stack_run().
+  index_t heap_stack_bytes_left();
+}
+
+// IMPLEMENTATION
+
+namespace silva {
+  namespace impl {
+    void heap_stack_run(heap_stack_t&, void (*func)(void*), void* data);
+  }
+
+  template<typename Func>
+  std::invoke_result_t<Func> heap_stack_run(const index_t stack_bytes, Func&& func)
+  {
+    heap_stack_t heap_stack;
+    heap_stack.resize(stack_bytes);
+    return heap_stack_run(heap_stack, std::forward<Func>(func));
+  }
+
+  template<typename Func>
+  std::invoke_result_t<Func> heap_stack_run(heap_stack_t& heap_stack, Func&& func)
+  {
+    using retval_t = std::invoke_result_t<Func>;
+    if constexpr (std::is_void_v<retval_t>) {
+      impl::heap_stack_run(
+          heap_stack,
+          [](void* data) { (*static_cast<std::remove_reference_t<Func>*>(data))(); },
+          &func);
+    }
+    else {
+      struct data_t {
+        std::remove_reference_t<Func>* func = nullptr;
+        optional_t<retval_t> retval;
+      };
+      data_t data{.func = &func};
+      impl::heap_stack_run(
+          heap_stack,
+          [](void* data) {
+            auto* dd = static_cast<data_t*>(data);
+            dd->retval.emplace((*dd->func)());
+          },
+          &data);
+      return std::move(data.retval).value();
+    }
+  }
+}
@@ -0,0 +1,60 @@
+#include "heap_stack.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <limits>
+#include <stdexcept>
+
+namespace silva::test {
+  namespace {
+    index_t recurse(const index_t depth)
+    {
+      volatile char padding[256];
+      padding[0] = char(depth);
+      if (depth == 0) {
+        return heap_stack_bytes_left();
+      }
+      return recurse(depth - 1) + (padding[0] - char(depth));
+    }
+  }
+
+  TEST_CASE("heap-stack", "[heap_stack_t]")
+  {
+    CHECK(heap_stack_bytes_left() == std::numeric_limits<index_t>::max());
+
+    // Far deeper than what would fit onto the usual 8 MiB thread stack.
+    const index_t budget = 128 * 1024 * 1024;
+    const index_t left   = heap_stack_run(budget, [] { return recurse(100'000); });
+    CHECK(0 < left);
+    CHECK(left < budget - 100'000 * 256);
+
+    const auto [outer, inner] = heap_stack_run(1024 * 1024, [] {
+      const index_t outer = heap_stack_bytes_left();
+      const index_t inner = heap_stack_run(64 * 1024, [] { return heap_stack_bytes_left(); });
+      return pair_t<index_t, index_t>{outer, inner};
+    });
+    CHECK(outer <= 1024 * 1024);
+    CHECK(inner <= 64 * 1024);
+    CHECK(heap_stack_bytes_left() == std::numeric_limits<index_t>::max());
+
+    bool has_run = false;
+    heap_stack_run(64 * 1024, [&] { has_run = true; });
+    CHECK(has_run);
+
+    CHECK_THROWS_AS(heap_stack_run(64 * 1024, [] { throw std::runtime_error("x"); }),
+                    std::runtime_error);
+    CHECK(heap_stack_bytes_left() == std::numeric_limits<index_t>::max());
+
+    heap_stack_t heap_stack;
+    heap_stack.resize(1024 * 1024);
+    const char* memory = heap_stack.memory.get();
+    for (index_t i = 0; i < 3; ++i) {
+      CHECK(heap_stack_run(heap_stack, [] { return recurse(1'000); }) > 0);
+    }
+    heap_stack.resize(1024 * 1024);
+    CHECK(heap_stack.memory.get() == memory);
+    CHECK_THROWS_AS(heap_stack_run(heap_stack, [] { throw std::runtime_error("x"); }),
+                    std::runtime_error);
+    CHECK(heap_stack_run(heap_stack, [] { return heap_stack_bytes_left(); }) <= 1024 * 1024);
+  }
+}
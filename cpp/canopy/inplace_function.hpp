@@ -0,0 +1,207 @@
+#pragma once
+
+#include "assert.hpp"
+#include "types.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace silva {
+  // Move-only replacement for std::function that stores the callable in an inline buffer of
+  // "BufferSize" bytes. Callables that don't fit are a compile-time error, unless "HeapFallback"
+  // is set, in which case they are stored on the heap. Unlike delegate_t, it owns the callable, so
+  // there is no pack_t whose lifetime has to be managed by hand.
+  //
+  // Like std::function, operator() is const but invokes the callable as non-const.
+  template<typename Func, index_t BufferSize = 4 * sizeof(void*), bool HeapFallback = false>
+  struct inplace_function_t;
+
+  template<typename Func, index_t BufferSize = 4 * sizeof(void*)>
+  using move_only_function_t = inplace_function_t<Func, BufferSize, true>;
+
+  namespace impl {
+    template<typename T>
+    constexpr bool is_inplace_function = false;
+    template<typename Func, index_t BufferSize, bool HeapFallback>
+    constexpr bool is_inplace_function<inplace_function_t<Func, BufferSize, HeapFallback>> = true;
+  }
+
+  template<typename R, typename... Args, index_t BufferSize, bool HeapFallback>
+  struct inplace_function_t<R(Args...), BufferSize, HeapFallback> {
+    static_assert(BufferSize >= index_t(sizeof(void*)));
+
+    inplace_function_t() = default;
+    inplace_function_t(std::nullptr_t);
+
+    template<typename F>
+      requires(!impl::is_inplace_function<std::decay_t<F>> &&
+               std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+    inplace_function_t(F&&);
+
+    inplace_function_t(inplace_function_t&&) noexcept;
+    inplace_function_t& operator=(inplace_function_t&&) noexcept;
+    inplace_function_t(const inplace_function_t&)            = delete;
+    inplace_function_t& operator=(const inplace_function_t&) = delete;
+    ~inplace_function_t();
+
+    // Whether a callable of type "F" is stored in the inline buffer.
+    template<typename F>
+    constexpr static bool stored_inline = sizeof(F) <= BufferSize &&
+        alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<F>;
+
+    bool has_value() const;
+    explicit operator bool() const;
+
+    void clear();
+
+    // Must only be called if has_value().
+    R operator()(Args...) const;
+
+   private:
+    using invoker_t = R (*)(void*, Args&&...);
+    invoker_t invoker = nullptr;
+
+    // Moves the callable from the second buffer into the first one and destroys it in the second
+    // one, or, if the first one is nullptr, only destroys it. Stays nullptr for trivially copyable
+    // callables, whose buffer is simply copied.
+    using manager_t = void (*)(void*, void*);
+    manager_t manager = nullptr;
+
+    alignas(std::max_align_t) mutable std::byte buffer[BufferSize];
+
+    // Takes over the callable of "other" and leaves it empty. Must only be called while this one
+    // is empty.
+    void take(inplace_function_t& other);
+  };
+}
+
+// IMPLEMENTATION
+
+namespace silva {
+  template<typename R, typename... Args, index_t BufferSize, bool HeapFallback>
+  inplace_function_t<R(Args...), BufferSize, HeapFallback>::inplace_function_t(std::nullptr_t)
+  {
+  }
+
+  template<typename R, typename... Args, index_t BufferSize, bool HeapFallback>
+  template<typename F>
+    requires(!impl::is_inplace_function<std::decay_t<F>> &&
+             std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+  inplace_function_t<R(Args...), BufferSize, HeapFallback>::inplace_function_t(F&& f)
+  {
+    using callable_t = std::decay_t<F>;
+    if constexpr (std::is_pointer_v<callable_t> || std::is_member_pointer_v<callable_t>) {
+      if (f == nullptr) {
+        return;
+      }
+    }
+    if constexpr (stored_inline<callable_t>) {
+      new (buffer) callable_t(std::forward<F>(f));
+      invoker = +[](void* ptr, Args&&... args) -> R {
+        return std::invoke(*static_cast<callable_t*>(ptr), std::forward<Args>(args)...);
+      };
+      if constexpr (!std::is_trivially_copyable_v<callable_t>) {
+        manager = +[](void* dst, void* src) {
+          callable_t* src_callable = static_cast<callable_t*>(src);
+          if (dst != nullptr) {
+            new (dst) callable_t(std::move(*src_callable));
+          }
+          src_callable->~callable_t();
+        };
+      }
+    }
+    else {
+      static_assert(HeapFallback,
+                    "callable doesn't fit into the inline buffer of inplace_function_t, increase "
+                    "its BufferSize or use move_only_function_t");
+      callable_t* heap_callable = new callable_t(std::forward<F>(f));
+      std::memcpy(buffer, &heap_callable, sizeof(heap_callable));
+      invoker = +[](void* ptr, Args&&... args) -> R {
+        return std::invoke(**static_cast<callable_t**>(ptr), std::forward<Args>(args)...);
+      };
+      manager = +[](void* dst, void* src) {
+        if (dst != nullptr) {
+          std::memcpy(dst, src, sizeof(callable_t*));
+        }
+        else {
+          delete *static_cast<callable_t**>(src);
+        }
+      };
+    }
+  }
+
+  template<typename R, typename... Args, index_t BufferSize, bool HeapFallback>
+  inplace_function_t<R(Args...), BufferSize, HeapFallback>::inplace_function_t(
+      inplace_function_t&& other) noexcept
+  {
+    take(other);
+  }
+
+  template<typename R, typename... Args, index_t BufferSize, bool HeapFallback>
+  inplace_function_t<R(Args...), BufferSize, HeapFallback>&
+  inplace_function_t<R(Args...), BufferSize, HeapFallback>::operator=(
+      inplace_function_t&& other) noexcept
+  {
+    if (this != &other) {
+      clear();
+      take(other);
+    }
+    return *this;
+  }
+
+  template<typename R, typename... Args, index_t BufferSize, bool HeapFallback>
+  void inplace_function_t<R(Args...), BufferSize, HeapFallback>::take(inplace_function_t& other)
+  {
+    invoker = other.invoker;
+    manager = other.manager;
+    if (invoker != nullptr) {
+      if (manager != nullptr) {
+        manager(buffer, other.buffer);
+      }
+      else {
+        std::memcpy(buffer, other.buffer, BufferSize);
+      }
+    }
+    other.invoker = nullptr;
+    other.manager = nullptr;
+  }
+
+  template<typename R, typename... Args, index_t BufferSize, bool HeapFallback>
+  inplace_function_t<R(Args...), BufferSize, HeapFallback>::~inplace_function_t()
+  {
+    clear();
+  }
+
+  template<typename R, typename... Args, index_t BufferSize, bool HeapFallback>
+  bool inplace_function_t<R(Args...), BufferSize, HeapFallback>::has_value() const
+  {
+    return invoker != nullptr;
+  }
+
+  template<typename R, typename... Args, index_t BufferSize, bool HeapFallback>
+  inplace_function_t<R(Args...), BufferSize, HeapFallback>::operator bool() const
+  {
+    return has_value();
+  }
+
+  template<typename R, typename... Args, index_t BufferSize, bool HeapFallback>
+  void inplace_function_t<R(Args...), BufferSize, HeapFallback>::clear()
+  {
+    if (invoker != nullptr && manager != nullptr) {
+      manager(nullptr, buffer);
+    }
+    invoker = nullptr;
+    manager = nullptr;
+  }
+
+  template<typename R, typename... Args, index_t BufferSize, bool HeapFallback>
+  R inplace_function_t<R(Args...), BufferSize, HeapFallback>::operator()(Args... args) const
+  {
+    SILVA_ASSERT(invoker != nullptr, "called an empty inplace_function_t");
+    return invoker(buffer, std::forward<Args>(args)...);
+  }
+}
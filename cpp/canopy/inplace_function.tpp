@@ -0,0 +1,134 @@
+#include "inplace_function.hpp"
+
+#include "delegate.hpp"
+#include "time.hpp"
+
+#include <catch2/catch_all.hpp>
+
+namespace silva::test {
+  namespace {
+    int free_func(const int x)
+    {
+      return x + 1;
+    }
+
+    // Counts the instances alive.
+    struct counted_t {
+      int* alive = nullptr;
+      int value  = 0;
+
+      counted_t(int* alive, const int value) : alive(alive), value(value) { *alive += 1; }
+      counted_t(counted_t&& other) noexcept : alive(other.alive), value(other.value)
+      {
+        *alive += 1;
+      }
+      ~counted_t() { *alive -= 1; }
+
+      int operator()(const int x) { return value += x; }
+    };
+  }
+
+  TEST_CASE("inplace-function", "[inplace_function_t]")
+  {
+    using func_t = inplace_function_t<int(int)>;
+
+    func_t empty;
+    CHECK(!empty.has_value());
+    CHECK(!func_t{nullptr});
+    int (*null_func_ptr)(int) = nullptr;
+    CHECK(!func_t{null_func_ptr});
+
+    func_t ff{&free_func};
+    CHECK(ff.has_value());
+    CHECK(ff(41) == 42);
+
+    const int offset = 10;
+    func_t lambda    = [offset](const int x) { return x + offset; };
+    CHECK(lambda(5) == 15);
+
+    int alive = 0;
+    {
+      func_t counted{counted_t{&alive, 100}};
+      CHECK(alive == 1);
+      CHECK(counted(1) == 101);
+      CHECK(counted(1) == 102);
+
+      func_t moved{std::move(counted)};
+      CHECK(alive == 1);
+      CHECK(!counted.has_value());
+      CHECK(moved(1) == 103);
+
+      counted = std::move(moved);
+      CHECK(alive == 1);
+      CHECK(counted(1) == 104);
+
+      counted = std::move(lambda);
+      CHECK(alive == 0);
+      CHECK(counted(5) == 15);
+
+      counted = func_t{counted_t{&alive, 0}};
+      CHECK(alive == 1);
+    }
+    CHECK(alive == 0);
+
+    // Move-only captures are fine.
+    inplace_function_t<int()> move_only = [p = std::make_unique<int>(7)] { return *p; };
+    CHECK(move_only() == 7);
+  }
+
+  TEST_CASE("inplace-function-heap-fallback", "[inplace_function_t]")
+  {
+    using func_t = move_only_function_t<int(int), 16>;
+    struct big_t {
+      array_fixed_t<int, 64> values{};
+      int operator()(const int x) const { return values[x]; }
+    };
+    static_assert(!func_t::stored_inline<big_t>);
+    big_t big;
+    big.values[3] = 42;
+    int alive     = 0;
+    {
+      func_t func = big;
+      CHECK(func(3) == 42);
+      func_t moved = std::move(func);
+      CHECK(!func.has_value());
+      CHECK(moved(3) == 42);
+
+      using big_counted_t = move_only_function_t<int(int), 8>;
+      static_assert(!big_counted_t::stored_inline<counted_t>);
+      big_counted_t counted{counted_t{&alive, 1}};
+      CHECK(alive == 1);
+      big_counted_t moved_counted{std::move(counted)};
+      CHECK(alive == 1);
+      CHECK(moved_counted(1) == 2);
+    }
+    CHECK(alive == 0);
+  }
+
+  TEST_CASE("inplace-function-performance", "[inplace_function_t][.]")
+  {
+    constexpr index_t num_iterations = 100'000'000;
+    index_t state                    = 0;
+    const auto callback              = [&state](const index_t x) { return state += x; };
+
+    const auto run = [&](const string_view_t name, const auto& func) {
+      state            = 0;
+      const auto start = time_point_t::now();
+      for (index_t i = 0; i < num_iterations; ++i) {
+        func(i & 7);
+      }
+      const auto took = time_point_t::now() - start;
+      fmt::println("{:24}  {}  {:.2f} ns/call  ({})",
+                   name,
+                   took,
+                   double(took.nanos) / double(num_iterations),
+                   state);
+    };
+    const function_t<index_t(index_t)> std_func = callback;
+    run("std::function", std_func);
+    const delegate_t<index_t(index_t)>::pack_t pack{callback};
+    run("delegate_t", pack.delegate);
+    const inplace_function_t<index_t(index_t)> inplace_func = callback;
+    run("inplace_function_t", inplace_func);
+  }
+}
@@ -0,0 +1,26 @@
+#include "memory_context.hpp"
+
+#include "assert.hpp"
+
+namespace silva {
+  memory_context_t::memory_context_t(const memory_resource_kind_t kind) : kind(kind)
+  {
+    const auto parent = get_parent();
+    memory_resource_t* upstream =
+        parent.is_nullptr() ? std::pmr::new_delete_resource() : parent->resource;
+    switch (kind) {
+      case memory_resource_kind_t::HEAP:
+        resource = std::pmr::new_delete_resource();
+        break;
+      case memory_resource_kind_t::ARENA:
+        owned_resource = std::make_unique<std::pmr::monotonic_buffer_resource>(upstream);
+        resource       = owned_resource.get();
+        break;
+      case memory_resource_kind_t::POOL:
+        owned_resource = std::make_unique<std::pmr::unsynchronized_pool_resource>(upstream);
+        resource       = owned_resource.get();
+        break;
+    }
+    SILVA_ASSERT(resource != nullptr);
+  }
+}
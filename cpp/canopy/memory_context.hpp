@@ -0,0 +1,104 @@
+#pragma once
+
+#include "context.hpp"
+#include "hash.hpp"
+#include "string.hpp"
+
+#include <memory_resource>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace silva {
+  using memory_resource_t = std::pmr::memory_resource;
+
+  enum class memory_resource_kind_t {
+    // Every allocation goes to the global heap, as if there was no memory_context_t.
+    HEAP,
+
+    // Monotonic: deallocation is a no-op and everything is released at once when the context
+    // ends. For many small and short-lived allocations, e.g., the scratch data of a compile run.
+    ARENA,
+
+    // Size-segregated free lists: freed blocks are reused, everything else is released when the
+    // context ends.
+    POOL,
+  };
+
+  // The memory_*_t containers below allocate from the memory_context_t that is current when they
+  // are constructed. The ARENA and POOL resources in turn obtain their chunks from the context that
+  // was current when they were created. Nothing that allocated from an ARENA or POOL context may
+  // outlive it.
+  struct memory_context_t : public context_t<memory_context_t> {
+    constexpr static bool context_use_default = true;
+    constexpr static bool context_mutable_get = true;
+
+    memory_resource_kind_t kind = memory_resource_kind_t::HEAP;
+    memory_resource_t* resource = nullptr;
+
+    explicit memory_context_t(memory_resource_kind_t = memory_resource_kind_t::HEAP);
+
+   private:
+    unique_ptr_t<memory_resource_t> owned_resource;
+  };
+
+  template<typename T>
+  struct memory_allocator_t : public std::pmr::polymorphic_allocator<T> {
+    using std::pmr::polymorphic_allocator<T>::polymorphic_allocator;
+
+    // Allocates from the current memory_context_t.
+    memory_allocator_t();
+
+    // Like std::pmr::polymorphic_allocator, elements of a container that are themselves
+    // containers allocate from the same resource as the enclosing container.
+    template<typename U>
+    memory_allocator_t(const std::pmr::polymorphic_allocator<U>&);
+
+    // Copies of a container allocate from the memory_context_t that is current when they are made,
+    // not from the one of the original.
+    memory_allocator_t select_on_container_copy_construction() const;
+  };
+
+  template<typename T>
+  using memory_array_t = std::vector<T, memory_allocator_t<T>>;
+
+  template<typename K, typename V>
+  using memory_hash_map_t =
+      std::unordered_map<K, V, hash_t, equal_t, memory_allocator_t<std::pair<const K, V>>>;
+
+  template<typename T>
+  using memory_hash_set_t = std::unordered_set<T, hash_t, equal_t, memory_allocator_t<T>>;
+
+  using memory_string_t = std::basic_string<char, std::char_traits<char>, memory_allocator_t<char>>;
+
+  hash_value_t hash_impl(const memory_string_t&);
+}
+
+// IMPLEMENTATION
+
+namespace silva {
+  template<typename T>
+  memory_allocator_t<T>::memory_allocator_t()
+    : std::pmr::polymorphic_allocator<T>(memory_context_t::get()->resource)
+  {
+  }
+
+  template<typename T>
+  template<typename U>
+  memory_allocator_t<T>::memory_allocator_t(const std::pmr::polymorphic_allocator<U>& other)
+    : std::pmr::polymorphic_allocator<T>(other.resource())
+  {
+  }
+
+  template<typename T>
+  memory_allocator_t<T> memory_allocator_t<T>::select_on_container_copy_construction() const
+  {
+    return memory_allocator_t{};
+  }
+
+  inline hash_value_t hash_impl(const memory_string_t& x)
+  {
+    return hash_bytes(x.data(), x.size());
+  }
+}
@@ -0,0 +1,46 @@
+#include "memory_context.hpp"
+
+#include <catch2/catch_all.hpp>
+
+namespace silva::test {
+  TEST_CASE("memory-context", "[memory_context_t]")
+  {
+    CHECK(memory_context_t::get()->kind == memory_resource_kind_t::HEAP);
+    CHECK(memory_context_t::get()->resource == std::pmr::new_delete_resource());
+    memory_array_t<int> outside{1, 2, 3};
+    {
+      memory_context_t arena(memory_resource_kind_t::ARENA);
+      CHECK(memory_context_t::get()->resource == arena.resource);
+
+      memory_array_t<memory_string_t> strings;
+      strings.emplace_back("a string that is too long for the small-string optimization");
+      CHECK(strings.get_allocator().resource() == arena.resource);
+      CHECK(strings.front().get_allocator().resource() == arena.resource);
+
+      memory_hash_map_t<memory_string_t, int> map;
+      map.emplace("abc", 1);
+      CHECK(map.get_allocator().resource() == arena.resource);
+      CHECK(map.find(string_view_t{"abc"}) != map.end());
+      CHECK(hash(memory_string_t{"abc"}) == hash(string_t{"abc"}));
+
+      {
+        memory_context_t pool(memory_resource_kind_t::POOL);
+        const auto copy = strings;
+        CHECK(copy.get_allocator().resource() == pool.resource);
+        CHECK(copy == strings);
+
+        // A HEAP context inside an ARENA is how results that outlive the arena are allocated.
+        memory_context_t heap;
+        memory_array_t<int> result;
+        CHECK(result.get_allocator().resource() == std::pmr::new_delete_resource());
+      }
+      CHECK(memory_context_t::get()->resource == arena.resource);
+
+      // Assigning across resources copies the elements into the memory of the target.
+      outside = memory_array_t<int>{4, 5};
+      CHECK(outside.get_allocator().resource() == std::pmr::new_delete_resource());
+    }
+    CHECK(memory_context_t::get()->kind == memory_resource_kind_t::HEAP);
+    CHECK(outside == memory_array_t<int>{4, 5});
+  }
+}
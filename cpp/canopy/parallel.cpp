@@ -0,0 +1,94 @@
+#include "parallel.hpp"
+
+namespace silva {
+  namespace {
+    // The task_group_t (if any) for which the current thread is working, and as which worker.
+    thread_local const task_group_t* current_task_group = nullptr;
+    thread_local index_t current_worker_index           = 0;
+  }
+
+  task_group_t::task_group_t(const index_t num_threads)
+  {
+    const index_t n = std::max<index_t>(num_threads, 1);
+    for (index_t i = 0; i < n; ++i) {
+      workers.push_back(std::make_unique<worker_t>());
+    }
+  }
+
+  void task_group_t::spawn(task_t task)
+  {
+    const index_t worker_index = (current_task_group == this) ? current_worker_index : 0;
+    worker_t& worker           = *workers[worker_index];
+    num_pending.fetch_add(1);
+    {
+      const std::lock_guard lock(worker.mutex);
+      worker.tasks.push_back(std::move(task));
+    }
+    num_queued.fetch_add(1);
+    // Taking the lock ensures that a thread that just found no task is already waiting.
+    const std::lock_guard lock(idle_mutex);
+    idle_cv.notify_one();
+  }
+
+  optional_t<task_group_t::task_t> task_group_t::pop_task(const index_t worker_index)
+  {
+    {
+      worker_t& worker = *workers[worker_index];
+      const std::lock_guard lock(worker.mutex);
+      if (!worker.tasks.empty()) {
+        task_t retval = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+        num_queued.fetch_sub(1);
+        return retval;
+      }
+    }
+    const index_t n = workers.size();
+    for (index_t i = 1; i < n; ++i) {
+      worker_t& victim = *workers[(worker_index + i) % n];
+      const std::lock_guard lock(victim.mutex);
+      if (!victim.tasks.empty()) {
+        task_t retval = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        num_queued.fetch_sub(1);
+        return retval;
+      }
+    }
+    return std::nullopt;
+  }
+
+  void task_group_t::work(const index_t worker_index)
+  {
+    const task_group_t* prev_task_group = current_task_group;
+    const index_t prev_worker_index     = current_worker_index;
+    current_task_group                  = this;
+    current_worker_index                = worker_index;
+    while (true) {
+      optional_t<task_t> task = pop_task(worker_index);
+      if (task.has_value()) {
+        (*task)();
+        task.reset();
+        if (num_pending.fetch_sub(1) == 1) {
+          const std::lock_guard lock(idle_mutex);
+          idle_cv.notify_all();
+        }
+        continue;
+      }
+      std::unique_lock lock(idle_mutex);
+      idle_cv.wait(lock, [this] { return num_pending.load() == 0 || num_queued.load() > 0; });
+      if (num_pending.load() == 0) {
+        break;
+      }
+    }
+    current_task_group   = prev_task_group;
+    current_worker_index = prev_worker_index;
+  }
+
+  void task_group_t::run()
+  {
+    array_t<std::jthread> helpers;
+    for (index_t i = 1; i < index_t(workers.size()); ++i) {
+      helpers.emplace_back([this, i] { work(i); });
+    }
+    work(0);
+  }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "array.hpp"
+#include "sprite.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace silva {
+  // Number of threads to use when the caller doesn't care.
+  index_t parallel_default_num_threads();
+
+  // Calls "func(i)" for all "i" in [0, count) on up to "num_threads" threads, one of which is the
+  // calling thread. Indexes are handed out one at a time, so unevenly sized work-items are
+  // balanced. Returns once all calls have finished. "func" must not throw.
+  template<typename Func>
+  void parallel_for(index_t count, index_t num_threads, Func&& func);
+
+  // Runs tasks on up to "num_threads" threads, one of which is the thread calling run(). Tasks may
+  // spawn further tasks. Each thread has its own deque of tasks: it runs the task it spawned most
+  // recently itself and, once its deque is empty, steals the oldest task of another thread. Threads
+  // without work sleep until a task is spawned or all tasks have finished. Tasks must not throw.
+  struct task_group_t : public menhir_t {
+    using task_t = function_t<void()>;
+
+    explicit task_group_t(index_t num_threads);
+
+    // May be called before run() or from inside one of the tasks.
+    void spawn(task_t);
+
+    // Returns once all tasks, including the ones spawned while running, have finished.
+    void run();
+
+   private:
+    struct worker_t {
+      std::mutex mutex;
+      std::deque<task_t> tasks;
+    };
+    array_t<unique_ptr_t<worker_t>> workers;
+
+    // Spawned tasks that haven't finished yet, and those among them that haven't started yet.
+    std::atomic<index_t> num_pending = 0;
+    std::atomic<index_t> num_queued  = 0;
+
+    // Idle threads wait on "idle_cv" for one of the two counters above to change.
+    std::mutex idle_mutex;
+    std::condition_variable idle_cv;
+
+    optional_t<task_t> pop_task(index_t worker_index);
+    void work(index_t worker_index);
+  };
+}
+
+// IMPLEMENTATION
+
+namespace silva {
+  inline index_t parallel_default_num_threads()
+  {
+    return std::max<index_t>(std::thread::hardware_concurrency(), 1);
+  }
+
+  template<typename Func>
+  void parallel_for(const index_t count, const index_t num_threads, Func&& func)
+  {
+    std::atomic<index_t> next_index = 0;
+    const auto worker               = [&] {
+      while (true) {
+        const index_t i = next_index.fetch_add(1, std::memory_order_relaxed);
+        if (i >= count) {
+          break;
+        }
+        func(i);
+      }
+    };
+    const index_t num_helpers = std::min(num_threads, count) - 1;
+    array_t<std::jthread> helpers;
+    for (index_t t = 0; t < num_helpers; ++t) {
+      helpers.emplace_back(worker);
+    }
+    worker();
+  }
+}
@@ -0,0 +1,74 @@
+#include "parallel.hpp"
+
+#include "env_context.hpp"
+
+#include <catch2/catch_all.hpp>
+
+namespace silva::test {
+  TEST_CASE("parallel-for", "[parallel_for]")
+  {
+    CHECK(parallel_default_num_threads() >= 1);
+    for (const index_t num_threads: {1, 2, 8}) {
+      array_t<std::atomic<index_t>> calls(100);
+      parallel_for(calls.size(), num_threads, [&](const index_t i) { calls[i] += 1; });
+      for (const auto& c: calls) {
+        CHECK(c == 1);
+      }
+    }
+    parallel_for(0, 4, [](index_t) { FAIL(); });
+  }
+
+  TEST_CASE("task-group", "[task_group_t]")
+  {
+    for (const index_t num_threads: {1, 4}) {
+      task_group_t task_group(num_threads);
+      std::atomic<index_t> num_leaves = 0;
+      function_t<void(index_t)> spawn_tree;
+      spawn_tree = [&](const index_t depth) {
+        if (depth == 0) {
+          num_leaves += 1;
+          return;
+        }
+        for (index_t i = 0; i < 3; ++i) {
+          task_group.spawn([&, depth] { spawn_tree(depth - 1); });
+        }
+      };
+      task_group.spawn([&] { spawn_tree(6); });
+      task_group.run();
+      CHECK(num_leaves == 729);
+    }
+  }
+
+  TEST_CASE("task-group-contexts", "[task_group_t][context_t]")
+  {
+    env_context_t env_context;
+    env_context.variables["VAR"_sov] = "outer"_sov;
+    const context_capture_t<env_context_t> env_capture;
+
+    // Helper threads start with their own default env_context_t, so the tasks only see "VAR" after
+    // adopting the captured context. Catch2's assertions aren't thread-safe, hence the counters.
+    constexpr index_t num_tasks = 64;
+    task_group_t task_group(4);
+    std::atomic<index_t> num_outer = 0;
+    std::atomic<index_t> num_inner = 0;
+    for (index_t i = 0; i < num_tasks; ++i) {
+      task_group.spawn([&] {
+        const context_adopt_t<env_context_t> env_adopt(env_capture);
+        {
+          env_context_t inner;
+          inner.variables["VAR"_sov] = "inner"_sov;
+          if (env_context_get("VAR") == "inner") {
+            num_inner += 1;
+          }
+        }
+        if (env_context_get("VAR") == "outer") {
+          num_outer += 1;
+        }
+      });
+    }
+    task_group.run();
+    CHECK(num_outer == num_tasks);
+    CHECK(num_inner == num_tasks);
+    CHECK(env_context_get("VAR") == "outer");
+  }
+}
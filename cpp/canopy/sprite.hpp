@@ -63,9 +63,9 @@ namespace silva {
     ptr_t() = default;
     ~ptr_t();
 
-    ptr_t(ptr_t&&);
+    ptr_t(ptr_t&&) noexcept;
     ptr_t(const ptr_t&);
-    ptr_t& operator=(ptr_t&&);
+    ptr_t& operator=(ptr_t&&) noexcept;
     ptr_t& operator=(const ptr_t&);
 
     // clang-format off
@@ -142,7 +142,7 @@ namespace silva {
   }
 
   template<typename T>
-  ptr_t<T>::ptr_t(ptr_t&& other)
+  ptr_t<T>::ptr_t(ptr_t&& other) noexcept
   {
     assign(std::move(other));
   }
@@ -154,7 +154,7 @@ namespace silva {
   }
 
   template<typename T>
-  ptr_t<T>& ptr_t<T>::operator=(ptr_t&& other)
+  ptr_t<T>& ptr_t<T>::operator=(ptr_t&& other) noexcept
   {
     assign(std::move(other));
     return *this;
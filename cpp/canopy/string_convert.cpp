@@ -1,5 +1,11 @@
 #include "string_convert.hpp"
 
+#include "array.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <limits>
+
 namespace silva {
   void string_append_escaped(string_t& obuf, const string_view_t unescaped_string)
   {
@@ -129,4 +135,153 @@ namespace silva {
       return string_or_view_t(string_unescaped(escaped_string));
     }
   }
+
+  namespace {
+    struct number_parts_t {
+      bool negative = false;
+      int base      = 10;
+      string_view_t digits;
+    };
+
+    // Splits off the sign and the base prefix.
+    number_parts_t number_parts(string_view_t s)
+    {
+      number_parts_t retval;
+      if (!s.empty() && (s.front() == '-' || s.front() == '+')) {
+        retval.negative = (s.front() == '-');
+        s.remove_prefix(1);
+      }
+      if (s.size() >= 2 && s[0] == '0') {
+        switch (s[1]) {
+          case 'b':
+            retval.base = 2;
+            break;
+          case 'o':
+            retval.base = 8;
+            break;
+          case 'x':
+            retval.base = 16;
+            break;
+          default:
+            break;
+        }
+        if (retval.base != 10) {
+          s.remove_prefix(2);
+        }
+      }
+      retval.digits = s;
+      return retval;
+    }
+
+    int digit_value(const char c)
+    {
+      if (c >= '0' && c <= '9') {
+        return c - '0';
+      }
+      else if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 10;
+      }
+      else if (c >= 'A' && c <= 'Z') {
+        return c - 'A' + 10;
+      }
+      return std::numeric_limits<int>::max();
+    }
+
+    // Magnitude of an integer without sign and prefix. Decimal integers must start with a digit,
+    // the others may start with a "'".
+    optional_t<uint64_t> parse_unsigned(const number_parts_t& np)
+    {
+      const string_view_t digits = np.digits;
+      if (digits.empty() || (np.base == 10 && digits.front() == '\'')) {
+        return std::nullopt;
+      }
+      uint64_t retval = 0;
+      if (digits.find('\'') == string_view_t::npos) {
+        const auto [ptr, ec] =
+            std::from_chars(digits.data(), digits.data() + digits.size(), retval, np.base);
+        if (ec != std::errc{} || ptr != digits.data() + digits.size()) {
+          return std::nullopt;
+        }
+        return retval;
+      }
+      bool has_digit = false;
+      for (const char c: digits) {
+        if (c == '\'') {
+          continue;
+        }
+        const int d = digit_value(c);
+        if (d >= np.base || retval > (std::numeric_limits<uint64_t>::max() - d) / np.base) {
+          return std::nullopt;
+        }
+        retval    = retval * np.base + d;
+        has_digit = true;
+      }
+      if (!has_digit) {
+        return std::nullopt;
+      }
+      return retval;
+    }
+  }
+
+  expected_t<index_t> convert_to_index(const string_view_t value)
+  {
+    const number_parts_t np        = number_parts(value);
+    const optional_t<uint64_t> mag = parse_unsigned(np);
+    SILVA_EXPECT(mag.has_value(), MINOR, "could not convert string '{}' to index_t", value);
+    constexpr uint64_t max_pos = std::numeric_limits<index_t>::max();
+    SILVA_EXPECT(*mag <= max_pos + (np.negative ? 1 : 0),
+                 MINOR,
+                 "could not convert string '{}' to index_t, out of range",
+                 value);
+    return np.negative ? index_t(-int64_t(*mag)) : index_t(*mag);
+  }
+
+  expected_t<double> convert_to_double(const string_view_t value)
+  {
+    const number_parts_t np = number_parts(value);
+    const double sign       = np.negative ? -1.0 : 1.0;
+    if (np.base != 10) {
+      const optional_t<uint64_t> mag = parse_unsigned(np);
+      SILVA_EXPECT(mag.has_value(), MINOR, "could not convert string '{}' to double", value);
+      return sign * double(*mag);
+    }
+    string_view_t digits = np.digits;
+    if (digits == "inf") {
+      return sign * std::numeric_limits<double>::infinity();
+    }
+    else if (digits == "nan") {
+      return std::copysign(std::numeric_limits<double>::quiet_NaN(), sign);
+    }
+    SILVA_EXPECT(!digits.empty() && digit_value(digits.front()) < 10,
+                 MINOR,
+                 "could not convert string '{}' to double",
+                 value);
+
+    // The grouping characters are removed into a buffer on the stack. Only absurdly long numbers
+    // have to go to the heap.
+    array_fixed_t<char, 128> buffer;
+    string_t long_buffer;
+    if (digits.find('\'') != string_view_t::npos) {
+      char* out = buffer.data();
+      if (digits.size() > buffer.size()) {
+        long_buffer.resize(digits.size());
+        out = long_buffer.data();
+      }
+      const char* begin = out;
+      for (const char c: digits) {
+        if (c != '\'') {
+          *out++ = c;
+        }
+      }
+      digits = string_view_t{begin, size_t(out - begin)};
+    }
+
+    double retval        = 0.0;
+    const auto [ptr, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), retval);
+    SILVA_EXPECT(ec == std::errc{} && ptr == digits.data() + digits.size(),
+                 MINOR,
+                 "could not convert string '{}' to double",
+                 value);
+    return sign * retval;
+  }
 }
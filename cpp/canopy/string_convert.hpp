@@ -20,6 +20,17 @@ namespace silva {
   string_or_view_t string_or_view_escaped(string_view_t unescaped_string);
   string_or_view_t string_or_view_unescaped(string_view_t escaped_string);
 
+  // Accept the number forms of Silva grammars: an optional sign, then "0b", "0o" or "0x" integers
+  // or decimal integers, all with optional "'" grouping. "convert_to_double" additionally accepts
+  // decimal fractions and exponents as well as lower-case "inf" and "nan". Unlike std::stod, a
+  // fraction needs a digit before the "." and "INF" or "infinity" are rejected. Neither throws,
+  // and only "convert_to_double" of a grouped number longer than 128 characters allocates.
+  //
+  // Errors:
+  //  - MINOR: Not a number or out of range.
+  expected_t<index_t> convert_to_index(string_view_t);
+  expected_t<double> convert_to_double(string_view_t);
+
   template<typename T>
   expected_t<T> convert_to(string_view_t);
 }
@@ -42,20 +53,10 @@ namespace silva {
       }
     }
     else if constexpr (std::same_as<index_t, T>) {
-      try {
-        return std::stoll(string_t{value});
-      }
-      catch (...) {
-        SILVA_EXPECT(false, MINOR, "could not convert string '{}' to index_t", value);
-      }
+      return convert_to_index(value);
     }
     else if constexpr (std::same_as<double, T>) {
-      try {
-        return std::stod(string_t{value});
-      }
-      catch (...) {
-        SILVA_EXPECT(false, MINOR, "could not convert string '{}' to double", value);
-      }
+      return convert_to_double(value);
     }
     else if constexpr (std::is_enum_v<T>) {
       const auto& hm = enum_hashmap_from_string<T>();
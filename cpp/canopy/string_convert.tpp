@@ -1,6 +1,10 @@
 #include "string_convert.hpp"
 
+#include "canopy/time.hpp"
+
 #include <catch2/catch_all.hpp>
+#include <cmath>
+#include <limits>
 
 namespace silva::test {
   TEST_CASE("string-conversion")
@@ -21,4 +25,96 @@ namespace silva::test {
     CHECK(convert_to<foo_t>("ABC") == foo_t::ABC);
     CHECK(convert_to<foo_t>("XYZ") == foo_t::XYZ);
   }
+
+  TEST_CASE("number-conversion")
+  {
+    CHECK(SILVA_REQUIRE(convert_to<index_t>("0")) == 0);
+    CHECK(SILVA_REQUIRE(convert_to<index_t>("42")) == 42);
+    CHECK(SILVA_REQUIRE(convert_to<index_t>("-42")) == -42);
+    CHECK(SILVA_REQUIRE(convert_to<index_t>("+42")) == 42);
+    CHECK(SILVA_REQUIRE(convert_to<index_t>("1'000'000")) == 1'000'000);
+    CHECK(SILVA_REQUIRE(convert_to<index_t>("0b1010")) == 10);
+    CHECK(SILVA_REQUIRE(convert_to<index_t>("-0b1'0000")) == -16);
+    CHECK(SILVA_REQUIRE(convert_to<index_t>("0o777")) == 511);
+    CHECK(SILVA_REQUIRE(convert_to<index_t>("0xFF")) == 255);
+    CHECK(SILVA_REQUIRE(convert_to<index_t>("0x7ead'BEEF'")) == 0x7EAD'BEEF);
+    CHECK(SILVA_REQUIRE(convert_to<index_t>("0x'7FFF'FFFF")) == 2147483647);
+    CHECK(SILVA_REQUIRE(convert_to<index_t>("-2147483648")) == -2147483647 - 1);
+    CHECK(!convert_to<index_t>("2147483648").has_value());
+    CHECK(!convert_to<index_t>("0x1'0000'0000").has_value());
+    CHECK(!convert_to<index_t>("99999999999999999999999").has_value());
+    CHECK(!convert_to<index_t>("").has_value());
+    CHECK(!convert_to<index_t>("-").has_value());
+    CHECK(!convert_to<index_t>("0x").has_value());
+    CHECK(!convert_to<index_t>("0b'").has_value());
+    CHECK(!convert_to<index_t>("0b102").has_value());
+    CHECK(!convert_to<index_t>("0o8").has_value());
+    CHECK(!convert_to<index_t>("'1").has_value());
+    CHECK(!convert_to<index_t>("12abc").has_value());
+    CHECK(!convert_to<index_t>(" 12").has_value());
+    CHECK(!convert_to<index_t>("--12").has_value());
+
+    CHECK(SILVA_REQUIRE(convert_to<double>("0")) == 0.0);
+    CHECK(SILVA_REQUIRE(convert_to<double>("1.5")) == 1.5);
+    CHECK(SILVA_REQUIRE(convert_to<double>("-1.5e3")) == -1500.0);
+    CHECK(SILVA_REQUIRE(convert_to<double>("+2e-1")) == 0.2);
+    CHECK(SILVA_REQUIRE(convert_to<double>("1'000.25")) == 1000.25);
+    CHECK(SILVA_REQUIRE(convert_to<double>("0x10")) == 16.0);
+    CHECK(SILVA_REQUIRE(convert_to<double>("-0b11")) == -3.0);
+    CHECK(SILVA_REQUIRE(convert_to<double>("0.1")) == 0.1);
+    CHECK(SILVA_REQUIRE(convert_to<double>("inf")) == std::numeric_limits<double>::infinity());
+    CHECK(SILVA_REQUIRE(convert_to<double>("-inf")) == -std::numeric_limits<double>::infinity());
+    CHECK(std::isnan(SILVA_REQUIRE(convert_to<double>("nan"))));
+    const string_t long_number = "1" + string_t(200, '0') + "'0";
+    CHECK(SILVA_REQUIRE(convert_to<double>(long_number)) == 1e201);
+    CHECK(!convert_to<double>("").has_value());
+    CHECK(!convert_to<double>(".5").has_value());
+    CHECK(!convert_to<double>("1.5x").has_value());
+    CHECK(!convert_to<double>("infinity").has_value());
+    CHECK(!convert_to<double>("1e999").has_value());
+  }
+
+  TEST_CASE("number-conversion-performance", "[.]")
+  {
+    constexpr index_t num_iterations = 10'000'000;
+    const auto run                   = [&](const string_view_t name,
+                                           const auto& inputs,
+                                           const auto& func) {
+      double sink      = 0;
+      const auto start = time_point_t::now();
+      for (index_t i = 0; i < num_iterations; ++i) {
+        sink += func(inputs[i % inputs.size()]);
+      }
+      const auto took = time_point_t::now() - start;
+      fmt::println("{:24}  {}  {:.1f} ns/conversion  ({})",
+                   name,
+                   took,
+                   double(took.nanos) / double(num_iterations),
+                   sink);
+    };
+    const array_t<string_view_t> integers = {"0", "7", "42", "-1234", "987654", "2147483647"};
+    const array_t<string_view_t> doubles  = {"0", "1.5", "-3.25", "6.02e23", "1e-9", "12345.678"};
+    run("convert_to<index_t>", integers, [](const string_view_t x) {
+      return *convert_to<index_t>(x);
+    });
+    run("std::stoll", integers, [](const string_view_t x) {
+      try {
+        return index_t(std::stoll(string_t{x}));
+      }
+      catch (...) {
+        return index_t(0);
+      }
+    });
+    run("convert_to<double>", doubles, [](const string_view_t x) {
+      return *convert_to<double>(x);
+    });
+    run("std::stod", doubles, [](const string_view_t x) {
+      try {
+        return std::stod(string_t{x});
+      }
+      catch (...) {
+        return 0.0;
+      }
+    });
+  }
 }
@@ -58,7 +58,7 @@ namespace std {
   struct hash<silva::string_or_view_t> {
     std::size_t operator()(const silva::string_or_view_t& x) const
     {
-      return std::hash<std::string_view>{}(x.as_string_view());
+      return silva::hash(x.as_string_view());
     }
   };
 }
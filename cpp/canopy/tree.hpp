@@ -34,6 +34,7 @@ namespace silva {
     index_t num_children() const;
 
     auto& node_at(this auto&&, index_t);
+    index_t subtree_size_at(index_t) const;
     tree_span_t subspan_at(index_t) const;
 
     auto children_range(this auto&&);
@@ -114,7 +115,7 @@ namespace silva {
   template<typename Span, bool WithIdx>
   void tree_span_child_pts_iter_t<Span, WithIdx>::increment()
   {
-    pos += tree_span.node_at(pos).subtree_size;
+    pos += tree_span.subtree_size_at(pos);
     child_index += 1;
   }
 
@@ -150,6 +151,12 @@ namespace silva {
     return *(self.root + self.stride * i);
   }
 
+  template<typename NodeData>
+  index_t tree_span_t<NodeData>::subtree_size_at(const index_t i) const
+  {
+    return (*this).node_at(i).subtree_size;
+  }
+
   template<typename NodeData>
   tree_span_t<NodeData> tree_span_t<NodeData>::subspan_at(const index_t pos) const
   {
@@ -169,8 +176,8 @@ namespace silva {
       };
       iter_t end{
           .tree_span   = self,
-          .pos         = self.root->subtree_size,
-          .child_index = self.root->num_children,
+          .pos         = self.subtree_size(),
+          .child_index = self.num_children(),
       };
       return std::ranges::subrange<iter_t, iter_t>(begin, end);
     }
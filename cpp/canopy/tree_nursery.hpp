@@ -2,6 +2,8 @@
 
 #include "tree.hpp"
 
+#include <algorithm>
+
 namespace silva {
   struct tree_nursery_state_t {
     index_t tree_size = 0;
@@ -14,8 +16,19 @@ namespace silva {
 
     array_t<NodeType> tree;
 
+    // Number of nodes that have been removed from the front of "tree" via discard_prefix(). Node
+    // indexes, e.g., in "tree_nursery_state_t::tree_size", always refer to the full tree, i.e.,
+    // "tree[i - tree_offset]" is the node with index "i".
+    index_t tree_offset = 0;
+
     tree_nursery_t();
 
+    index_t tree_size() const;
+
+    // Drops all nodes before the given index from "tree", e.g., because they have already been
+    // handed out to a consumer. Stakes that still own one of these nodes won't write it on commit().
+    void discard_prefix(index_t new_tree_offset);
+
     StateType get_state(this const auto&);
     void set_state(this auto&, const StateType&);
 
@@ -66,12 +79,26 @@ namespace silva {
     static_assert(std::derived_from<Derived, tree_nursery_t>);
   }
 
+  template<typename NodeType, typename StateType, typename Derived>
+  index_t tree_nursery_t<NodeType, StateType, Derived>::tree_size() const
+  {
+    return tree_offset + index_t(tree.size());
+  }
+
+  template<typename NodeType, typename StateType, typename Derived>
+  void tree_nursery_t<NodeType, StateType, Derived>::discard_prefix(const index_t new_tree_offset)
+  {
+    SILVA_ASSERT(tree_offset <= new_tree_offset && new_tree_offset <= tree_size());
+    tree.erase(tree.begin(), tree.begin() + (new_tree_offset - tree_offset));
+    tree_offset = new_tree_offset;
+  }
+
   // state_t
 
   template<typename NodeType, typename StateType, typename Derived>
   StateType tree_nursery_t<NodeType, StateType, Derived>::get_state(this const auto& self)
   {
-    tree_nursery_state_t tns{.tree_size = index_t(self.tree.size())};
+    tree_nursery_state_t tns{.tree_size = self.tree_size()};
     StateType retval{tns};
 
     if constexpr (requires(Derived d) { d.on_get_state(retval); }) {
@@ -85,7 +112,8 @@ namespace silva {
   void tree_nursery_t<NodeType, StateType, Derived>::set_state(this auto& self,
                                                                const StateType& state)
   {
-    self.tree.resize(state.tree_size);
+    // Going back to before "tree_offset" only happens when the whole parse is abandoned.
+    self.tree.resize(std::max(state.tree_size - self.tree_offset, index_t(0)));
 
     if constexpr (requires(Derived d) { d.on_set_state(state); }) {
       self.on_set_state(state);
@@ -137,7 +165,7 @@ namespace silva {
   {
     SILVA_ASSERT(!owns_node);
     SILVA_ASSERT(proto_node.subtree_size == 0);
-    SILVA_ASSERT(nursery->tree.size() == orig_state.tree_size);
+    SILVA_ASSERT(nursery->tree_size() == orig_state.tree_size);
     owns_node               = true;
     proto_node.subtree_size = 1;
     nursery->tree.emplace_back();
@@ -173,7 +201,9 @@ namespace silva {
     }
 
     if (owns_node) {
-      nursery->tree[orig_state.tree_size] = proto_node;
+      if (orig_state.tree_size >= nursery->tree_offset) {
+        nursery->tree[orig_state.tree_size - nursery->tree_offset] = proto_node;
+      }
       proto_node.num_children             = 1;
 
       if constexpr (requires(Derived d) { d.on_stake_commit_owning_to_proto(proto_node); }) {
@@ -83,4 +83,35 @@ namespace silva::test {
       CHECK(result_str == expected.substr(1));
     }
   }
+
+  TEST_CASE("tree_nursery-discard_prefix")
+  {
+    test_tree_nursery_t nursery;
+    auto A{nursery.stake()};
+    A.create_node("A");
+    {
+      auto B{nursery.stake()};
+      B.create_node("B");
+      A.add_proto_node(B.commit());
+    }
+    nursery.discard_prefix(2);
+    CHECK(nursery.tree_offset == 2);
+    CHECK(nursery.tree.empty());
+    {
+      auto C{nursery.stake()};
+      C.create_node("C");
+      CHECK(C.orig_state.tree_size == 2);
+      A.add_proto_node(C.commit());
+    }
+    {
+      auto D{nursery.stake()};
+      D.create_node("D");
+    }
+    CHECK(nursery.tree_size() == 3);
+    REQUIRE(nursery.tree.size() == 1);
+    CHECK(nursery.tree.front().name == "C");
+    const test_tree_node_t root_node = A.commit();
+    CHECK(root_node.subtree_size == 3);
+    CHECK(nursery.tree.size() == 1);
+  }
 }
@@ -1,5 +1,11 @@
 #include "unicode.hpp"
 
+#include <cstring>
+
+#if defined(__x86_64__)
+#  include <immintrin.h>
+#endif
+
 namespace silva::unicode {
   void utf8_encode_one(string_t& output, const codepoint_t cp)
   {
@@ -52,7 +58,7 @@ namespace silva::unicode {
                 (buffer[1] & 0xC0) == 0x80;
       // clang-format on
       SILVA_EXPECT(cont_bytes_good, MINOR, "invalid leading bits in continuation bytes");
-      SILVA_EXPECT(retval >= 0x80, MINOR, "non-canonical encoding of two byte codepoing");
+      SILVA_EXPECT(retval >= 0x80, MINOR, "non-canonical encoding of two byte codepoint");
       len = 2;
     }
     else if ((lb & 0xF0) == 0xE0) {
@@ -62,65 +68,474 @@ namespace silva::unicode {
              | ((buffer[1] & 0x3F) << 6)
              | ((buffer[2] & 0x3F) << 0);
       const bool cont_bytes_good =
-                (buffer[1] & 0xC0) == 0x80 ||
+                (buffer[1] & 0xC0) == 0x80 &&
                 (buffer[2] & 0xC0) == 0x80;
       // clang-format on
       SILVA_EXPECT(cont_bytes_good, MINOR, "invalid leading bits in continuation bytes");
-      SILVA_EXPECT(retval >= 0x800, MINOR, "non-canonical encoding of two byte codepoing");
+      SILVA_EXPECT(retval >= 0x800, MINOR, "non-canonical encoding of three byte codepoint");
       len = 3;
     }
     else if ((lb & 0xF8) == 0xF0) {
       SILVA_EXPECT(buffer.size() >= 4, MINOR, "expected at least 4 bytes in buffer");
       // clang-format off
-      retval = ((buffer[0] & 0x0F) << 18)
+      retval = ((buffer[0] & 0x07) << 18)
              | ((buffer[1] & 0x3F) << 12)
              | ((buffer[2] & 0x3F) << 6)
              | ((buffer[3] & 0x3F) << 0);
       const bool cont_bytes_good =
-                (buffer[1] & 0xC0) == 0x80 ||
-                (buffer[2] & 0xC0) == 0x80 ||
+                (buffer[1] & 0xC0) == 0x80 &&
+                (buffer[2] & 0xC0) == 0x80 &&
                 (buffer[3] & 0xC0) == 0x80;
       // clang-format on
       SILVA_EXPECT(cont_bytes_good, MINOR, "invalid leading bits in continuation bytes");
-      SILVA_EXPECT(retval >= 0x10000, MINOR, "non-canonical encoding of two byte codepoing");
+      SILVA_EXPECT(retval >= 0x10000, MINOR, "non-canonical encoding of four byte codepoint");
       len = 4;
     }
+    else {
+      SILVA_EXPECT(false, MINOR, "invalid leading byte {:#04x}", uint8_t(lb));
+    }
     SILVA_EXPECT(retval <= 0x10FFFF, MINOR, "codepoint above 0x10FFFF");
     SILVA_EXPECT(((retval >> 11) != 0x1B), MINOR, "surrogate half");
     return {{retval, len}};
   }
 
+  namespace {
+    // Same checks as utf8_decode_one(), but without building an error. Returns the length of the
+    // sequence at "p", or zero if it is invalid.
+    index_t utf8_decode_one_fast(const uint8_t* p, const index_t avail, codepoint_t& cp)
+    {
+      const uint8_t lb = p[0];
+      if (lb < 0x80) {
+        cp = lb;
+        return 1;
+      }
+      else if ((lb & 0xE0) == 0xC0) {
+        if (avail < 2 || (p[1] & 0xC0) != 0x80) {
+          return 0;
+        }
+        cp = ((lb & 0x1F) << 6) | (p[1] & 0x3F);
+        return cp >= 0x80 ? 2 : 0;
+      }
+      else if ((lb & 0xF0) == 0xE0) {
+        if (avail < 3 || ((p[1] & 0xC0) != 0x80) || ((p[2] & 0xC0) != 0x80)) {
+          return 0;
+        }
+        cp = ((lb & 0x0F) << 12) | ((p[1] & 0x3F) << 6) | (p[2] & 0x3F);
+        return (cp >= 0x800 && (cp >> 11) != 0x1B) ? 3 : 0;
+      }
+      else if ((lb & 0xF8) == 0xF0) {
+        if (avail < 4 || ((p[1] & 0xC0) != 0x80) || ((p[2] & 0xC0) != 0x80) ||
+            ((p[3] & 0xC0) != 0x80)) {
+          return 0;
+        }
+        cp = ((lb & 0x07) << 18) | ((p[1] & 0x3F) << 12) | ((p[2] & 0x3F) << 6) | (p[3] & 0x3F);
+        return (cp >= 0x10000 && cp <= 0x10FFFF) ? 4 : 0;
+      }
+      return 0;
+    }
+
+    // The ASCII kernels work on "size" bytes at "src". They return the length of the ASCII prefix
+    // and, if "dst" is given, write it to "dst" as codepoints.
+
+    index_t ascii_kernel_scalar(const char* src, const index_t size, codepoint_t* dst)
+    {
+      index_t i = 0;
+      if (dst == nullptr) {
+        for (; i + 8 <= size; i += 8) {
+          uint64_t word;
+          std::memcpy(&word, src + i, 8);
+          if ((word & 0x8080808080808080ull) != 0) {
+            break;
+          }
+        }
+      }
+      for (; i < size; ++i) {
+        const uint8_t b = src[i];
+        if (b >= 0x80) {
+          break;
+        }
+        if (dst != nullptr) {
+          dst[i] = b;
+        }
+      }
+      return i;
+    }
+
+#if defined(__x86_64__)
+    index_t ascii_kernel_sse2(const char* src, const index_t size, codepoint_t* dst)
+    {
+      const __m128i zero = _mm_setzero_si128();
+      index_t i          = 0;
+      for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i*)(src + i));
+        if (_mm_movemask_epi8(chunk) != 0) {
+          break;
+        }
+        if (dst != nullptr) {
+          const __m128i lo = _mm_unpacklo_epi8(chunk, zero);
+          const __m128i hi = _mm_unpackhi_epi8(chunk, zero);
+          _mm_storeu_si128((__m128i*)(dst + i + 0), _mm_unpacklo_epi16(lo, zero));
+          _mm_storeu_si128((__m128i*)(dst + i + 4), _mm_unpackhi_epi16(lo, zero));
+          _mm_storeu_si128((__m128i*)(dst + i + 8), _mm_unpacklo_epi16(hi, zero));
+          _mm_storeu_si128((__m128i*)(dst + i + 12), _mm_unpackhi_epi16(hi, zero));
+        }
+      }
+      return i + ascii_kernel_scalar(src + i, size - i, dst == nullptr ? nullptr : dst + i);
+    }
+
+    __attribute__((target("avx2"))) index_t
+    ascii_kernel_avx2(const char* src, const index_t size, codepoint_t* dst)
+    {
+      index_t i = 0;
+      for (; i + 32 <= size; i += 32) {
+        const __m256i chunk = _mm256_loadu_si256((const __m256i*)(src + i));
+        if (_mm256_movemask_epi8(chunk) != 0) {
+          break;
+        }
+        if (dst != nullptr) {
+          for (index_t j = 0; j < 32; j += 8) {
+            const __m128i bytes = _mm_loadl_epi64((const __m128i*)(src + i + j));
+            _mm256_storeu_si256((__m256i*)(dst + i + j), _mm256_cvtepu8_epi32(bytes));
+          }
+        }
+      }
+      return i + ascii_kernel_scalar(src + i, size - i, dst == nullptr ? nullptr : dst + i);
+    }
+
+    // Validates 32 bytes at a time by looking up the high and low nibble of each byte and the high
+    // nibble of the byte after it in three tables. Their entries are sets of the errors that a pair
+    // of bytes with such a nibble may have, and a pair is invalid if all three sets have an error
+    // in common (Keiser and Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte").
+    namespace avx2 {
+      // Errors of a pair of bytes.
+      constexpr uint8_t too_short      = 1 << 0; // 11______ 0_______ or 11______ 11______
+      constexpr uint8_t too_long       = 1 << 1; // 0_______ 10______
+      constexpr uint8_t overlong_3     = 1 << 2; // 11100000 100_____
+      constexpr uint8_t too_large      = 1 << 3; // 11110100 1001____ or larger
+      constexpr uint8_t surrogate      = 1 << 4; // 11101101 101_____
+      constexpr uint8_t overlong_2     = 1 << 5; // 1100000_ 10______
+      constexpr uint8_t overlong_4     = 1 << 6; // 11110000 1000____
+      constexpr uint8_t too_large_1000 = 1 << 6; // 11110101 1000____ or larger
+      constexpr uint8_t two_conts      = 1 << 7; // 10______ 10______
+
+      // Errors that don't depend on the low nibble of the first byte.
+      constexpr uint8_t carry = too_short | too_long | two_conts;
+
+      // Indexed by the high nibble of the first byte.
+      constexpr array_fixed_t<uint8_t, 16> byte_1_high_table{
+          too_long,
+          too_long,
+          too_long,
+          too_long,
+          too_long,
+          too_long,
+          too_long,
+          too_long,
+          two_conts,
+          two_conts,
+          two_conts,
+          two_conts,
+          too_short | overlong_2,
+          too_short,
+          too_short | overlong_3 | surrogate,
+          too_short | too_large | too_large_1000 | overlong_4,
+      };
+
+      // Indexed by the low nibble of the first byte.
+      constexpr array_fixed_t<uint8_t, 16> byte_1_low_table{
+          carry | overlong_3 | overlong_2 | overlong_4,
+          carry | overlong_2,
+          carry,
+          carry,
+          carry | too_large,
+          carry | too_large | too_large_1000,
+          carry | too_large | too_large_1000,
+          carry | too_large | too_large_1000,
+          carry | too_large | too_large_1000,
+          carry | too_large | too_large_1000,
+          carry | too_large | too_large_1000,
+          carry | too_large | too_large_1000,
+          carry | too_large | too_large_1000,
+          carry | too_large | too_large_1000 | surrogate,
+          carry | too_large | too_large_1000,
+          carry | too_large | too_large_1000,
+      };
+
+      // Indexed by the high nibble of the second byte.
+      constexpr array_fixed_t<uint8_t, 16> byte_2_high_table{
+          too_short,
+          too_short,
+          too_short,
+          too_short,
+          too_short,
+          too_short,
+          too_short,
+          too_short,
+          too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+          too_long | overlong_2 | two_conts | overlong_3 | too_large,
+          too_long | overlong_2 | two_conts | surrogate | too_large,
+          too_long | overlong_2 | two_conts | surrogate | too_large,
+          too_short,
+          too_short,
+          too_short,
+          too_short,
+      };
+
+      __attribute__((target("avx2"))) __m256i lookup(const __m256i nibbles,
+                                                      const array_fixed_t<uint8_t, 16>& table)
+      {
+        const __m128i half = _mm_loadu_si128((const __m128i*)table.data());
+        return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(half), nibbles);
+      }
+
+      __attribute__((target("avx2"))) __m256i high_nibbles(const __m256i x)
+      {
+        return _mm256_and_si256(_mm256_srli_epi16(x, 4), _mm256_set1_epi8(0x0F));
+      }
+
+      // The bytes of "input" moved up by "N" positions, with the last "N" bytes of "prev" in front.
+      template<int N>
+      __attribute__((target("avx2"))) __m256i shifted(const __m256i input, const __m256i prev)
+      {
+        return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev, input, 0x21), 16 - N);
+      }
+
+      struct validator_t {
+        __m256i prev;
+        __m256i incomplete;
+
+        // Returns false if a sequence ending in "input" is invalid.
+        __attribute__((target("avx2"))) bool check(const __m256i input)
+        {
+          // A sequence that is incomplete at the end of "prev" is only an error if "input" is all
+          // ASCII, otherwise its missing continuation bytes are found below.
+          __m256i error = incomplete;
+          if (_mm256_movemask_epi8(input) == 0) {
+            incomplete = _mm256_setzero_si256();
+          }
+          else {
+            const __m256i prev1       = shifted<1>(input, prev);
+            const __m256i byte_1_high = lookup(high_nibbles(prev1), byte_1_high_table);
+            const __m256i byte_1_low =
+                lookup(_mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)), byte_1_low_table);
+            const __m256i byte_2_high = lookup(high_nibbles(input), byte_2_high_table);
+            const __m256i pair_error =
+                _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+            // Two and three bytes after a leading byte of a longer sequence must be continuation
+            // bytes, for which the pair check already reported "two_conts".
+            const __m256i third =
+                _mm256_subs_epu8(shifted<2>(input, prev), _mm256_set1_epi8(0xE0 - 0x80));
+            const __m256i fourth =
+                _mm256_subs_epu8(shifted<3>(input, prev), _mm256_set1_epi8(0xF0 - 0x80));
+            const __m256i must_continue =
+                _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(0x80));
+            error = _mm256_xor_si256(must_continue, pair_error);
+
+            // Leading bytes too close to the end of the block for their sequence to fit.
+            const __m256i max_bytes = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1,
+                                                       -1, -1, -1, -1, -1, -1, -1, -1,
+                                                       -1, -1, -1, -1, -1, -1, -1, -1,
+                                                       -1, -1, -1, -1, -1, 0xF0 - 1, 0xE0 - 1,
+                                                       0xC0 - 1);
+            incomplete = _mm256_subs_epu8(input, max_bytes);
+          }
+          prev = input;
+          return _mm256_testz_si256(error, error) != 0;
+        }
+      };
+    }
+
+    // Returns the length of a prefix of the "size" bytes at "src" that is valid UTF-8. It ends at
+    // the start of the first block of 32 bytes that has an invalid or incomplete sequence, or at
+    // the start of the sequence that crosses into that block.
+    __attribute__((target("avx2"))) index_t validate_kernel_avx2(const char* src,
+                                                                 const index_t size)
+    {
+      avx2::validator_t validator{
+          .prev       = _mm256_setzero_si256(),
+          .incomplete = _mm256_setzero_si256(),
+      };
+      index_t i = 0;
+      for (; i + 32 <= size; i += 32) {
+        if (!validator.check(_mm256_loadu_si256((const __m256i*)(src + i)))) {
+          break;
+        }
+      }
+      if (i + 32 > size) {
+        // The rest is padded with zeros, which also reveals a sequence that is cut off at the end.
+        array_fixed_t<char, 32> tail{};
+        std::memcpy(tail.data(), src + i, size - i);
+        if (validator.check(_mm256_loadu_si256((const __m256i*)tail.data()))) {
+          return size;
+        }
+      }
+      index_t start = i;
+      while (start > 0 && (uint8_t(src[start - 1]) & 0xC0) == 0x80) {
+        --start;
+      }
+      if (start > 0 && uint8_t(src[start - 1]) >= 0xC0) {
+        const uint8_t lb  = src[start - 1];
+        const index_t len = lb >= 0xF0 ? 4 : (lb >= 0xE0 ? 3 : 2);
+        if (start - 1 + len > i) {
+          return start - 1;
+        }
+      }
+      return i;
+    }
+#endif
+
+    index_t validate_kernel_none(const char*, const index_t)
+    {
+      return 0;
+    }
+
+    using validate_kernel_t = index_t (*)(const char*, index_t);
+
+    validate_kernel_t validate_kernel_select()
+    {
+#if defined(__x86_64__)
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2")) {
+        return &validate_kernel_avx2;
+      }
+#endif
+      return &validate_kernel_none;
+    }
+
+    const validate_kernel_t& validate_kernel()
+    {
+      static const validate_kernel_t retval = validate_kernel_select();
+      return retval;
+    }
+
+    using ascii_kernel_t = index_t (*)(const char*, index_t, codepoint_t*);
+
+    ascii_kernel_t ascii_kernel_select()
+    {
+#if defined(__x86_64__)
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2")) {
+        return &ascii_kernel_avx2;
+      }
+      return &ascii_kernel_sse2;
+#else
+      return &ascii_kernel_scalar;
+#endif
+    }
+
+    const ascii_kernel_t& ascii_kernel()
+    {
+      static const ascii_kernel_t retval = ascii_kernel_select();
+      return retval;
+    }
+  }
+
+  index_t ascii_prefix_length(const string_view_t s)
+  {
+    return ascii_kernel()(s.data(), s.size(), nullptr);
+  }
+
+  expected_t<utf8_decode_batch_t> utf8_decode_batch(const string_view_t input,
+                                                    index_t byte_offset,
+                                                    const span_t<codepoint_t> output)
+  {
+    const ascii_kernel_t kernel = ascii_kernel();
+    const auto* bytes           = (const uint8_t*)input.data();
+    const index_t n             = input.size();
+    const index_t n_out         = output.size();
+    index_t count               = 0;
+    while (byte_offset < n && count < n_out) {
+      if (bytes[byte_offset] < 0x80) {
+        // Single ASCII characters between non-ASCII ones, as in most non-English text, are not
+        // worth a call to the SIMD kernel.
+        if (byte_offset + 1 == n || bytes[byte_offset + 1] >= 0x80) {
+          output[count++] = bytes[byte_offset++];
+          continue;
+        }
+        const index_t max_len = std::min(n - byte_offset, n_out - count);
+        const index_t len     = kernel(input.data() + byte_offset, max_len, &output[count]);
+        byte_offset += len;
+        count += len;
+        continue;
+      }
+      codepoint_t cp    = codepoint_none;
+      const index_t len = utf8_decode_one_fast(bytes + byte_offset, n - byte_offset, cp);
+      if (len == 0) {
+        if (count > 0) {
+          break;
+        }
+        SILVA_EXPECT_FWD(utf8_decode_one(input.substr(byte_offset)),
+                         "unable to decode codepoint at {}",
+                         byte_offset);
+        SILVA_EXPECT(false, ASSERT, "utf8_decode_one() accepted invalid sequence");
+      }
+      output[count++] = cp;
+      byte_offset += len;
+    }
+    return utf8_decode_batch_t{
+        .byte_offset = byte_offset,
+        .size        = count,
+    };
+  }
+
+  expected_t<void> utf8_validate(const string_view_t s)
+  {
+    const validate_kernel_t validate = validate_kernel();
+    const ascii_kernel_t kernel      = ascii_kernel();
+    const auto* bytes                = (const uint8_t*)s.data();
+    const index_t n                  = s.size();
+    index_t pos                      = 0;
+    while (pos < n) {
+      pos += validate(s.data() + pos, n - pos);
+
+      // Where the SIMD kernel stopped (or everywhere, if there is none), the bytes are decoded one
+      // sequence at a time, until past the block in which the kernel found a problem. This finds
+      // the exact position of the invalid sequence for the error.
+      const index_t scalar_end = std::min(n, pos + 64);
+      while (pos < scalar_end) {
+        if (pos + 1 < n && bytes[pos] < 0x80 && bytes[pos + 1] < 0x80) {
+          pos += kernel(s.data() + pos, n - pos, nullptr);
+          continue;
+        }
+        if (bytes[pos] < 0x80) {
+          pos += 1;
+          continue;
+        }
+        codepoint_t cp    = codepoint_none;
+        const index_t len = utf8_decode_one_fast(bytes + pos, n - pos, cp);
+        if (len == 0) {
+          SILVA_EXPECT_FWD(utf8_decode_one(s.substr(pos)), "unable to decode codepoint at {}", pos);
+          SILVA_EXPECT(false, ASSERT, "utf8_decode_one() accepted invalid sequence");
+        }
+        pos += len;
+      }
+    }
+    return {};
+  }
+
   std::generator<expected_t<codepoint_data_t>> utf8_decode_generator(const string_view_t s)
   {
+    array_fixed_t<codepoint_t, impl::utf8_batch_size> buffer;
     index_t pos = 0;
     while (pos < s.size()) {
-      // TODO: Replace this code with macro once GCC bug fixed
-
-      expected_t<tuple_t<codepoint_t, index_t>> result = utf8_decode_one(s.substr(pos));
+      // TODO: Use SILVA_EXPECT_FWD_PLAIN once GCC bug with statement-expressions in coroutines is
+      // fixed.
+      expected_t<utf8_decode_batch_t> result = utf8_decode_batch(s, pos, buffer);
       if (!result.has_value()) {
-        co_yield std::unexpected(silva::impl::silva_expect_fwd(__FILE__,
-                                                               __LINE__,
-                                                               std::move(result).error(),
-                                                               "utf8_decode_one(s.substr(pos))",
-                                                               "unable to decode codepoint at {}",
-                                                               pos));
+        co_yield std::unexpected(std::move(result).error());
         co_return;
       }
-      const auto [codepoint, len] = *std::move(result);
-
-      // const auto [codepoint, len] = SILVA_EXPECT_FWD_IMPL(co_yield,
-      //                                                     co_return,
-      //                                                     utf8_decode_one(s.substr(pos)),
-      //                                                     "unable to decode codepoint at {}",
-      //                                                     pos);
-
-      const codepoint_data_t cd{
-          .codepoint   = codepoint,
-          .byte_offset = pos,
-          .len         = len,
-      };
-      co_yield cd;
-      pos += len;
+      for (index_t i = 0; i < result->size; ++i) {
+        const index_t len = utf8_encoded_length(buffer[i]);
+        const codepoint_data_t cd{
+            .codepoint   = buffer[i],
+            .byte_offset = pos,
+            .len         = len,
+        };
+        co_yield cd;
+        pos += len;
+      }
     }
   }
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "array.hpp"
 #include "expected.hpp"
 #include "string.hpp"
 #include "two_stage_table.hpp"
@@ -16,6 +17,37 @@ namespace silva::unicode {
 
   expected_t<tuple_t<codepoint_t, index_t>> utf8_decode_one(string_view_t);
 
+  // Number of bytes in the UTF-8 encoding of "cp".
+  constexpr index_t utf8_encoded_length(codepoint_t cp);
+
+  // Length of the prefix of the argument that only consists of ASCII characters.
+  index_t ascii_prefix_length(string_view_t);
+
+  struct utf8_decode_batch_t {
+    // Where decoding stopped in the input.
+    index_t byte_offset = 0;
+    // Number of codepoints written to the output.
+    index_t size = 0;
+  };
+
+  // Decodes "input", starting at "byte_offset", into "output" until the end of one of them or the
+  // first invalid byte sequence is reached. Runs of ASCII characters are checked and widened with
+  // SIMD instructions (AVX2 or SSE2, picked at runtime, with a scalar fallback on other
+  // platforms). Only if the invalid sequence is right at "byte_offset" is it reported as error, so
+  // that the caller gets to see all codepoints in front of it.
+  //
+  // Errors:
+  //  - MINOR: Invalid UTF-8 at "byte_offset".
+  expected_t<utf8_decode_batch_t>
+  utf8_decode_batch(string_view_t input, index_t byte_offset, span_t<codepoint_t> output);
+
+  // Checks blocks of 32 bytes at once with AVX2, also where they aren't ASCII. Only around an
+  // invalid sequence, or without AVX2, are the bytes decoded one sequence at a time.
+  //
+  // Errors:
+  //  - MINOR: Invalid UTF-8.
+  expected_t<void> utf8_validate(string_view_t);
+
   struct codepoint_data_t {
     codepoint_t codepoint = codepoint_none;
     index_t byte_offset   = 0;
@@ -42,13 +74,43 @@ namespace silva::unicode {
 // IMPLEMENTATION
 
 namespace silva::unicode {
+  constexpr index_t utf8_encoded_length(const codepoint_t cp)
+  {
+    if (cp < 0x80) {
+      return 1;
+    }
+    else if (cp < 0x800) {
+      return 2;
+    }
+    else if (cp < 0x10000) {
+      return 3;
+    }
+    else {
+      return 4;
+    }
+  }
+
+  namespace impl {
+    constexpr index_t utf8_batch_size = 256;
+  }
+
   template<typename F>
   expected_t<void> utf8_decode_for_each(const string_view_t s, F f)
   {
     static_assert(std::invocable<F, codepoint_data_t>);
-    for (auto x: utf8_decode_generator(s)) {
-      const codepoint_data_t cd = SILVA_EXPECT_FWD_PLAIN(std::move(x));
-      SILVA_EXPECT_FWD_PLAIN(f(cd));
+    array_fixed_t<codepoint_t, impl::utf8_batch_size> buffer;
+    index_t pos = 0;
+    while (pos < s.size()) {
+      const utf8_decode_batch_t batch = SILVA_EXPECT_FWD_PLAIN(utf8_decode_batch(s, pos, buffer));
+      for (index_t i = 0; i < batch.size; ++i) {
+        const index_t len = utf8_encoded_length(buffer[i]);
+        SILVA_EXPECT_FWD_PLAIN(f(codepoint_data_t{
+            .codepoint   = buffer[i],
+            .byte_offset = pos,
+            .len         = len,
+        }));
+        pos += len;
+      }
     }
     return {};
   }
@@ -57,11 +119,16 @@ namespace silva::unicode {
   expected_t<bool> all_of(string_view_t s, Pred pred)
   {
     static_assert(std::invocable<Pred, codepoint_t>);
-    for (auto x: utf8_decode_generator(s)) {
-      const codepoint_data_t cd = SILVA_EXPECT_FWD_PLAIN(std::move(x));
-      if (!pred(cd.codepoint)) {
-        return false;
+    array_fixed_t<codepoint_t, impl::utf8_batch_size> buffer;
+    index_t pos = 0;
+    while (pos < s.size()) {
+      const utf8_decode_batch_t batch = SILVA_EXPECT_FWD_PLAIN(utf8_decode_batch(s, pos, buffer));
+      for (index_t i = 0; i < batch.size; ++i) {
+        if (!pred(buffer[i])) {
+          return false;
+        }
       }
+      pos = batch.byte_offset;
     }
     return true;
   }
@@ -70,13 +137,17 @@ namespace silva::unicode {
   expected_t<bool> any_of(string_view_t s, Pred pred)
   {
     static_assert(std::invocable<Pred, codepoint_t>);
-    for (auto x: utf8_decode_generator(s)) {
-      const codepoint_data_t cd = SILVA_EXPECT_FWD_PLAIN(std::move(x));
-      if (pred(cd.codepoint)) {
-        return true;
+    array_fixed_t<codepoint_t, impl::utf8_batch_size> buffer;
+    index_t pos = 0;
+    while (pos < s.size()) {
+      const utf8_decode_batch_t batch = SILVA_EXPECT_FWD_PLAIN(utf8_decode_batch(s, pos, buffer));
+      for (index_t i = 0; i < batch.size; ++i) {
+        if (pred(buffer[i])) {
+          return true;
+        }
       }
+      pos = batch.byte_offset;
     }
     return false;
   }
-
 }
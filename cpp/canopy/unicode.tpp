@@ -1,8 +1,11 @@
 #include "canopy/string.hpp"
+#include "canopy/time.hpp"
 #include "unicode.hpp"
 
 #include <catch2/catch_all.hpp>
 
+#include <random>
+
 namespace silva::unicode::test {
   using namespace Catch::Matchers;
 
@@ -96,5 +99,219 @@ namespace silva::unicode::test {
       CHECK_THAT(err_str, ContainsSubstring("surrogate half"));
       CHECK_THAT(err_str, ContainsSubstring("unable to decode codepoint at 1"));
     }
+    SECTION("error_3")
+    {
+      for (const string_view_t s: {string_view_t{"ab\xC3"},
+                                   string_view_t{"ab\xE2\x82"},
+                                   string_view_t{"ab\xE2\x28\xAC"},
+                                   string_view_t{"ab\xF0\x90\x28\xB7"},
+                                   string_view_t{"ab\xC1\xBF"},
+                                   string_view_t{"ab\xE0\x80\x80"},
+                                   string_view_t{"ab\x80"},
+                                   string_view_t{"ab\xFF"}}) {
+        INFO(hexdump(s));
+        expected_t<void> res = utf8_decode_for_each(s, null_f);
+        REQUIRE(!res.has_value());
+        const auto err_str = res.error().to_string_plain().as_string();
+        CHECK_THAT(err_str, ContainsSubstring("unable to decode codepoint at 2"));
+        CHECK(!utf8_validate(s).has_value());
+        CHECK(!utf8_decode_one(s.substr(2)).has_value());
+      }
+    }
+  }
+
+  TEST_CASE("unicode-batch", "[codepoint_t]")
+  {
+    // Long enough to go through the SIMD paths a few times, with non-ASCII characters at all
+    // positions relative to the SIMD blocks.
+    string_t s;
+    array_t<codepoint_t> expected;
+    for (index_t i = 0; i < 300; ++i) {
+      for (index_t j = 0; j < i % 41; ++j) {
+        const codepoint_t cp = U'a' + (i + j) % 26;
+        utf8_encode_one(s, cp);
+        expected.push_back(cp);
+      }
+      const codepoint_t cp = array_fixed_t<codepoint_t, 4>{0xDF, 0x20AC, 0x10437, 0x7F}[i % 4];
+      utf8_encode_one(s, cp);
+      expected.push_back(cp);
+    }
+
+    SECTION("decode")
+    {
+      for (const index_t output_size: {1, 3, 16, 33, 256, 100000}) {
+        INFO(output_size);
+        array_t<codepoint_t> buffer(output_size);
+        array_t<codepoint_t> result;
+        index_t pos = 0;
+        while (pos < s.size()) {
+          const auto batch = SILVA_REQUIRE(utf8_decode_batch(s, pos, buffer));
+          REQUIRE(batch.size > 0);
+          REQUIRE(batch.byte_offset > pos);
+          result.insert(result.end(), buffer.begin(), buffer.begin() + batch.size);
+          pos = batch.byte_offset;
+        }
+        CHECK(pos == index_t(s.size()));
+        CHECK(result == expected);
+      }
+      SILVA_REQUIRE(utf8_validate(s));
+      CHECK(SILVA_REQUIRE(all_of(s, [](const codepoint_t cp) { return cp != 0; })));
+      CHECK(SILVA_REQUIRE(any_of(s, [](const codepoint_t cp) { return cp == 0x10437; })));
+    }
+
+    SECTION("stops-before-error")
+    {
+      s += "\xFF";
+      array_t<codepoint_t> buffer(s.size());
+      const auto batch = SILVA_REQUIRE(utf8_decode_batch(s, 0, buffer));
+      CHECK(batch.byte_offset == index_t(s.size()) - 1);
+      CHECK(batch.size == index_t(expected.size()));
+      CHECK(!utf8_decode_batch(s, batch.byte_offset, buffer).has_value());
+      CHECK(!utf8_validate(s).has_value());
+
+      // Decided before the invalid byte is reached.
+      CHECK(!SILVA_REQUIRE(all_of(s, [](const codepoint_t cp) { return cp < 0x80; })));
+      CHECK(SILVA_REQUIRE(any_of(s, [](const codepoint_t cp) { return cp >= 0x80; })));
+      CHECK(!all_of(s, [](codepoint_t) { return true; }).has_value());
+    }
+
+    SECTION("ascii_prefix_length")
+    {
+      const string_t ascii(1000, 'x');
+      for (index_t len = 0; len < 100; ++len) {
+        string_t t = ascii.substr(0, len) + "\xC3\x9F" + ascii;
+        CHECK(ascii_prefix_length(t) == len);
+      }
+      CHECK(ascii_prefix_length(ascii) == index_t(ascii.size()));
+      CHECK(ascii_prefix_length("") == 0);
+    }
+  }
+
+  TEST_CASE("unicode-validate", "[codepoint_t]")
+  {
+    // Valid and invalid sequences of all kinds, with some bytes overwritten at random, in inputs
+    // long enough for the SIMD validation to see sequences across its blocks. utf8_validate() must
+    // report the first invalid sequence that utf8_decode_one() finds.
+    const array_t<string_view_t> valid_pieces{
+        "a",
+        " ",
+        "\xC3\xA9",
+        "\xE2\x82\xAC",
+        "\xED\x9F\xBF",
+        "\xEE\x80\x80",
+        "\xF0\x90\x90\xB7",
+        "\xF4\x8F\xBF\xBF",
+    };
+    const array_t<string_view_t> invalid_pieces{
+        "\x80",
+        "\xC0\x80",
+        "\xC2",
+        "\xE0\x80\x80",
+        "\xE0\xA0",
+        "\xED\xA0\x80",
+        "\xF0\x80\x80\x80",
+        "\xF4\x90\x80\x80",
+        "\xF5\x80\x80\x80",
+        "\xFF",
+    };
+    std::mt19937 rng(42);
+    index_t num_invalid = 0;
+    for (index_t round = 0; round < 20000; ++round) {
+      const index_t len = rng() % 300;
+      string_t s;
+      while (index_t(s.size()) < len) {
+        if (round % 2 == 0 || rng() % 8 != 0) {
+          s += valid_pieces[rng() % valid_pieces.size()];
+        }
+        else {
+          s += invalid_pieces[rng() % invalid_pieces.size()];
+        }
+      }
+      if (round % 8 == 1 && !s.empty()) {
+        s[rng() % s.size()] = char(rng());
+      }
+
+      optional_t<index_t> error_pos;
+      for (index_t pos = 0; pos < index_t(s.size());) {
+        const auto result = utf8_decode_one(string_view_t{s}.substr(pos));
+        if (!result.has_value()) {
+          error_pos = pos;
+          break;
+        }
+        const auto [cp, len] = *result;
+        pos += len;
+      }
+
+      INFO(hexdump(s));
+      const expected_t<void> result = utf8_validate(s);
+      REQUIRE(result.has_value() == !error_pos.has_value());
+      if (error_pos.has_value()) {
+        CHECK_THAT(result.error().to_string_plain().as_string(),
+                   ContainsSubstring(fmt::format("unable to decode codepoint at {}", *error_pos)));
+        num_invalid += 1;
+      }
+    }
+    CHECK(num_invalid > 1000);
+  }
+
+  TEST_CASE("unicode-performance", "[codepoint_t][.]")
+  {
+    constexpr index_t total_bytes = 256 * 1024 * 1024;
+    const auto make_input         = [](const std::u32string_view pattern) {
+      string_t retval;
+      while (retval.size() < 1024 * 1024) {
+        for (const codepoint_t cp: pattern) {
+          utf8_encode_one(retval, cp);
+        }
+      }
+      return retval;
+    };
+    const array_t<tuple_t<string_view_t, string_t>> inputs = {
+        {"ascii", make_input(U"The quick brown fox jumps over the lazy dog.\n")},
+        {"mixed-latin", make_input(U"Größere Übungen kosten €12, señor — très cher.\n")},
+        {"cjk", make_input(U"東京都の天気は晴れです。明日も良い天気でしょう。\n")},
+    };
+    for (const auto& [name, input]: inputs) {
+      const index_t num_iterations = total_bytes / input.size();
+      const auto run               = [&](const string_view_t method, const auto& func) {
+        codepoint_t sink = 0;
+        const auto start = time_point_t::now();
+        for (index_t i = 0; i < num_iterations; ++i) {
+          sink ^= func(input);
+        }
+        const auto took = time_point_t::now() - start;
+        fmt::println("{:12} {:20}  {}  {:.2f} GB/s  ({})",
+                     name,
+                     method,
+                     took,
+                     double(num_iterations * input.size()) / double(took.nanos),
+                     int(sink & 1));
+      };
+      SILVA_REQUIRE(utf8_validate(input));
+      run("utf8_validate", [](const string_view_t s) {
+        return codepoint_t(utf8_validate(s).has_value());
+      });
+      run("utf8_decode_batch", [](const string_view_t s) {
+        array_fixed_t<codepoint_t, 1024> buffer;
+        codepoint_t retval = 0;
+        index_t pos        = 0;
+        while (pos < s.size()) {
+          const auto batch = *utf8_decode_batch(s, pos, buffer);
+          retval ^= buffer[batch.size - 1];
+          pos = batch.byte_offset;
+        }
+        return retval;
+      });
+      run("utf8_decode_one", [](const string_view_t s) {
+        codepoint_t retval = 0;
+        index_t pos        = 0;
+        while (pos < s.size()) {
+          const auto [cp, len] = *utf8_decode_one(s.substr(pos));
+          retval ^= cp;
+          pos += len;
+        }
+        return retval;
+      });
+    }
   }
 }
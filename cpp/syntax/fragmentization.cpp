@@ -67,22 +67,25 @@ namespace silva {
   categorize_codepoints(const string_t& source_code)
   {
     array_t<categorized_codepoint_data_t> retval;
+    retval.reserve(source_code.size());
     file_location_t loc;
-    for (auto maybe_ud: unicode::utf8_decode_generator(source_code)) {
-      const unicode::codepoint_data_t ud = SILVA_EXPECT_FWD(std::move(maybe_ud));
-      const codepoint_category_t cc      = codepoint_category_table[ud.codepoint];
-      categorized_codepoint_data_t cc2{ud, cc, loc};
-      SILVA_EXPECT(cc != Forbidden, MINOR, "Forbidden {}", cc2.to_wrap());
-      retval.emplace_back(std::move(cc2));
-      if (ud.codepoint == U'\n') {
-        loc.line_num += 1;
-        loc.column = 0;
-      }
-      else {
-        loc.column += 1;
-      }
-      loc.byte_offset += ud.len;
-    }
+    SILVA_EXPECT_FWD_PLAIN(unicode::utf8_decode_for_each(
+        source_code,
+        [&](const unicode::codepoint_data_t& ud) -> expected_t<void> {
+          const codepoint_category_t cc = codepoint_category_table[ud.codepoint];
+          categorized_codepoint_data_t cc2{ud, cc, loc};
+          SILVA_EXPECT(cc != Forbidden, MINOR, "Forbidden {}", cc2.to_wrap());
+          retval.emplace_back(std::move(cc2));
+          if (ud.codepoint == U'\n') {
+            loc.line_num += 1;
+            loc.column = 0;
+          }
+          else {
+            loc.column += 1;
+          }
+          loc.byte_offset += ud.len;
+          return {};
+        }));
     SILVA_EXPECT(!retval.empty() && retval.back().codepoint == U'\n',
                  MINOR,
                  "source-code expected to end with newline");
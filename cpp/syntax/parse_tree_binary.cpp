@@ -0,0 +1,371 @@
+#include "parse_tree_binary.hpp"
+
+#include "canopy/byte_source.hpp"
+#include "canopy/filesystem.hpp"
+#include "canopy/flat_hash.hpp"
+
+#include <bit>
+#include <cstring>
+
+namespace silva {
+  namespace {
+    constexpr array_fixed_t<char, 8> binary_magic = {'s', 'i', 'l', 'v', 'a', '-', 'p', 't'};
+
+    // Fragments and nodes are stored with the layout of fragment_t and parse_tree_node_t, so that
+    // each of these sections is copied into the result at once. The padding of parse_tree_node_t
+    // is an explicit member that is written as zeros, so the output doesn't differ between runs.
+    struct binary_fragment_t {
+      index_t category    = 0;
+      index_t line_num    = 0;
+      index_t column      = 0;
+      index_t byte_offset = 0;
+    };
+
+    struct binary_node_t {
+      index_t num_children   = 0;
+      index_t subtree_size   = 0;
+      index_t rule_name      = 0;
+      index_t fragment_begin = 0;
+      index_t fragment_end   = 0;
+      uint8_t allow_token    = 0;
+      array_fixed_t<uint8_t, 3> padding{};
+    };
+
+    // The records have no padding bits of their own and the same bytes as the structs they are
+    // copied into.
+    static_assert(std::has_unique_object_representations_v<binary_fragment_t>);
+    static_assert(std::has_unique_object_representations_v<binary_node_t>);
+    static_assert(std::is_trivially_copyable_v<fragment_t>);
+    static_assert(std::is_trivially_copyable_v<parse_tree_node_t>);
+    static_assert(sizeof(binary_fragment_t) == sizeof(fragment_t) &&
+                  alignof(binary_fragment_t) == alignof(fragment_t));
+    static_assert(sizeof(binary_node_t) == sizeof(parse_tree_node_t) &&
+                  alignof(binary_node_t) == alignof(parse_tree_node_t));
+    static_assert([] {
+      const fragment_t fragment{
+          .category = fragment_category_t::DIGIT,
+          .location = {.line_num = 2, .column = 3, .byte_offset = 4},
+      };
+      const auto record = std::bit_cast<binary_fragment_t>(fragment);
+      return record.category == index_t(fragment_category_t::DIGIT) && record.line_num == 2 &&
+          record.column == 3 && record.byte_offset == 4;
+    }());
+    static_assert([] {
+      parse_tree_node_t node;
+      node.num_children   = 1;
+      node.subtree_size   = 2;
+      node.rule_name      = name_id_t{3};
+      node.fragment_begin = 4;
+      node.fragment_end   = 5;
+      node.allow_token    = true;
+      const auto record   = std::bit_cast<binary_node_t>(node);
+      return record.num_children == 1 && record.subtree_size == 2 && record.rule_name == 3 &&
+          record.fragment_begin == 4 && record.fragment_end == 5 && record.allow_token == 1;
+    }());
+
+    struct binary_header_t {
+      array_fixed_t<char, 8> magic = binary_magic;
+
+      uint32_t version         = parse_tree_binary_version;
+      uint32_t byte_order      = 0x01020304;
+      uint32_t node_size       = sizeof(binary_node_t);
+      uint32_t fragment_size   = sizeof(binary_fragment_t);
+      int64_t num_tokens       = 0;
+      int64_t num_token_bytes  = 0;
+      int64_t num_names        = 0;
+      int64_t filepath_size    = 0;
+      int64_t source_code_size = 0;
+      int64_t num_fragments    = 0;
+      int64_t num_nodes        = 0;
+    };
+
+    struct binary_name_t {
+      name_id_t name;
+      name_id_t parent_name;
+      index_t base_token = 0;
+    };
+
+    constexpr index_t binary_alignment = 8;
+
+    void append_section(string_t& out, const void* data, const size_t size)
+    {
+      if (size > 0) {
+        out.append(static_cast<const char*>(data), size);
+      }
+      out.resize((out.size() + binary_alignment - 1) / binary_alignment * binary_alignment, '\0');
+    }
+
+    template<typename T>
+    void append_section(string_t& out, const span_t<const T> xs)
+    {
+      append_section(out, xs.data(), xs.size_bytes());
+    }
+
+    // The sections are used where they are in "span", which must be aligned to "binary_alignment".
+    struct binary_reader_t {
+      span_t<const byte_t> span;
+
+      template<typename T>
+      expected_t<span_t<const T>> read_section(const int64_t count)
+      {
+        static_assert(std::is_trivially_copyable_v<T> && alignof(T) <= binary_alignment);
+        SILVA_EXPECT(0 <= count && count <= int64_t(span.size() / sizeof(T)),
+                     MINOR,
+                     "parse-tree file is truncated");
+        const size_t size   = count * sizeof(T);
+        const size_t padded = (size + binary_alignment - 1) / binary_alignment * binary_alignment;
+        const span_t<const T> retval(reinterpret_cast<const T*>(span.data()), count);
+        span = span.subspan(std::min(padded, span.size()));
+        return retval;
+      }
+    };
+
+    string_view_t as_string_view(const span_t<const char> chars)
+    {
+      return string_view_t(chars.data(), chars.size());
+    }
+
+    // Copies records that have the same layout as "T" into "out".
+    template<typename T, typename Record>
+    void copy_records(array_t<T>& out, const span_t<const Record> records)
+    {
+      static_assert(sizeof(T) == sizeof(Record));
+      out.resize(records.size());
+      if (!records.empty()) {
+        std::memcpy(out.data(), records.data(), records.size_bytes());
+      }
+    }
+  }
+
+  string_t parse_tree_binary_write(const parse_tree_t& pt)
+  {
+    SILVA_ASSERT(!pt.fp.is_nullptr());
+    const fragmentization_t& fz = *pt.fp;
+    const syntax_farm_t& sf     = *fz.sfp;
+
+    // The rule names of the nodes and all their ancestors, parents before their children.
+    array_t<binary_name_t> names;
+    flat_hash_set_t<name_id_t> names_seen;
+    array_t<token_id_t> tokens;
+    flat_hash_map_t<token_id_t, index_t> token_indexes;
+    array_t<name_id_t> chain;
+    for (const parse_tree_node_t& node: pt.nodes) {
+      chain.clear();
+      name_id_t name = node.rule_name;
+      while (name.is_valid() && !names_seen.contains(name)) {
+        chain.push_back(name);
+        name = sf.get(name).parent_name;
+      }
+      for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        const name_info_t& info = sf.get(*it);
+        const auto [token_it, inserted] =
+            token_indexes.try_emplace(info.base_name, index_t(tokens.size()));
+        if (inserted) {
+          tokens.push_back(info.base_name);
+        }
+        names_seen.emplace(*it);
+        names.push_back(binary_name_t{
+            .name        = *it,
+            .parent_name = info.parent_name,
+            .base_token  = token_it->second,
+        });
+      }
+    }
+
+    array_t<index_t> token_ends;
+    string_t token_bytes;
+    for (const token_id_t token: tokens) {
+      token_bytes += sf.get(token).str;
+      token_ends.push_back(token_bytes.size());
+    }
+    const string_t filepath = fz.filepath.string();
+
+    array_t<binary_fragment_t> fragments;
+    fragments.reserve(fz.fragments.size());
+    for (const fragment_t& fragment: fz.fragments) {
+      fragments.push_back(binary_fragment_t{
+          .category    = index_t(fragment.category),
+          .line_num    = fragment.location.line_num,
+          .column      = fragment.location.column,
+          .byte_offset = fragment.location.byte_offset,
+      });
+    }
+    array_t<binary_node_t> nodes;
+    nodes.reserve(pt.nodes.size());
+    for (const parse_tree_node_t& node: pt.nodes) {
+      nodes.push_back(binary_node_t{
+          .num_children   = node.num_children,
+          .subtree_size   = node.subtree_size,
+          .rule_name      = node.rule_name.val,
+          .fragment_begin = node.fragment_begin,
+          .fragment_end   = node.fragment_end,
+          .allow_token    = uint8_t(node.allow_token),
+      });
+    }
+
+    binary_header_t header;
+    header.num_tokens       = tokens.size();
+    header.num_token_bytes  = token_bytes.size();
+    header.num_names        = names.size();
+    header.filepath_size    = filepath.size();
+    header.source_code_size = fz.source_code.size();
+    header.num_fragments    = fz.fragments.size();
+    header.num_nodes        = pt.nodes.size();
+
+    string_t retval;
+    retval.reserve(sizeof(header) + token_ends.size() * sizeof(index_t) + token_bytes.size() +
+                   names.size() * sizeof(binary_name_t) + filepath.size() +
+                   fz.source_code.size() + fragments.size() * sizeof(binary_fragment_t) +
+                   nodes.size() * sizeof(binary_node_t) + 8 * binary_alignment);
+    append_section(retval, &header, sizeof(header));
+    append_section(retval, span_t<const index_t>{token_ends});
+    append_section(retval, token_bytes.data(), token_bytes.size());
+    append_section(retval, span_t<const binary_name_t>{names});
+    append_section(retval, filepath.data(), filepath.size());
+    append_section(retval, fz.source_code.data(), fz.source_code.size());
+    append_section(retval, span_t<const binary_fragment_t>{fragments});
+    append_section(retval, span_t<const binary_node_t>{nodes});
+    return retval;
+  }
+
+  expected_t<void> parse_tree_binary_save(const parse_tree_t& pt, const filepath_t& filepath)
+  {
+    SILVA_EXPECT_FWD(write_file(filepath, parse_tree_binary_write(pt)));
+    return {};
+  }
+
+  expected_t<parse_tree_ptr_t> parse_tree_binary_read(syntax_farm_ptr_t sfp,
+                                                      const span_t<const byte_t> bytes)
+  {
+    SILVA_EXPECT(reinterpret_cast<uintptr_t>(bytes.data()) % binary_alignment == 0,
+                 MINOR,
+                 "parse-tree data is not aligned to {} bytes",
+                 binary_alignment);
+    binary_reader_t reader{.span = bytes};
+    const auto header_span        = SILVA_EXPECT_FWD(reader.read_section<binary_header_t>(1));
+    const binary_header_t& header = header_span.front();
+    SILVA_EXPECT(header.magic == binary_magic, MINOR, "not a parse-tree file");
+    SILVA_EXPECT(header.byte_order == binary_header_t{}.byte_order,
+                 MINOR,
+                 "parse-tree file was written with a different byte order");
+    SILVA_EXPECT(header.version == parse_tree_binary_version,
+                 MINOR,
+                 "parse-tree file has version {}, expected version {}",
+                 header.version,
+                 parse_tree_binary_version);
+    SILVA_EXPECT(header.node_size == sizeof(binary_node_t) &&
+                     header.fragment_size == sizeof(binary_fragment_t),
+                 MINOR,
+                 "parse-tree file has records of unexpected size");
+
+    const auto token_ends = SILVA_EXPECT_FWD(reader.read_section<index_t>(header.num_tokens));
+    const string_view_t token_bytes =
+        as_string_view(SILVA_EXPECT_FWD(reader.read_section<char>(header.num_token_bytes)));
+    array_t<token_id_t> tokens;
+    tokens.reserve(token_ends.size());
+    index_t token_begin = 0;
+    for (const index_t token_end: token_ends) {
+      SILVA_EXPECT(token_begin <= token_end && token_end <= index_t(token_bytes.size()),
+                   MINOR,
+                   "parse-tree file has invalid tokens");
+      tokens.push_back(sfp->token_id(token_bytes.substr(token_begin, token_end - token_begin)));
+      token_begin = token_end;
+    }
+
+    // From the "name_id_t" at the time of writing to the one in "sfp".
+    const auto names = SILVA_EXPECT_FWD(reader.read_section<binary_name_t>(header.num_names));
+    flat_hash_map_t<name_id_t, name_id_t> name_map;
+    name_map.reserve(names.size());
+    for (const binary_name_t& name: names) {
+      const auto parent_it = name_map.find(name.parent_name);
+      SILVA_EXPECT(name.name.is_valid() && !name_map.contains(name.name) &&
+                       (!name.parent_name.is_valid() || parent_it != name_map.end()) &&
+                       0 <= name.base_token && name.base_token < index_t(tokens.size()),
+                   MINOR,
+                   "parse-tree file has invalid names");
+      const name_id_t parent_name = name.parent_name.is_valid() ? parent_it->second : name_id_t{};
+      name_map.try_emplace(name.name, sfp->name_id(parent_name, tokens[name.base_token]));
+    }
+
+    const string_view_t filepath =
+        as_string_view(SILVA_EXPECT_FWD(reader.read_section<char>(header.filepath_size)));
+    const string_view_t source_code =
+        as_string_view(SILVA_EXPECT_FWD(reader.read_section<char>(header.source_code_size)));
+    auto fz         = std::make_unique<fragmentization_t>();
+    fz->sfp         = sfp;
+    fz->filepath    = filepath;
+    fz->source_code = source_code;
+
+    const auto fragments =
+        SILVA_EXPECT_FWD(reader.read_section<binary_fragment_t>(header.num_fragments));
+    const index_t num_fragments = fragments.size();
+    index_t prev_byte_offset    = 0;
+    for (const binary_fragment_t& fragment: fragments) {
+      SILVA_EXPECT(index_t(fragment_category_t::INVALID) < fragment.category &&
+                       fragment.category <= index_t(fragment_category_t::WHITESPACE) &&
+                       prev_byte_offset <= fragment.byte_offset &&
+                       fragment.byte_offset <= index_t(source_code.size()),
+                   MINOR,
+                   "parse-tree file has invalid fragments");
+      prev_byte_offset = fragment.byte_offset;
+    }
+    copy_records(fz->fragments, fragments);
+
+    // The nodes are copied as they are, and their rule names are then translated in the same pass
+    // that checks them. The rule names must be among the names that were read, and the subtrees of
+    // the children of each node must exactly fill the subtree of the node.
+    const auto records =
+        SILVA_EXPECT_FWD(reader.read_section<binary_node_t>(header.num_nodes));
+    const index_t num_nodes = records.size();
+    array_t<parse_tree_node_t> nodes;
+    copy_records(nodes, records);
+    struct open_node_t {
+      index_t subtree_end   = 0;
+      index_t children_left = 0;
+    };
+    array_t<open_node_t> open_nodes;
+    for (index_t i = 0; i < num_nodes; ++i) {
+      const binary_node_t& node = records[i];
+      const auto rule_name_it   = name_map.find(name_id_t{node.rule_name});
+      const index_t outer_end   = open_nodes.empty() ? num_nodes : open_nodes.back().subtree_end;
+      SILVA_EXPECT(rule_name_it != name_map.end() && node.allow_token <= 1 &&
+                       0 <= node.fragment_begin && node.fragment_begin <= node.fragment_end &&
+                       node.fragment_end <= num_fragments && 1 <= node.subtree_size &&
+                       node.subtree_size <= outer_end - i && 0 <= node.num_children &&
+                       node.num_children < node.subtree_size &&
+                       (i == 0 ? node.subtree_size == num_nodes
+                               : open_nodes.back().children_left > 0),
+                   MINOR,
+                   "parse-tree file has invalid nodes");
+      if (i > 0) {
+        open_nodes.back().children_left -= 1;
+      }
+      open_nodes.push_back(open_node_t{
+          .subtree_end   = i + node.subtree_size,
+          .children_left = node.num_children,
+      });
+      while (!open_nodes.empty() && open_nodes.back().subtree_end == i + 1) {
+        SILVA_EXPECT(open_nodes.back().children_left == 0,
+                     MINOR,
+                     "parse-tree file has invalid nodes");
+        open_nodes.pop_back();
+      }
+      nodes[i].rule_name = rule_name_it->second;
+    }
+
+    const fragmentization_ptr_t fp = sfp->add(std::move(fz));
+    return sfp->add(std::make_unique<parse_tree_t>(parse_tree_t{
+        .fp    = fp,
+        .nodes = std::move(nodes),
+    }));
+  }
+
+  expected_t<parse_tree_ptr_t> parse_tree_binary_load(syntax_farm_ptr_t sfp,
+                                                      const filepath_t& filepath)
+  {
+    const auto source = SILVA_EXPECT_FWD(byte_source_mmap_t::open(filepath));
+    return SILVA_EXPECT_FWD(parse_tree_binary_read(std::move(sfp), source->span),
+                            "while loading parse-tree from '{}'",
+                            filepath.string());
+  }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "parse_tree.hpp"
+
+namespace silva {
+
+  // Binary format of a parse_tree_t together with its fragmentization_t and the tokens and names of
+  // the syntax_farm_t that its rule names refer to. Fragments and nodes are stored with the layout
+  // of fragment_t and parse_tree_node_t, with the padding of the latter written as zeros, so that
+  // the same parse-tree always results in the same bytes. The format is only meant to be read on
+  // machines with the same byte order; anything else is rejected by the header.
+  //
+  // Layout, each section padded to a multiple of 8 bytes:
+  //  - header (magic, version, sizes);
+  //  - end offsets of the tokens, followed by the bytes of all tokens;
+  //  - names, parents before their children, with their "name_id_t" at the time of writing;
+  //  - filepath and source code of the fragmentization;
+  //  - fragments;
+  //  - nodes.
+  constexpr inline uint32_t parse_tree_binary_version = 3;
+
+  string_t parse_tree_binary_write(const parse_tree_t&);
+
+  // Errors:
+  //  - MINOR: File could not be written.
+  expected_t<void> parse_tree_binary_save(const parse_tree_t&, const filepath_t&);
+
+  // Adds the fragmentization and the parse-tree to the given syntax_farm_t, translating the rule
+  // names of the nodes to the "name_id_t" they have in that syntax_farm_t. The records are checked
+  // where they are, in a single pass over each section, and each section is then copied at once.
+  // The bytes must be aligned to 8 bytes, as they are in a mapped file or a string_t.
+  //
+  // Errors:
+  //  - MINOR: Not aligned, not the output of parse_tree_binary_write() of this version, or
+  //    truncated.
+  //  - MINOR: Fragments out of order or outside of the source code, or nodes with unknown rule
+  //    names, with fragments outside of the fragmentization, or whose subtrees don't fit together.
+  expected_t<parse_tree_ptr_t> parse_tree_binary_read(syntax_farm_ptr_t, span_t<const byte_t>);
+
+  // Like parse_tree_binary_read(), with the file mapped into memory.
+  //
+  // Errors:
+  //  - MINOR: File could not be mapped.
+  //  - MINOR: See parse_tree_binary_read().
+  expected_t<parse_tree_ptr_t> parse_tree_binary_load(syntax_farm_ptr_t, const filepath_t&);
+}
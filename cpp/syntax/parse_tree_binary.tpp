@@ -0,0 +1,92 @@
+#include "parse_tree_binary.hpp"
+
+#include "seed.hpp"
+#include "syntax.hpp"
+
+#include "canopy/filesystem.hpp"
+
+#include <cstring>
+
+#include <catch2/catch_all.hpp>
+
+namespace silva::test {
+  TEST_CASE("parse-tree-binary", "[parse_tree_binary]")
+  {
+    syntax_farm_t sf;
+    const auto spr = standard_seed_interpreter(sf.ptr());
+    const auto fp  = SILVA_REQUIRE(fragmentize(sf.ptr(), "seed.seed", string_t{seed::seed_str}));
+    const auto ptp = SILVA_REQUIRE(spr->apply(fp, sf.name_id_of("Seed")));
+
+    const string_t expected = SILVA_REQUIRE(ptp->span().to_string());
+
+    temp_dir_t td;
+    const filepath_t path = td.get_dir_path() / "seed.pt";
+    SILVA_REQUIRE(parse_tree_binary_save(*ptp, path));
+
+    // Same syntax_farm_t, so the rule names stay the same.
+    const auto ptp_same = SILVA_REQUIRE(parse_tree_binary_load(sf.ptr(), path));
+    CHECK(ptp_same->nodes == ptp->nodes);
+    CHECK(ptp_same->fp->filepath == fp->filepath);
+    CHECK(ptp_same->fp->source_code == fp->source_code);
+    CHECK(ptp_same->fp->fragments == fp->fragments);
+    CHECK(SILVA_REQUIRE(ptp_same->span().to_string()) == expected);
+
+    // Different syntax_farm_t, in which the rule names have different ids.
+    syntax_farm_t sf_other;
+    sf_other.name_id_of("Unrelated", "Name");
+    const auto ptp_other = SILVA_REQUIRE(parse_tree_binary_load(sf_other.ptr(), path));
+    CHECK(ptp_other->nodes != ptp->nodes);
+    CHECK(SILVA_REQUIRE(ptp_other->span().to_string()) == expected);
+
+    const string_t bytes = parse_tree_binary_write(*ptp);
+    const auto read      = [&](const string_view_t sv) {
+      const span_t<const byte_t> span((const byte_t*)sv.data(), sv.size());
+      return parse_tree_binary_read(sf.ptr(), span);
+    };
+    CHECK(read(bytes).has_value());
+    CHECK(parse_tree_binary_write(*ptp_same) == bytes);
+    CHECK(!read(string_view_t{bytes}.substr(0, bytes.size() / 2)).has_value());
+    string_t bytes_bad_magic = bytes;
+    bytes_bad_magic[0]       = 'S';
+    CHECK(!read(bytes_bad_magic).has_value());
+    string_t bytes_bad_version = bytes;
+    bytes_bad_version[8] += 1;
+    CHECK(!read(bytes_bad_version).has_value());
+    CHECK(!parse_tree_binary_load(sf.ptr(), td.get_dir_path() / "missing.pt").has_value());
+
+    string_t bytes_misaligned = " " + bytes;
+    CHECK(!read(string_view_t{bytes_misaligned}.substr(1)).has_value());
+
+    // The nodes are the last section, right after the fragments. Both are records of index_t, a
+    // node starting with "num_children", "subtree_size", "rule_name", "fragment_begin", and
+    // "fragment_end", a fragment with "category" and ending with "byte_offset".
+    const index_t node_size     = 6 * sizeof(index_t);
+    const index_t fragment_size = 4 * sizeof(index_t);
+    const index_t nodes_offset  = bytes.size() - ptp->nodes.size() * node_size;
+    const index_t last_fragment = nodes_offset - fragment_size;
+    const auto corrupt          = [&](const index_t offset, const index_t value) {
+      string_t retval = bytes;
+      std::memcpy(retval.data() + offset, &value, sizeof(value));
+      return retval;
+    };
+    const auto corrupt_root = [&](const index_t field, const index_t value) {
+      return corrupt(nodes_offset + field * sizeof(index_t), value);
+    };
+
+    const parse_tree_node_t& root = ptp->nodes[0];
+    CHECK(read(corrupt_root(0, root.num_children)).has_value());
+    CHECK(!read(corrupt_root(0, root.num_children + 1)).has_value());
+    CHECK(!read(corrupt_root(1, root.subtree_size - 1)).has_value());
+    CHECK(!read(corrupt_root(2, 1'000'000'000)).has_value());
+    CHECK(!read(corrupt_root(2, 0)).has_value());
+    CHECK(!read(corrupt_root(3, -1)).has_value());
+    CHECK(!read(corrupt_root(3, root.fragment_end + 1)).has_value());
+    CHECK(!read(corrupt_root(4, fp->fragments.size() + 1)).has_value());
+    CHECK(read(corrupt(last_fragment, index_t(fp->fragments.back().category))).has_value());
+    CHECK(!read(corrupt(last_fragment, 0)).has_value());
+    CHECK(!read(corrupt(last_fragment, 1'000)).has_value());
+    CHECK(!read(corrupt(last_fragment + 3 * sizeof(index_t), fp->source_code.size() + 1))
+               .has_value());
+    CHECK(!read(corrupt(last_fragment + 3 * sizeof(index_t), -1)).has_value());
+  }
+}
@@ -0,0 +1,136 @@
+#include "parse_tree_compact.hpp"
+
+namespace silva {
+  void parse_tree_compact_column_t::push_back(const index_t value, const index_t base)
+  {
+    const int64_t delta = int64_t(value) - int64_t(base);
+    if (0 <= delta && delta < wide_marker) {
+      deltas.push_back(uint16_t(delta));
+    }
+    else {
+      wide.emplace(index_t(deltas.size()), value);
+      deltas.push_back(wide_marker);
+    }
+  }
+
+  index_t parse_tree_compact_column_t::byte_size() const
+  {
+    using value_type = decltype(wide)::value_type;
+    return deltas.size() * sizeof(uint16_t) + wide.capacity() * (sizeof(value_type) + 1);
+  }
+
+  index_t parse_tree_compact_t::byte_size() const
+  {
+    return rule_dict.size() * sizeof(name_id_t) + rule_codes.size() * sizeof(uint16_t) +
+        num_children.byte_size() + subtree_size.byte_size() +
+        fragment_bases.size() * sizeof(index_t) + fragment_begin.byte_size() +
+        fragment_end.byte_size();
+  }
+
+  parse_tree_node_t parse_tree_compact_t::node_at(const index_t index) const
+  {
+    const uint16_t rule_code = rule_codes[index];
+    parse_tree_node_t retval;
+    retval.num_children   = num_children.at(index, 0);
+    retval.subtree_size   = subtree_size.at(index, 0);
+    retval.rule_name      = rule_dict[rule_code & ~allow_token_bit];
+    retval.fragment_begin = fragment_begin.at(index, fragment_bases[index / block_size]);
+    retval.fragment_end   = fragment_end.at(index, retval.fragment_begin);
+    retval.allow_token    = (rule_code & allow_token_bit) != 0;
+    return retval;
+  }
+
+  expected_t<parse_tree_compact_t> parse_tree_compact_t::from(const parse_tree_t& pt)
+  {
+    parse_tree_compact_t retval;
+    retval.fp       = pt.fp;
+    const index_t n = pt.nodes.size();
+    retval.rule_codes.reserve(n);
+    retval.num_children.deltas.reserve(n);
+    retval.subtree_size.deltas.reserve(n);
+    retval.fragment_bases.reserve((n + block_size - 1) / block_size);
+    retval.fragment_begin.deltas.reserve(n);
+    retval.fragment_end.deltas.reserve(n);
+
+    flat_hash_map_t<name_id_t, uint16_t> rule_lookup;
+    for (index_t block_begin = 0; block_begin < n; block_begin += block_size) {
+      const index_t block_end = std::min(block_begin + block_size, n);
+      index_t base            = std::numeric_limits<index_t>::max();
+      for (index_t i = block_begin; i < block_end; ++i) {
+        base = std::min(base, pt.nodes[i].fragment_begin);
+      }
+      retval.fragment_bases.push_back(base);
+
+      for (index_t i = block_begin; i < block_end; ++i) {
+        const parse_tree_node_t& node = pt.nodes[i];
+        const auto [it, inserted] =
+            rule_lookup.try_emplace(node.rule_name, uint16_t(retval.rule_dict.size()));
+        if (inserted) {
+          SILVA_EXPECT(index_t(retval.rule_dict.size()) < max_rule_dict_size,
+                       MINOR,
+                       "parse-tree has more than {} distinct rule names",
+                       max_rule_dict_size);
+          retval.rule_dict.push_back(node.rule_name);
+        }
+        const uint16_t token_bit = node.allow_token ? allow_token_bit : 0;
+        retval.rule_codes.push_back(it->second | token_bit);
+        retval.num_children.push_back(node.num_children, 0);
+        retval.subtree_size.push_back(node.subtree_size, 0);
+        retval.fragment_begin.push_back(node.fragment_begin, base);
+        retval.fragment_end.push_back(node.fragment_end, node.fragment_begin);
+      }
+    }
+    return retval;
+  }
+
+  parse_tree_t parse_tree_compact_t::expand() const
+  {
+    array_t<parse_tree_node_t> nodes;
+    nodes.reserve(size());
+    for (index_t i = 0; i < size(); ++i) {
+      nodes.push_back(node_at(i));
+    }
+    return parse_tree_t{
+        .fp    = fp,
+        .nodes = std::move(nodes),
+    };
+  }
+
+  parse_tree_compact_span_t::parse_tree_compact_span_t(const index_t offset,
+                                                       parse_tree_compact_ptr_t ptcp)
+    : ptcp(std::move(ptcp)), offset(offset)
+  {
+  }
+
+  parse_tree_compact_span_t::parse_tree_compact_span_t(const parse_tree_compact_t& other)
+    : ptcp(other.ptr())
+  {
+  }
+
+  expected_t<token_id_t> parse_tree_compact_span_t::token() const
+  {
+    auto& sf = *ptcp->fp->sfp;
+    SILVA_EXPECT(allow_token(),
+                 MINOR,
+                 "token should only be obtain from twig-rules, not from {}",
+                 sf.name_id_wrap(rule_name(), token_id_default_name_sep));
+    return sf.token_id(fragment_span());
+  }
+
+  fragment_span_t parse_tree_compact_span_t::fragment_span() const
+  {
+    return fragment_span_t{
+        ptcp->fp,
+        fragment_begin(),
+        fragment_end(),
+    };
+  }
+
+  fragment_location_t parse_tree_compact_span_t::location() const
+  {
+    return fragment_location_t{
+        ptcp->fp,
+        fragment_begin(),
+    };
+  }
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "parse_tree.hpp"
+
+#include "canopy/flat_hash.hpp"
+
+namespace silva {
+
+  // A column of 16-bit values, each relative to a base that is given when the value is stored and
+  // when it is read. Values whose delta to the base doesn't fit are stored as absolute values in
+  // "wide" instead, keyed by their index.
+  struct parse_tree_compact_column_t {
+    array_t<uint16_t> deltas;
+    flat_hash_map_t<index_t, index_t> wide;
+
+    constexpr static uint16_t wide_marker = std::numeric_limits<uint16_t>::max();
+
+    void push_back(index_t value, index_t base);
+    index_t at(index_t, index_t base) const;
+
+    index_t byte_size() const;
+  };
+
+  // Read-only form of a finished parse_tree_t that takes 10 instead of 24 bytes per node:
+  //  - "rule_codes" index into "rule_dict", the per-tree dictionary of rule names, the top bit
+  //    holds "allow_token";
+  //  - "fragment_begin" is stored relative to the smallest one in each block of "block_size"
+  //    nodes, and "fragment_end" relative to the node's own "fragment_begin".
+  struct parse_tree_compact_t : public sprite_t {
+    fragmentization_ptr_t fp;
+
+    array_t<name_id_t> rule_dict;
+    array_t<uint16_t> rule_codes;
+
+    parse_tree_compact_column_t num_children;
+    parse_tree_compact_column_t subtree_size;
+
+    constexpr static index_t block_size = 64;
+    array_t<index_t> fragment_bases;
+    parse_tree_compact_column_t fragment_begin;
+    parse_tree_compact_column_t fragment_end;
+
+    constexpr static uint16_t allow_token_bit   = 0x8000;
+    constexpr static index_t max_rule_dict_size = allow_token_bit;
+
+    index_t size() const;
+    index_t byte_size() const;
+
+    parse_tree_node_t node_at(index_t) const;
+
+    // Errors:
+    //  - MINOR: The tree has more distinct rule names than fit into the dictionary.
+    static expected_t<parse_tree_compact_t> from(const parse_tree_t&);
+
+    parse_tree_t expand() const;
+
+    auto span(this auto&&);
+  };
+  using parse_tree_compact_ptr_t = ptr_t<const parse_tree_compact_t>;
+
+  // Offers the same accessors as parse_tree_span_t, so code that only uses those can be written
+  // once (as a template) for both forms of a parse-tree.
+  struct parse_tree_compact_span_t {
+    parse_tree_compact_ptr_t ptcp;
+    index_t offset = 0;
+
+    parse_tree_compact_span_t() = default;
+    parse_tree_compact_span_t(index_t offset, parse_tree_compact_ptr_t);
+    parse_tree_compact_span_t(const parse_tree_compact_t&);
+
+    index_t subtree_size() const;
+    index_t num_children() const;
+    name_id_t rule_name() const;
+    index_t fragment_begin() const;
+    index_t fragment_end() const;
+    bool allow_token() const;
+
+    // Decodes the whole node, unlike the accessors above, which only read their own column.
+    parse_tree_node_t node_at(index_t) const;
+    index_t subtree_size_at(index_t) const;
+    parse_tree_compact_span_t subspan_at(index_t) const;
+
+    auto children_range(this auto&&);
+    auto children_range_idx(this auto&&);
+
+    expected_t<token_id_t> token() const;
+    fragment_span_t fragment_span() const;
+    fragment_location_t location() const;
+
+    friend bool operator==(const parse_tree_compact_span_t&,
+                           const parse_tree_compact_span_t&) = default;
+  };
+}
+
+// IMPLEMENTATION
+
+namespace silva {
+  inline index_t parse_tree_compact_column_t::at(const index_t index, const index_t base) const
+  {
+    const uint16_t delta = deltas[index];
+    if (delta != wide_marker) [[likely]] {
+      return base + index_t(delta);
+    }
+    return wide.find(index)->second;
+  }
+
+  inline index_t parse_tree_compact_t::size() const
+  {
+    return rule_codes.size();
+  }
+
+  inline auto parse_tree_compact_t::span(this auto&& self)
+  {
+    return parse_tree_compact_span_t{self};
+  }
+
+  inline index_t parse_tree_compact_span_t::subtree_size() const
+  {
+    return ptcp->subtree_size.at(offset, 0);
+  }
+  inline index_t parse_tree_compact_span_t::num_children() const
+  {
+    return ptcp->num_children.at(offset, 0);
+  }
+  inline name_id_t parse_tree_compact_span_t::rule_name() const
+  {
+    return ptcp->rule_dict[ptcp->rule_codes[offset] & ~parse_tree_compact_t::allow_token_bit];
+  }
+  inline index_t parse_tree_compact_span_t::fragment_begin() const
+  {
+    const index_t base = ptcp->fragment_bases[offset / parse_tree_compact_t::block_size];
+    return ptcp->fragment_begin.at(offset, base);
+  }
+  inline index_t parse_tree_compact_span_t::fragment_end() const
+  {
+    return ptcp->fragment_end.at(offset, fragment_begin());
+  }
+  inline bool parse_tree_compact_span_t::allow_token() const
+  {
+    return (ptcp->rule_codes[offset] & parse_tree_compact_t::allow_token_bit) != 0;
+  }
+
+  inline parse_tree_node_t parse_tree_compact_span_t::node_at(const index_t pos) const
+  {
+    return ptcp->node_at(offset + pos);
+  }
+  inline index_t parse_tree_compact_span_t::subtree_size_at(const index_t pos) const
+  {
+    return ptcp->subtree_size.at(offset + pos, 0);
+  }
+  inline parse_tree_compact_span_t parse_tree_compact_span_t::subspan_at(const index_t pos) const
+  {
+    return parse_tree_compact_span_t{offset + pos, ptcp};
+  }
+
+  inline auto parse_tree_compact_span_t::children_range(this auto&& self)
+  {
+    return impl::children_range_pts<false, std::remove_cvref_t<decltype(self)>>(self);
+  }
+  inline auto parse_tree_compact_span_t::children_range_idx(this auto&& self)
+  {
+    return impl::children_range_pts<true, std::remove_cvref_t<decltype(self)>>(self);
+  }
+}
@@ -0,0 +1,158 @@
+#include "parse_tree_compact.hpp"
+
+#include "seed.hpp"
+#include "syntax.hpp"
+
+#include "canopy/time.hpp"
+
+#include <catch2/catch_all.hpp>
+
+namespace silva::test {
+  namespace {
+    void check_same_tree(const parse_tree_span_t& pts, const parse_tree_compact_span_t& ptcs)
+    {
+      REQUIRE(ptcs.subtree_size() == pts.subtree_size());
+      for (index_t i = 0; i < pts.subtree_size(); ++i) {
+        const auto lhs = pts.subspan_at(i);
+        const auto rhs = ptcs.subspan_at(i);
+        CHECK(rhs.node_at(0) == lhs.node_at(0));
+        CHECK(rhs.rule_name() == lhs.rule_name());
+        CHECK(rhs.fragment_begin() == lhs.fragment_begin());
+        CHECK(rhs.fragment_end() == lhs.fragment_end());
+        CHECK(rhs.allow_token() == lhs.allow_token());
+        CHECK(rhs.num_children() == lhs.num_children());
+
+        array_t<index_t> lhs_children;
+        for (const auto child: lhs.children_range()) {
+          lhs_children.push_back(index_t(child.root - lhs.root));
+        }
+        array_t<index_t> rhs_children;
+        for (const auto child: rhs.children_range()) {
+          rhs_children.push_back(child.offset - rhs.offset);
+        }
+        CHECK(rhs_children == lhs_children);
+      }
+    }
+
+    parse_tree_t make_flat_tree(const index_t num_leaves, const index_t num_rule_names)
+    {
+      parse_tree_t retval;
+      parse_tree_node_t root;
+      root.num_children   = num_leaves;
+      root.subtree_size   = num_leaves + 1;
+      root.rule_name      = name_id_t{1};
+      root.fragment_begin = 0;
+      root.fragment_end   = num_leaves * 1'000;
+      retval.nodes.push_back(root);
+      for (index_t i = 0; i < num_leaves; ++i) {
+        parse_tree_node_t leaf;
+        leaf.rule_name      = name_id_t{2 + i % num_rule_names};
+        leaf.fragment_begin = i * 1'000;
+        leaf.fragment_end   = leaf.fragment_begin + (i % 3 == 0 ? 100'000 : 1);
+        leaf.allow_token    = (i % 2 == 0);
+        retval.nodes.push_back(leaf);
+      }
+      return retval;
+    }
+  }
+
+  TEST_CASE("parse-tree-compact", "[parse_tree_compact_t]")
+  {
+    syntax_farm_t sf;
+    const auto spr = standard_seed_interpreter(sf.ptr());
+    const auto fp  = SILVA_REQUIRE(fragmentize(sf.ptr(), "seed.seed", string_t{seed::seed_str}));
+    const auto ptp = SILVA_REQUIRE(spr->apply(fp, sf.name_id_of("Seed")));
+    const auto ptc = SILVA_REQUIRE(parse_tree_compact_t::from(*ptp));
+    CHECK(ptc.size() == index_t(ptp->nodes.size()));
+    CHECK(ptc.byte_size() < index_t(ptp->nodes.size() * sizeof(parse_tree_node_t)) / 2);
+    CHECK(ptc.expand().nodes == ptp->nodes);
+    check_same_tree(ptp->span(), ptc.span());
+
+    for (index_t i = 0; i < ptc.size(); ++i) {
+      const auto pts  = ptp->span().subspan_at(i);
+      const auto ptcs = ptc.span().subspan_at(i);
+      if (pts.allow_token()) {
+        const token_id_t lhs = SILVA_REQUIRE(pts.token());
+        const token_id_t rhs = SILVA_REQUIRE(ptcs.token());
+        CHECK(rhs == lhs);
+      }
+      CHECK(ptcs.fragment_span().as_string_view() == pts.fragment_span().as_string_view());
+    }
+  }
+
+  TEST_CASE("parse-tree-compact-wide", "[parse_tree_compact_t]")
+  {
+    // Number of children, subtree size, and fragment ranges that don't fit into 16 bits.
+    parse_tree_t pt               = make_flat_tree(70'000, 7);
+    pt.nodes.front().fragment_end = std::numeric_limits<index_t>::max();
+    pt.nodes.back()               = parse_tree_node_t{};
+    const auto ptc                = SILVA_REQUIRE(parse_tree_compact_t::from(pt));
+    CHECK(ptc.rule_dict.size() == 9);
+    CHECK(!ptc.num_children.wide.empty());
+    CHECK(!ptc.fragment_end.wide.empty());
+    CHECK(ptc.expand().nodes == pt.nodes);
+    check_same_tree(pt.span(), ptc.span());
+
+    // Too many distinct rule names for the dictionary.
+    const parse_tree_t pt_many = make_flat_tree(70'000, 50'000);
+    CHECK(!parse_tree_compact_t::from(pt_many).has_value());
+  }
+
+  TEST_CASE("parse-tree-compact-performance", "[parse_tree_compact_t][.]")
+  {
+    // The children of the root of the Seed parse-tree, repeated until the tree is large.
+    syntax_farm_t sf;
+    const auto spr = standard_seed_interpreter(sf.ptr());
+    const auto fp  = SILVA_REQUIRE(fragmentize(sf.ptr(), "seed.seed", string_t{seed::seed_str}));
+    const auto ptp = SILVA_REQUIRE(spr->apply(fp, sf.name_id_of("Seed")));
+
+    constexpr index_t num_repetitions = 2'000;
+    parse_tree_t pt{.fp = fp};
+    pt.nodes.push_back(ptp->nodes.front());
+    for (index_t i = 0; i < num_repetitions; ++i) {
+      pt.nodes.insert(pt.nodes.end(), ptp->nodes.begin() + 1, ptp->nodes.end());
+    }
+    pt.nodes.front().num_children *= num_repetitions;
+    pt.nodes.front().subtree_size = pt.nodes.size();
+
+    const auto ptc = SILVA_REQUIRE(parse_tree_compact_t::from(pt));
+
+    const index_t bytes_nodes = pt.nodes.size() * sizeof(parse_tree_node_t);
+    fmt::println("{} nodes: parse_tree_t {} bytes, parse_tree_compact_t {} bytes ({:.1f} per node)",
+                 pt.nodes.size(),
+                 bytes_nodes,
+                 ptc.byte_size(),
+                 double(ptc.byte_size()) / double(ptc.size()));
+
+    // Sums up what the parse-tree consumers typically read, once by node index and once by
+    // walking the children.
+    const auto run = [](const string_view_t name, const auto& span) {
+      const auto start_linear = time_point_t::now();
+      int64_t sum_linear      = 0;
+      for (index_t i = 0; i < span.subtree_size(); ++i) {
+        const auto sub = span.subspan_at(i);
+        sum_linear += sub.rule_name().val + sub.fragment_end() - sub.fragment_begin();
+      }
+      const auto took_linear = time_point_t::now() - start_linear;
+
+      const auto start_children = time_point_t::now();
+      int64_t sum_children      = 0;
+      for (const auto child: span.children_range()) {
+        for (const auto grandchild: child.children_range()) {
+          sum_children += grandchild.rule_name().val + grandchild.num_children();
+        }
+      }
+      const auto took_children = time_point_t::now() - start_children;
+      fmt::println("{:24} linear {}  children {}  ({} {})",
+                   name,
+                   took_linear,
+                   took_children,
+                   sum_linear,
+                   sum_children);
+      return pair_t<int64_t, int64_t>{sum_linear, sum_children};
+    };
+    const auto result_nodes   = run("parse_tree_t", pt.span());
+    const auto result_compact = run("parse_tree_compact_t", ptc.span());
+    CHECK(result_compact == result_nodes);
+  }
+}
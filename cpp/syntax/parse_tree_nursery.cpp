@@ -15,6 +15,7 @@ namespace silva {
                  sfp->token_id_wrap(ft.token_id));
     SILVA_EXPECT(n > 0, ASSERT);
     for (index_t i = 0; i < n; ++i) {
+      look_at(fragment_index);
       auto maybe_curr_cp = fp->get_unique_codepoint(fragment_index);
       if (!maybe_curr_cp.has_value()) {
         maybe_curr_cp.error().clear();
@@ -50,7 +51,8 @@ namespace silva {
 
   void parse_tree_nursery_t::on_set_state(const parse_tree_nursery_state_t& s)
   {
-    fragment_index = s.fragment_index;
+    fragment_index      = s.fragment_index;
+    tree_size_low_water = std::min(tree_size_low_water, s.tree_size);
   }
 
   void parse_tree_nursery_t::on_stake_ctor(parse_tree_node_t& proto_node) const
@@ -98,17 +100,23 @@ namespace silva {
   }
 
   expected_t<parse_tree_ptr_t> parse_tree_nursery_t::finish() &&
+  {
+    auto pt = SILVA_EXPECT_FWD_PLAIN(std::move(*this).finish_owned());
+    return sfp->add(std::move(pt));
+  }
+
+  expected_t<unique_ptr_t<parse_tree_t>> parse_tree_nursery_t::finish_owned() &&
   {
     SILVA_EXPECT(fragment_index + 1 == fs.end, MINOR, "[{}] vs [{}]", fragment_index, fs.end);
-    auto pt = sfp->add(std::make_unique<parse_tree_t>(parse_tree_t{
+    SILVA_EXPECT(tree_offset == 0, ASSERT, "prefix of parse-tree was discarded");
+    return std::make_unique<parse_tree_t>(parse_tree_t{
         .fp    = fp,
         .nodes = std::move(tree),
-    }));
-    return pt;
+    });
   }
 
   parse_tree_nursery_t::parse_tree_nursery_t(fragment_span_t fs)
-    : sfp(fs.fp->sfp), fp(fs.fp), fs(fs)
+    : sfp(fs.fp->sfp), fp(fs.fp), fs(fs), fragment_limit(fs.fp->size())
   {
   }
 
@@ -116,15 +124,18 @@ namespace silva {
 
   index_t parse_tree_nursery_t::num_fragments_left() const
   {
-    return fp->size() - fragment_index;
+    look_at(fragment_index);
+    return fragment_limit - fragment_index;
   }
   const fragment_t* parse_tree_nursery_t::fragment_by(const index_t idx_offset) const
   {
+    look_at(fragment_index + idx_offset);
     return &(fp->fragments[fragment_index + idx_offset]);
   }
   unicode::codepoint_t
   parse_tree_nursery_t::fragment_unique_codepoint_or_zero_by(const index_t idx_offset) const
   {
+    look_at(fragment_index + idx_offset);
     auto res = fp->get_unique_codepoint(fragment_index + idx_offset);
     if (res.has_value()) {
       return *res;
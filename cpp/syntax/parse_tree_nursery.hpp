@@ -18,6 +18,7 @@ namespace silva {
 
 #define SILVA_EXPECT_PARSE_FRAGMENT_CODEPOINT(name, codepoint)                              \
   {                                                                                         \
+    look_at(fragment_index);                                                                \
     const auto cp = SILVA_EXPECT_PARSE_FWD(name, fp->get_unique_codepoint(fragment_index)); \
     SILVA_EXPECT_PARSE(name, cp == codepoint, "expected {}, got {}", codepoint, cp);        \
     fragment_index += 1;                                                                    \
@@ -46,6 +47,17 @@ namespace silva {
 
     index_t fragment_index = 0;
 
+    // Fragments from this index onwards are treated as if the fragmentization ended there.
+    index_t fragment_limit = 0;
+
+    // One past the furthest fragment that has been looked at. Never decreases on backtracking, as
+    // the fragments looked at by a failed attempt still influence the result.
+    mutable index_t fragment_lookahead_end = 0;
+
+    // The smallest tree_size() that backtracking went back to (see on_set_state()). Can be reset
+    // by the user, e.g., to find out whether some nodes are still in "tree".
+    index_t tree_size_low_water = 0;
+
     expected_t<parse_tree_node_t> parse_literal(const fragmented_token_t&);
 
     void on_get_state(parse_tree_nursery_state_t&) const;
@@ -61,6 +73,12 @@ namespace silva {
     expected_t<void> init(name_id_t, const lexicon_t&);
     expected_t<parse_tree_ptr_t> finish() &&;
 
+    // Like finish(), but hands the parse_tree_t to the caller instead of adding it to the
+    // syntax_farm_t.
+    expected_t<unique_ptr_t<parse_tree_t>> finish_owned() &&;
+
+    void look_at(index_t idx) const;
+
     index_t num_fragments_left() const;
     const fragment_t* fragment_by(index_t idx_offset = 0) const;
 
@@ -76,4 +94,8 @@ namespace silva {
 // IMPLEMENTATION
 
 namespace silva {
+  inline void parse_tree_nursery_t::look_at(const index_t idx) const
+  {
+    fragment_lookahead_end = std::max(fragment_lookahead_end, idx + 1);
+  }
 }
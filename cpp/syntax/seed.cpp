@@ -725,7 +725,9 @@ namespace silva::seed::impl {
     {
       auto ss = stake();
       SILVA_EXPECT_PARSE(lexicon.ni_expr, num_fragments_left() >= 1, "no more fragments in input");
-      const auto dg = axe_t::parse_delegate_t::make<&seed_parse_tree_nursery_t::any_rule>(this);
+      const axe_t::parse_delegate_t dg = [this](const name_id_t rule_name) {
+        return any_rule(rule_name);
+      };
       ss.add_proto_node(
           SILVA_EXPECT_PARSE_FWD(lexicon.ni_expr, seed_expr_axe.apply(*this, lexicon.ni_expr, dg)));
       return ss.commit();
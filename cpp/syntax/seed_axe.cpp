@@ -436,7 +436,7 @@ namespace silva::seed::impl {
     const axe_t& axe;
     parse_tree_nursery_t& nursery;
     const lexicon_t& lexicon = *axe.lp;
-    delegate_t<expected_t<parse_tree_node_t>(name_id_t)> rule_parser;
+    const axe_t::parse_delegate_t& rule_parser;
     level_index_t min_prec_level = {};
 
     syntax_farm_ptr_t sfp = nursery.sfp;
@@ -518,13 +518,14 @@ namespace silva::seed::impl {
     {
       auto retval = SILVA_EXPECT_FWD(invoke_rule_parser(axe.oper_rule));
       SILVA_EXPECT(retval.tn.nursery_tree_index.has_value(), MAJOR);
-      const parse_tree_node_t& oper_node = nursery.tree[retval.tn.nursery_tree_index.value()];
+      const parse_tree_node_t& oper_node =
+          nursery.tree[retval.tn.nursery_tree_index.value() - nursery.tree_offset];
       const fragment_span_t fs{
           nursery.fp,
           oper_node.fragment_begin,
           oper_node.fragment_end,
       };
-      retval.token_id = sfp->token_id(fs);
+      retval.token_id = sfp->token_id_find(fs);
       return retval;
     }
     expected_t<rule_parser_result_t> invoke_rule_parser(const name_id_t rule_name)
@@ -1051,7 +1052,7 @@ namespace silva::seed::impl {
     {
       auto ss = nursery.stake();
       ss.create_node(axe.name, false);
-      const index_t parsed_trees_idx = nursery.tree.size();
+      const index_t parsed_trees_idx = nursery.tree_size();
       {
         auto ss_rule = nursery.stake();
         ss_rule.create_node(name_id_t{}, false);
@@ -1064,9 +1065,10 @@ namespace silva::seed::impl {
         ss_rule.commit();
       }
 
+      const index_t parsed_trees_pos = parsed_trees_idx - nursery.tree_offset;
       parse_tree_t temp_tree{.fp = {}, .nodes = std::move(nursery.tree)};
-      const parse_tree_t parsed_trees = temp_tree.span().subspan_at(parsed_trees_idx).copy();
-      temp_tree.nodes.resize(parsed_trees_idx);
+      const parse_tree_t parsed_trees = temp_tree.span().subspan_at(parsed_trees_pos).copy();
+      temp_tree.nodes.resize(parsed_trees_pos);
       nursery.tree = std::move(temp_tree.nodes);
 
       for (auto& atn: expr_tree) {
@@ -1098,7 +1100,7 @@ namespace silva::seed {
   expected_t<parse_tree_node_t>
   axe_t::apply(parse_tree_nursery_t& nursery,
                const name_id_t rule_name,
-               delegate_t<expected_t<parse_tree_node_t>(name_id_t)> rule_parser) const
+               const parse_delegate_t& rule_parser) const
   {
     const auto level_it = level_map.find(rule_name);
     SILVA_EXPECT(level_it != level_map.end(),
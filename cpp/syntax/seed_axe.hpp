@@ -5,7 +5,8 @@
 
 #include "parse_tree_nursery.hpp"
 
-#include "canopy/delegate.hpp"
+#include "canopy/flat_hash.hpp"
+#include "canopy/inplace_function.hpp"
 
 namespace silva::seed {
 
@@ -48,17 +49,18 @@ Seed.Axe:
     name_id_t name;
     name_id_ref_t atom_rule;
     name_id_ref_t oper_rule;
-    hash_map_t<token_id_t, impl::axe_result_t> results;
+    flat_hash_map_t<token_id_t, impl::axe_result_t> results;
     optional_t<impl::result_oper_t<impl::oper_regular_t>> concat_result;
 
-    hash_map_t<name_id_t, impl::level_index_t> level_map;
+    flat_hash_map_t<name_id_t, impl::level_index_t> level_map;
 
     void compile_reset();
     template<Namespace Ns>
     expected_t<void> compile(const lexicon_t&, const Ns&);
 
-    using parse_delegate_t = delegate_t<expected_t<parse_tree_node_t>(name_id_t)>;
-    expected_t<parse_tree_node_t> apply(parse_tree_nursery_t&, name_id_t, parse_delegate_t) const;
+    using parse_delegate_t = inplace_function_t<expected_t<parse_tree_node_t>(name_id_t)>;
+    expected_t<parse_tree_node_t>
+    apply(parse_tree_nursery_t&, name_id_t, const parse_delegate_t&) const;
   };
 
   expected_t<axe_t> axe_create(syntax_farm_ptr_t, name_id_t axe_name, parse_tree_span_t);
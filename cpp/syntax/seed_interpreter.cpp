@@ -1,15 +1,24 @@
 #include "seed_interpreter.hpp"
 
 #include "canopy/array_small.hpp"
+#include "canopy/enum.hpp"
 #include "canopy/env_context.hpp"
 #include "canopy/exec_trace.hpp"
 #include "canopy/expected.hpp"
+#include "canopy/heap_stack.hpp"
+#include "canopy/memory_context.hpp"
+#include "canopy/parallel.hpp"
 #include "canopy/scope_exit.hpp"
 #include "parse_tree.hpp"
 #include "parse_tree_nursery.hpp"
 #include "seed.hpp"
 #include "seed_axe.hpp"
+#include "seed_optimizer.hpp"
 
+#include <array>
+#include <deque>
+#include <mutex>
+#include <numeric>
 #include <utility>
 
 using enum silva::error_level_t;
@@ -292,6 +301,44 @@ namespace silva::seed::impl {
     }
   };
 
+  // State of error_policy_t::FURTHEST_FAILURE. Has a fixed size, so that failures can be recorded
+  // without any allocation.
+  struct furthest_failure_t {
+    index_t fragment_index = -1;
+
+    // Either the token of a terminal or the name of a twig-rule.
+    struct item_t {
+      token_id_t token_id;
+      name_id_t rule_name;
+      friend bool operator==(const item_t&, const item_t&) = default;
+    };
+    constexpr static index_t capacity = 16;
+    std::array<item_t, capacity> items;
+
+    // May be larger than "capacity", in which case only the first items are kept.
+    index_t num_items = 0;
+
+    void add(const index_t failed_fragment_index, const item_t& item)
+    {
+      if (failed_fragment_index < fragment_index) {
+        return;
+      }
+      if (failed_fragment_index > fragment_index) {
+        fragment_index = failed_fragment_index;
+        num_items      = 0;
+      }
+      for (index_t i = 0; i < std::min(num_items, capacity); ++i) {
+        if (items[i] == item) {
+          return;
+        }
+      }
+      if (num_items < capacity) {
+        items[num_items] = item;
+      }
+      num_items += 1;
+    }
+  };
+
   struct interpreter_apply_nursery_t : public parse_tree_nursery_t {
     const interpreter_t* se = nullptr;
     syntax_farm_ptr_t sfp   = se->sfp;
@@ -299,10 +346,22 @@ namespace silva::seed::impl {
 
     const interpreter_t::language_data_t* lang_data = nullptr;
 
-    int rule_depth = 0;
+    // The recursive descent runs on a heap-stack of this many bytes (see apply()). Parsing fails
+    // once less than "stack_reserve" bytes are left on it.
+    index_t stack_budget                   = 0;
+    constexpr static index_t stack_reserve = 128 * 1024;
+
+    // Points to the one of a parse_session_t if there is one.
+    heap_stack_t own_heap_stack;
+    heap_stack_t* heap_stack = &own_heap_stack;
 
     int twig_rule_depth = 0;
 
+    // Only set by run_chunk(): the "X *" expression of the goal-rule, whose items make up the
+    // chunk, and one past the furthest fragment that was looked at until the last item was parsed.
+    const parse_tree_node_t* chunk_items_root = nullptr;
+    index_t chunk_items_lookahead_end         = 0;
+
     const interpreter_t::rule_expr_data_t* curr_rule = nullptr;
     struct rule_expr_data_scope_t {
       interpreter_apply_nursery_t& self;
@@ -318,6 +377,137 @@ namespace silva::seed::impl {
 
     seed_exec_trace_t exec_trace{.sfp = sfp, .lexicon = lexicon};
 
+    // Only set if SEED_PROFILE is true.
+    optional_t<profiler_t> profiler;
+    struct profile_scope_t {
+      interpreter_apply_nursery_t* nursery = nullptr;
+      name_id_t rule_name;
+      bool success = false;
+      profile_scope_t(interpreter_apply_nursery_t* nursery_, const name_id_t rule_name)
+        : nursery(nursery_->profiler.has_value() ? nursery_ : nullptr), rule_name(rule_name)
+      {
+        if (nursery != nullptr) {
+          nursery->profiler->enter(rule_name, nursery->fragment_index);
+        }
+      }
+      ~profile_scope_t()
+      {
+        if (nursery != nullptr) {
+          nursery->profiler->exit(rule_name, nursery->fragment_index, success);
+        }
+      }
+      profile_scope_t(const profile_scope_t&)            = delete;
+      profile_scope_t& operator=(const profile_scope_t&) = delete;
+    };
+    [[nodiscard]] profile_scope_t profile_scope(const name_id_t rule_name)
+    {
+      return profile_scope_t{this, rule_name};
+    }
+
+    // Only set by interpreter_t::apply_events(). The nodes are then handed to the consumer as soon
+    // as no open choice-point can backtrack over them anymore, and are dropped from "tree"
+    // afterwards.
+    parse_event_consumer_t* consumer = nullptr;
+
+    // Tree-sizes at which the currently open choice-points (alternatives, repetitions, predicates,
+    // ...) started. Only maintained if there is a consumer.
+    memory_array_t<index_t> choice_points;
+    struct choice_point_t {
+      interpreter_apply_nursery_t* nursery = nullptr;
+      choice_point_t(interpreter_apply_nursery_t* nursery_)
+        : nursery(nursery_->consumer != nullptr ? nursery_ : nullptr)
+      {
+        if (nursery != nullptr) {
+          nursery->choice_points.push_back(nursery->tree_size());
+        }
+      }
+      ~choice_point_t()
+      {
+        if (nursery != nullptr) {
+          nursery->choice_points.pop_back();
+        }
+      }
+      choice_point_t(const choice_point_t&)            = delete;
+      choice_point_t& operator=(const choice_point_t&) = delete;
+    };
+    [[nodiscard]] choice_point_t choice_point() { return choice_point_t{this}; }
+
+    // All nodes before this index have been handed to the consumer.
+    index_t events_end = 0;
+
+    // Nodes for which the consumer has seen the enter-event but not yet the exit-event. The
+    // "node_end" of nodes that are still being parsed is only known once their stake commits.
+    struct event_node_t {
+      index_t node_index = 0;
+      index_t node_end   = std::numeric_limits<index_t>::max();
+      name_id_t rule_name;
+      index_t fragment_begin = 0;
+      index_t fragment_end   = 0;
+    };
+    memory_array_t<event_node_t> event_nodes;
+
+    expected_t<void> emit_exit_events_until(const index_t node_index)
+    {
+      while (!event_nodes.empty() && event_nodes.back().node_end <= node_index) {
+        const event_node_t& en = event_nodes.back();
+        SILVA_EXPECT_FWD(consumer->on_rule_exit(en.rule_name, en.fragment_begin, en.fragment_end));
+        event_nodes.pop_back();
+      }
+      return {};
+    }
+
+    // Must only be called when no twig-rule is being parsed, so that all token nodes are complete.
+    expected_t<void> emit_events()
+    {
+      const index_t limit = choice_points.empty() ? tree_size() : choice_points.front();
+      while (events_end < limit) {
+        SILVA_EXPECT_FWD(emit_exit_events_until(events_end));
+        const parse_tree_node_t& node = tree[events_end - tree_offset];
+        SILVA_EXPECT(node.subtree_size > 0 || !node.allow_token, ASSERT);
+        if (node.allow_token) {
+          SILVA_EXPECT_FWD(
+              consumer->on_token(node.rule_name, node.fragment_begin, node.fragment_end));
+          events_end += node.subtree_size;
+        }
+        else {
+          SILVA_EXPECT_FWD(consumer->on_rule_enter(node.rule_name, node.fragment_begin));
+          event_node_t en{
+              .node_index     = events_end,
+              .rule_name      = node.rule_name,
+              .fragment_begin = node.fragment_begin,
+              .fragment_end   = node.fragment_end,
+          };
+          if (node.subtree_size > 0) {
+            en.node_end = events_end + node.subtree_size;
+          }
+          event_nodes.push_back(en);
+          events_end += 1;
+        }
+      }
+      // Trimming only once the handed-out prefix dominates keeps this amortized O(1) per node.
+      const index_t num_handed_out = events_end - tree_offset;
+      if (num_handed_out >= 1024 && 2 * num_handed_out >= index_t(tree.size())) {
+        discard_prefix(events_end);
+      }
+      return {};
+    }
+
+    // Called right after the stake of a (non-twig) rule committed the node at "node_index".
+    expected_t<void> emit_events_commit(const index_t node_index, const parse_tree_node_t& node)
+    {
+      SILVA_EXPECT_FWD(emit_events());
+      if (node_index < events_end) {
+        // The enter-event was emitted while the node was still being parsed.
+        const index_t node_end = node_index + node.subtree_size;
+        SILVA_EXPECT_FWD(emit_exit_events_until(node_end));
+        SILVA_EXPECT(!event_nodes.empty() && event_nodes.back().node_index == node_index, ASSERT);
+        event_nodes.back().node_end     = node_end;
+        event_nodes.back().fragment_end = node.fragment_end;
+        SILVA_EXPECT_FWD(emit_exit_events_until(node_end));
+      }
+      return {};
+    }
+
     interpreter_apply_nursery_t(fragment_span_t fs,
                                 const lexicon_t& lexicon,
                                 const interpreter_t* root,
@@ -352,8 +542,180 @@ namespace silva::seed::impl {
       }
     };
 
+    // Only set with error_policy_t::FURTHEST_FAILURE. Failures inside of negative lookaheads (which
+    // make them succeed) aren't recorded.
+    optional_t<furthest_failure_t> furthest_failure;
+    int not_depth = 0;
+
+    error_t furthest_failure_error(const error_level_t error_level) const
+    {
+      const furthest_failure_t& ff = furthest_failure.value();
+      if (ff.fragment_index < 0) {
+        return make_error(error_level, {}, "[{}] could not parse", fragment_location_at(fs.begin));
+      }
+      string_t expected;
+      for (index_t i = 0; i < std::min(ff.num_items, furthest_failure_t::capacity); ++i) {
+        const furthest_failure_t::item_t& item = ff.items[i];
+        if (i > 0) {
+          expected += ", ";
+        }
+        if (item.rule_name.is_valid()) {
+          expected += pretty_string(lexicon.name_id_wrap(item.rule_name));
+        }
+        else {
+          expected += pretty_string(sfp->token_id_wrap(item.token_id));
+        }
+      }
+      if (ff.num_items > furthest_failure_t::capacity) {
+        expected += fmt::format(", ... ({} more)", ff.num_items - furthest_failure_t::capacity);
+      }
+      return make_error(error_level,
+                        {},
+                        "[{}] expected one of: {}",
+                        fragment_location_at(ff.fragment_index),
+                        std::move(expected));
+    }
+
+    // Seed-axes move the nodes of their operands around, so rule applications inside them are
+    // neither recorded nor reused by incremental parsing.
+    int axe_depth = 0;
+
+    // Only set by interpreter_t::apply_incremental().
+    struct incremental_t {
+      const incremental_parse_t* previous = nullptr;
+
+      // The fragments before "damage_begin" are the same as in the previous fragmentization, and so
+      // are the fragments from "damage_end" onwards, which were previously at "damage_end - shift".
+      index_t damage_begin = 0;
+      index_t damage_end   = 0;
+      index_t shift        = 0;
+
+      // Maps rule-name and first fragment of each previous rule application to its index.
+      hash_map_t<pair_t<name_id_t, index_t>, index_t> previous_index;
+
+      array_t<rule_application_t> applications;
+      index_t num_reused_nodes = 0;
+    };
+    optional_t<incremental_t> incremental;
+
+    // Drops the recorded rule applications whose nodes have been removed from "tree" by
+    // backtracking since the last call.
+    void incremental_flush()
+    {
+      auto& apps = incremental->applications;
+      while (!apps.empty() && apps.back().node_end > tree_size_low_water) {
+        apps.pop_back();
+      }
+      tree_size_low_water = tree_size();
+    }
+
+    // Copies the previous application of the rule at the current fragment, if the edit can't have
+    // changed its result.
+    optional_t<node_and_error_t> incremental_reuse(const rule_application_t& context)
+    {
+      incremental_t& inc = *incremental;
+      if (inc.previous == nullptr) {
+        return std::nullopt;
+      }
+      const bool after_damage = (fragment_index >= inc.damage_end);
+      if (!after_damage && fragment_index >= inc.damage_begin) {
+        return std::nullopt;
+      }
+      const index_t shift = after_damage ? inc.shift : 0;
+      const auto it       = inc.previous_index.find({context.rule_name, fragment_index - shift});
+      if (it == inc.previous_index.end()) {
+        return std::nullopt;
+      }
+      const array_t<rule_application_t>& prev_apps = inc.previous->applications;
+      const rule_application_t& prev_app           = prev_apps[it->second];
+      if (prev_app.has_last_error || prev_app.is_literal_nodes != context.is_literal_nodes ||
+          prev_app.is_no_whitespace != context.is_no_whitespace) {
+        return std::nullopt;
+      }
+      if (!after_damage && prev_app.lookahead_end > inc.damage_begin) {
+        return std::nullopt;
+      }
+
+      incremental_flush();
+      const array_t<parse_tree_node_t>& prev_nodes = inc.previous->ptp->nodes;
+      const index_t node_shift                     = tree_size() - prev_app.node_begin;
+      for (index_t i = prev_app.node_begin; i < prev_app.node_end; ++i) {
+        parse_tree_node_t& node = tree.emplace_back(prev_nodes[i]);
+        node.fragment_begin += shift;
+        node.fragment_end += shift;
+      }
+      const index_t nested_shift = index_t(inc.applications.size()) - prev_app.nested_begin;
+      for (index_t j = prev_app.nested_begin; j <= it->second; ++j) {
+        rule_application_t& app = inc.applications.emplace_back(prev_apps[j]);
+        app.fragment_begin += shift;
+        app.fragment_end += shift;
+        app.lookahead_end += shift;
+        app.node_begin += node_shift;
+        app.node_end += node_shift;
+        app.proto_node.fragment_begin += shift;
+        app.proto_node.fragment_end += shift;
+        app.nested_begin += nested_shift;
+      }
+      tree_size_low_water = tree_size();
+      fragment_index      = prev_app.fragment_end + shift;
+      look_at(prev_app.lookahead_end + shift - 1);
+      inc.num_reused_nodes += prev_app.node_end - prev_app.node_begin;
+      return node_and_error_t{inc.applications.back().proto_node};
+    }
+
+    expected_t<node_and_error_t> handle_rule_incremental(const name_id_t t_rule_name)
+    {
+      const auto it = se->rule_exprs.find(t_rule_name);
+      if (it == se->rule_exprs.end()) {
+        return handle_rule_parse(t_rule_name);
+      }
+      const bool inherits_flags = it->second.is_twig_rule && curr_rule != nullptr;
+      rule_application_t app{
+          .rule_name        = t_rule_name,
+          .is_literal_nodes = inherits_flags && curr_rule->is_literal_nodes,
+          .is_no_whitespace = inherits_flags && curr_rule->is_no_whitespace,
+          .fragment_begin   = fragment_index,
+      };
+      if (auto reused = incremental_reuse(app); reused.has_value()) {
+        return std::move(reused).value();
+      }
+
+      incremental_flush();
+      app.node_begin                    = tree_size();
+      app.nested_begin                  = incremental->applications.size();
+      const index_t outer_lookahead_end = std::exchange(fragment_lookahead_end, fragment_index);
+      scope_exit_t lookahead_exit([this, outer_lookahead_end] {
+        fragment_lookahead_end = std::max(fragment_lookahead_end, outer_lookahead_end);
+      });
+      node_and_error_t retval = SILVA_EXPECT_FWD_PLAIN(handle_rule_parse(t_rule_name));
+      incremental_flush();
+      app.fragment_end   = fragment_index;
+      app.lookahead_end  = std::max(fragment_lookahead_end, fragment_index);
+      app.node_end       = tree_size();
+      app.proto_node     = retval.node;
+      app.has_last_error = !retval.last_error.is_empty();
+      incremental->applications.push_back(app);
+      return retval;
+    }
+
     expected_t<node_and_error_t> s_terminal(const parse_tree_span_t pts,
                                             const name_id_t t_rule_name)
+    {
+      if (!furthest_failure.has_value() || twig_rule_depth > 0 || not_depth > 0) {
+        return s_terminal_match(pts, t_rule_name);
+      }
+      const index_t orig_fragment_index = fragment_index;
+      auto retval                       = s_terminal_match(pts, t_rule_name);
+      if (!retval.has_value() && retval.error().level < MAJOR) {
+        const auto [s_token_pts]    = SILVA_EXPECT_FWD(pts.get_children<1>());
+        const token_id_t s_token_id = SILVA_EXPECT_FWD(s_token_pts.token());
+        furthest_failure->add(orig_fragment_index, {.token_id = s_token_id});
+      }
+      return retval;
+    }
+
+    expected_t<node_and_error_t> s_terminal_match(const parse_tree_span_t pts,
+                                                  const name_id_t t_rule_name)
     {
       auto ss = stake();
       SILVA_EXPECT(pts.rule_name() == lexicon.ni_term, MAJOR);
@@ -383,6 +745,7 @@ namespace silva::seed::impl {
                              fragment_category_by());
           fragment_index =
               SILVA_EXPECT_PARSE_FWD(t_rule_name, fp->advance_language(fragment_index));
+          look_at(fragment_index - 1);
           auto retval = ss.commit();
           SILVA_EXPECT_FWD(skip());
           return retval;
@@ -432,7 +795,7 @@ namespace silva::seed::impl {
         }
         else {
           const token_id_t curr_frag_cat_ti =
-              fragment_category_to_token_id(*sfp, fragment_category_by());
+              se->fragment_category_tokens.at(fragment_category_by());
           SILVA_EXPECT(curr_frag_cat_ti == expected_frag_cat_ti,
                        MINOR,
                        "expected token of category {}; got {}",
@@ -451,8 +814,11 @@ namespace silva::seed::impl {
                                                const name_id_t t_rule_name)
     {
       {
+        const auto cp                  = choice_point();
         auto ss                        = stake();
         const auto [pts_oper, sub_pts] = SILVA_EXPECT_FWD(pts.get_children<2>());
+        not_depth += 1;
+        scope_exit_t not_exit([this] { not_depth -= 1; });
         SILVA_EXPECT(pts_oper.rule_name() == lexicon.ni_oper, MAJOR);
         const auto result = SILVA_EXPECT_FWD_IF(MAJOR, s_expr(sub_pts, t_rule_name));
         SILVA_EXPECT(!result, MINOR, "Successfully parsed 'not' expression");
@@ -537,13 +903,22 @@ namespace silva::seed::impl {
       else {
         std::tie(min_repeat, max_repeat) = SILVA_EXPECT_FWD(get_min_max_repeat(op_ti));
       }
+      // Recursive uses of the goal-rule of run_chunk() are ordinary repetitions.
+      const bool is_chunk_items = (pts.root == chunk_items_root);
+      if (is_chunk_items) {
+        chunk_items_root = nullptr;
+      }
       index_t repeat_count = 0;
       error_t last_error;
       while (repeat_count < max_repeat) {
-        auto result = SILVA_EXPECT_FWD_IF(MAJOR, s_expr(pts_expr, t_rule_name));
+        const auto cp = choice_point();
+        auto result   = SILVA_EXPECT_FWD_IF(MAJOR, s_expr(pts_expr, t_rule_name));
         if (result.has_value()) {
           ss.add_proto_node(std::move(*result).as_node());
           repeat_count += 1;
+          if (is_chunk_items) {
+            chunk_items_lookahead_end = fragment_lookahead_end;
+          }
         }
         else {
           last_error = std::move(result).error();
@@ -624,6 +999,7 @@ namespace silva::seed::impl {
     expected_t<node_and_error_t> s_expr_and(const parse_tree_span_t pts,
                                             const name_id_t t_rule_name)
     {
+      const auto cp = choice_point();
       optional_t<stake_t<>> ss;
       auto [it, end] = pts.children_range();
       while (true) {
@@ -645,6 +1021,7 @@ namespace silva::seed::impl {
     expected_t<node_and_error_t> s_expr_followup(const parse_tree_span_t pts,
                                                  const name_id_t t_rule_name)
     {
+      const auto cp  = choice_point();
       auto ss        = stake();
       auto [it, end] = pts.children_range();
       bool is_first  = true;
@@ -681,7 +1058,8 @@ namespace silva::seed::impl {
       auto [it, end]            = pts.children_range();
       while (true) {
         SILVA_EXPECT_NURSERY_BREAK(error_nursery, it != end, MAJOR, "expected sub-tree");
-        auto result = s_expr(*it, t_rule_name);
+        const auto cp = choice_point();
+        auto result   = s_expr(*it, t_rule_name);
         if (result.has_value()) {
           retval = std::move(*result).as_node();
           break;
@@ -765,29 +1143,35 @@ namespace silva::seed::impl {
     {
       const auto it = se->axes.find(axe_rule_name);
       SILVA_EXPECT(it != se->axes.end(), MAJOR);
+      // The axe re-arranges the nodes of its operands, so nothing may be emitted before it is done.
+      const auto cp = choice_point();
+      axe_depth += 1;
+      scope_exit_t axe_scope_exit([this] { axe_depth -= 1; });
       auto ss{stake()};
       const axe_t& axe = it->second;
-      const axe_t::parse_delegate_t::pack_t pack{
-          [&](const name_id_t rule_name) -> expected_t<parse_tree_node_t> {
-            node_and_error_t result = SILVA_EXPECT_FWD(handle_rule(rule_name));
-            return std::move(result).as_node();
-          },
+      const axe_t::parse_delegate_t rule_parser =
+          [this](const name_id_t rule_name) -> expected_t<parse_tree_node_t> {
+        node_and_error_t result = SILVA_EXPECT_FWD(handle_rule(rule_name));
+        return std::move(result).as_node();
       };
       ss.add_proto_node(
-          SILVA_EXPECT_PARSE_FWD(t_rule_name, axe.apply(*this, t_rule_name, pack.delegate)));
+          SILVA_EXPECT_PARSE_FWD(t_rule_name, axe.apply(*this, t_rule_name, rule_parser)));
       return ss.commit();
     }
 
     expected_t<void> skip()
     {
-      if (!lang_data->skip_rule_expr.has_value()) {
+      // There is nothing to skip at the limit. Not looking at the fragment there matters for
+      // run_chunk(), whose next chunk checks that skip() doesn't move at its beginning.
+      if (!lang_data->skip_rule_expr.has_value() || fragment_index == fragment_limit) {
         return {};
       }
-      const parse_tree_span_t& s_pts = lang_data->skip_rule_expr->expr;
+      const parse_tree_span_t& s_pts = lang_data->skip_rule_expr->expr_compiled;
       if (s_pts.ptp.is_nullptr()) {
         return {};
       }
-      auto ss = stake();
+      const auto cp = choice_point();
+      auto ss       = stake();
       SILVA_EXPECT_FWD_IF(MAJOR, s_expr(s_pts, name_id_t{}));
       const index_t new_frag_idx = fragment_index;
       ss.clear();
@@ -797,26 +1181,51 @@ namespace silva::seed::impl {
 
     expected_t<node_and_error_t> handle_rule(const name_id_t t_rule_name)
     {
-      auto ets = SILVA_EXEC_TRACE_SCOPE(exec_trace, t_rule_name, fragment_location_by());
-      rule_depth += 1;
-      scope_exit_t scope_exit([this] { rule_depth -= 1; });
-      SILVA_EXPECT(rule_depth <= 100,
+      if (incremental.has_value() && twig_rule_depth == 0 && axe_depth == 0) {
+        return handle_rule_incremental(t_rule_name);
+      }
+      return handle_rule_parse(t_rule_name);
+    }
+
+    // Either handle_rule_traced() or handle_rule_untraced(), selected once by run(), so that parses
+    // without SEED_EXEC_TRACE don't touch the exec_trace at all.
+    using handle_rule_func_t =
+        expected_t<node_and_error_t> (interpreter_apply_nursery_t::*)(name_id_t);
+    handle_rule_func_t handle_rule_func = &interpreter_apply_nursery_t::handle_rule_untraced;
+
+    expected_t<node_and_error_t> handle_rule_parse(const name_id_t t_rule_name)
+    {
+      return (this->*handle_rule_func)(t_rule_name);
+    }
+
+    // The results of rule applications are returned as they are, without unwrapping and wrapping
+    // them again, as this happens once per rule application on every level of the recursion.
+    expected_t<node_and_error_t> handle_rule_traced(const name_id_t t_rule_name)
+    {
+      auto ets     = SILVA_EXEC_TRACE_SCOPE(exec_trace, t_rule_name, fragment_location_by());
+      auto retval  = handle_rule_untraced(t_rule_name);
+      ets->success = retval.has_value();
+      return retval;
+    }
+
+    expected_t<node_and_error_t> handle_rule_untraced(const name_id_t t_rule_name)
+    {
+      auto ps = profile_scope(t_rule_name);
+      SILVA_EXPECT(heap_stack_bytes_left() >= stack_reserve,
                    FATAL,
-                   "Stack is getting too deep. Infinite recursion in grammar?");
+                   "Stack budget of {} bytes (SEED_STACK_BUDGET) exhausted. Infinite recursion in "
+                   "grammar?",
+                   stack_budget);
       const auto it{se->rule_exprs.find(t_rule_name)};
       SILVA_EXPECT(it != se->rule_exprs.end(),
                    MAJOR,
                    "Unknown rule: {}",
                    lexicon.name_id_str(t_rule_name));
       const interpreter_t::rule_expr_data_t& rule_data = it->second;
-      node_and_error_t retval;
-      if (rule_data.is_twig_rule) {
-        retval = SILVA_EXPECT_FWD_PLAIN(handle_twig_rule(t_rule_name, rule_data));
-      }
-      else {
-        retval = SILVA_EXPECT_FWD_PLAIN(handle_branch_rule(t_rule_name, rule_data));
-      }
-      ets->success = true;
+
+      auto retval = rule_data.is_twig_rule ? handle_twig_rule(t_rule_name, rule_data)
+                                           : handle_branch_rule(t_rule_name, rule_data);
+      ps.success  = retval.has_value();
       return retval;
     }
 
@@ -836,13 +1245,30 @@ namespace silva::seed::impl {
         retval = SILVA_EXPECT_PARSE_FWD(t_rule_name, handle_rule_axe(axe_name, t_rule_name));
       }
       else {
-        auto ss = stake();
+        auto ss                  = stake();
+        const index_t node_index = tree_size();
         if (!rule_data.is_no_node) {
           ss.create_node(t_rule_name, false);
+          if (consumer != nullptr) {
+            // Placeholder until the commit, so that the enter-event can be emitted early.
+            parse_tree_node_t& placeholder = tree.back();
+            placeholder.subtree_size       = 0;
+            placeholder.rule_name          = t_rule_name;
+            placeholder.fragment_begin     = ss.proto_node.fragment_begin;
+          }
         }
-        auto result = SILVA_EXPECT_PARSE_FWD(t_rule_name, s_expr(s_pts, t_rule_name));
+        auto result =
+            SILVA_EXPECT_PARSE_FWD(t_rule_name, s_expr(rule_data.expr_compiled, t_rule_name));
         ss.add_proto_node(std::move(result.node));
         retval = node_and_error_t{ss.commit(), std::move(result.last_error)};
+        if (consumer != nullptr && twig_rule_depth == 0) {
+          if (rule_data.is_no_node) {
+            SILVA_EXPECT_FWD(emit_events());
+          }
+          else {
+            SILVA_EXPECT_FWD(emit_events_commit(node_index, retval.node));
+          }
+        }
       }
       return retval;
     }
@@ -858,7 +1284,13 @@ namespace silva::seed::impl {
       if (!rule_data.is_no_node) {
         ss.create_node(t_rule_name, true);
       }
-      auto result = SILVA_EXPECT_PARSE_FWD(t_rule_name, s_expr(rule_data.expr, t_rule_name));
+      const index_t orig_fragment_index = fragment_index;
+      auto maybe_result                 = s_expr(rule_data.expr_compiled, t_rule_name);
+      if (!maybe_result.has_value() && furthest_failure.has_value() && entered_token_space &&
+          not_depth == 0) {
+        furthest_failure->add(orig_fragment_index, {.rule_name = t_rule_name});
+      }
+      auto result = SILVA_EXPECT_PARSE_FWD(t_rule_name, std::move(maybe_result));
       ss.add_proto_node(std::move(result.node));
       auto retval = ss.commit();
       if (entered_token_space) {
@@ -866,6 +1298,352 @@ namespace silva::seed::impl {
       }
       return retval;
     }
+
+    // The recursive descent stays recursive, but runs on a heap-stack whose size is the nesting
+    // budget. An explicit stack of continuations would need a frame per rule application just the
+    // same, and every place that now simply returns an error (stakes, error nurseries, axes)
+    // would have to be turned into a resumable state. The "deep-nesting-performance" benchmark
+    // compares the cost per node of deeply nested and of flat texts: as long as they are about
+    // the same, the recursion itself isn't what an explicit stack could make faster.
+    expected_t<node_and_error_t> run_goal_rule(const name_id_t goal_rule_name)
+    {
+      stack_budget = SILVA_ENV_CONTEXT_AS("SEED_STACK_BUDGET", index_t, 64 * 1024 * 1024);
+      SILVA_EXPECT(stack_budget > 2 * stack_reserve,
+                   MAJOR,
+                   "SEED_STACK_BUDGET must be larger than {} bytes",
+                   2 * stack_reserve);
+      SILVA_EXPECT_FWD(check());
+      heap_stack->resize(stack_budget);
+      return SILVA_EXPECT_FWD(heap_stack_run(*heap_stack,
+                                             [&] { return handle_rule(goal_rule_name); }),
+                              "seed::interpreter_t::apply({}) failed to parse",
+                              lexicon.name_id_wrap(goal_rule_name));
+    }
+
+    // Parses only the fragments [chunk_begin, chunk_end) with the goal-rule, which has to be of the
+    // form "X *" (see compiled_grammar_t::apply_parallel()). Except for the first chunk, which
+    // starts at the beginning of the language, chunks must start with an "X". Only if the items
+    // didn't look at the fragment at "chunk_end" do they end where apply() would have ended them.
+    expected_t<void>
+    run_chunk(const name_id_t goal_rule_name, const index_t chunk_begin, const index_t chunk_end)
+    {
+      if (chunk_end + 1 != fs.end) {
+        fragment_limit = chunk_end;
+      }
+      const parse_tree_span_t& goal_expr = se->rule_exprs.at(goal_rule_name).expr_compiled;
+      // The optimizer removes "Expr" wrappers.
+      chunk_items_root = (goal_expr.rule_name() == lexicon.ni_expr) ? goal_expr.subspan_at(1).root
+                                                                     : goal_expr.root;
+      if (chunk_begin == fs.begin) {
+        SILVA_EXPECT_ASSERT(init(goal_rule_name, lexicon));
+        SILVA_EXPECT_FWD(skip());
+      }
+      else {
+        fragment_index = chunk_begin;
+        SILVA_EXPECT_FWD(skip());
+        SILVA_EXPECT(fragment_index == chunk_begin,
+                     MINOR,
+                     "[{}] chunk doesn't start after skipped fragments",
+                     fragment_location_at(chunk_begin));
+      }
+      SILVA_EXPECT_FWD_PLAIN(run_goal_rule(goal_rule_name));
+      SILVA_EXPECT(fragment_index == chunk_end,
+                   MINOR,
+                   "[{}] chunk was not parsed up to {}",
+                   fragment_location_by(),
+                   fragment_location_at(chunk_end));
+      SILVA_EXPECT(chunk_items_root == nullptr &&
+                       (fragment_limit != chunk_end || chunk_items_lookahead_end <= chunk_end),
+                   MINOR,
+                   "[{}] last item of the chunk might continue after it",
+                   fragment_location_at(chunk_end));
+      SILVA_EXPECT(tree_offset == 0 && !tree.empty(), ASSERT);
+      return {};
+    }
+
+    // The part of run() that differs for error_policy_t::FURTHEST_FAILURE: errors below MAJOR are
+    // not recorded while parsing, and any parse failure is reported as the furthest failure. The
+    // (mostly unrecorded) errors of the parse itself are dropped before the report is recorded.
+    expected_t<node_and_error_t> run_furthest_failure(const name_id_t goal_rule_name)
+    {
+      const error_context_ptr_t error_context = error_context_t::get();
+      auto result = [&]() -> expected_t<node_and_error_t> {
+        const bool outer_skip = std::exchange(error_context->skip_minor_errors, true);
+        scope_exit_t skip_exit([&] { error_context->skip_minor_errors = outer_skip; });
+        SILVA_EXPECT_FWD(skip());
+        return run_goal_rule(goal_rule_name);
+      }();
+      if (result.has_value() && fragment_index + 1 == fs.end) {
+        return result;
+      }
+      // Committed alternatives fail with MAJOR errors, so these are parse failures too.
+      error_level_t error_level = MINOR;
+      if (!result.has_value()) {
+        if (result.error().level > MAJOR) {
+          return result;
+        }
+        error_level = result.error().level;
+      }
+      result = node_and_error_t{};
+      return std::unexpected(furthest_failure_error(error_level));
+    }
+
+    expected_t<void> run(const name_id_t goal_rule_name)
+    {
+      const auto do_trace =
+          SILVA_EXPECT_FWD_IF(MAJOR, env_context_get_as<bool>("SEED_EXEC_TRACE")).value_or(false);
+      if (do_trace) {
+        const index_t capacity =
+            SILVA_ENV_CONTEXT_AS("SEED_EXEC_TRACE_CAPACITY", index_t, exec_trace.capacity);
+        SILVA_EXPECT(capacity >= 1, MAJOR, "SEED_EXEC_TRACE_CAPACITY must be positive");
+        exec_trace.capacity = capacity;
+        handle_rule_func    = &interpreter_apply_nursery_t::handle_rule_traced;
+      }
+      scope_exit_t trace_exit([do_trace, this] {
+        if (do_trace) {
+          if (exec_trace.num_dropped() > 0) {
+            fmt::print("[{} earlier rule applications dropped, see SEED_EXEC_TRACE_CAPACITY]\n",
+                       exec_trace.num_dropped());
+          }
+          fmt::print("{}", SILVA_ASSERT_FWD(std::move(exec_trace).as_tree_to_string()));
+        }
+      });
+      const auto do_profile =
+          SILVA_EXPECT_FWD_IF(MAJOR, env_context_get_as<bool>("SEED_PROFILE")).value_or(false);
+      if (do_profile) {
+        profiler.emplace(sfp->name_infos.size());
+      }
+      scope_exit_t profile_exit([this] {
+        if (profiler.has_value()) {
+          std::move(*profiler).finish(lexicon);
+        }
+      });
+      SILVA_EXPECT_ASSERT(init(goal_rule_name, lexicon));
+      node_and_error_t ptn;
+      if (furthest_failure.has_value()) {
+        ptn = SILVA_EXPECT_FWD_PLAIN(run_furthest_failure(goal_rule_name));
+      }
+      else {
+        SILVA_EXPECT_FWD(skip());
+        ptn = SILVA_EXPECT_FWD_PLAIN(run_goal_rule(goal_rule_name));
+        if (fragment_index + 1 != fs.end) {
+          SILVA_EXPECT(!ptn.last_error.is_empty(),
+                       MAJOR,
+                       "could not parse entire text of {}",
+                       fs.fp->filepath);
+          return std::unexpected(std::move(ptn.last_error));
+        }
+      }
+      SILVA_EXPECT(ptn.node.num_children == 1, ASSERT);
+      SILVA_EXPECT(ptn.node.subtree_size == tree_size(), ASSERT);
+      if (consumer != nullptr) {
+        SILVA_EXPECT_FWD(emit_events());
+        SILVA_EXPECT_FWD(emit_exit_events_until(std::numeric_limits<index_t>::max()));
+      }
+      return {};
+    }
+  };
+
+  expected_t<const interpreter_t::language_data_t*>
+  language_data_of(const interpreter_t& se, const name_id_t goal_rule_name)
+  {
+    name_id_t curr = goal_rule_name;
+    while (se.sfp->get(curr).parent_name.is_valid()) {
+      curr = se.sfp->get(curr).parent_name;
+    }
+    const token_id_t lang_name = se.sfp->get(curr).base_name;
+    const auto lang_it         = se.languages.find(lang_name);
+    SILVA_EXPECT(lang_it != se.languages.end(),
+                 MINOR,
+                 "unknown language {}",
+                 se.sfp->token_id_wrap(lang_name));
+    return &lang_it->second;
+  }
+
+  // Finds the fragments in which "curr" differs from the fragmentization of the previous parse and
+  // indexes the previous rule applications.
+  void incremental_init(interpreter_apply_nursery_t::incremental_t& inc,
+                        const incremental_parse_t& previous,
+                        const fragmentization_t& curr)
+  {
+    const fragmentization_t& prev = *previous.ptp->fp;
+    const auto same_fragment      = [&](const index_t prev_idx, const index_t curr_idx) {
+      return prev.fragments[prev_idx].category == curr.fragments[curr_idx].category &&
+          prev.get_fragment_text(prev_idx) == curr.get_fragment_text(curr_idx);
+    };
+    const index_t prev_size = prev.size();
+    const index_t curr_size = curr.size();
+    const index_t min_size  = std::min(prev_size, curr_size);
+    index_t prefix          = 0;
+    while (prefix < min_size && same_fragment(prefix, prefix)) {
+      prefix += 1;
+    }
+    index_t suffix = 0;
+    while (prefix + suffix < min_size &&
+           same_fragment(prev_size - 1 - suffix, curr_size - 1 - suffix)) {
+      suffix += 1;
+    }
+    inc.previous     = &previous;
+    inc.damage_begin = prefix;
+    inc.damage_end   = curr_size - suffix;
+    inc.shift        = curr_size - prev_size;
+    inc.previous_index.reserve(previous.applications.size());
+    for (index_t i = 0; i < index_t(previous.applications.size()); ++i) {
+      const rule_application_t& app = previous.applications[i];
+      inc.previous_index[pair_t{app.rule_name, app.fragment_begin}] = i;
+    }
+  }
+
+  // If the rule is of the form "X *" and creates a node.
+  bool is_repetition_rule(const interpreter_t& se, const name_id_t rule_name)
+  {
+    const auto it = se.rule_exprs.find(rule_name);
+    if (it == se.rule_exprs.end() || it->second.is_twig_rule || it->second.is_no_node) {
+      return false;
+    }
+    const lexicon_t& lexicon = se.bootstrap_interpreter.lexicon();
+    const auto is_star       = [&](const parse_tree_span_t& pts) {
+      return se.sfp->name_id_is_parent(lexicon.ni_expr_postfix, pts.rule_name()) &&
+          se.sfp->get(pts.rule_name()).base_name == lexicon.ti_star.token_id &&
+          pts.num_children() == 2;
+    };
+    const parse_tree_span_t& pts = it->second.expr;
+    if (pts.rule_name() != lexicon.ni_expr || pts.num_children() != 1 ||
+        !is_star(pts.subspan_at(1))) {
+      return false;
+    }
+    // The optimizer removes "Expr" wrappers, but has no reason to touch the repetition itself.
+    const parse_tree_span_t& pts_compiled = it->second.expr_compiled;
+    return is_star(pts_compiled.rule_name() == lexicon.ni_expr ? pts_compiled.subspan_at(1)
+                                                               : pts_compiled);
+  }
+
+  // Guesses at which fragments the items of an "X *" rule start: after each ';' and each '}' that
+  // is not nested in parentheses (or in an embedded language), and after the fragments that are
+  // usually skipped. Returns the first fragment of each chunk followed by the LANG_END fragment.
+  array_t<index_t> chunk_bounds(const fragment_span_t& fs, const index_t min_chunk_fragments)
+  {
+    using enum fragment_category_t;
+    const fragmentization_t& frag = *fs.fp;
+    const index_t end             = fs.end - 1;
+    array_t<index_t> retval{fs.begin};
+    index_t depth = 0;
+    index_t idx   = fs.begin + 1;
+    while (idx < end) {
+      const fragment_category_t fc = frag.fragments[idx].category;
+      bool is_separator            = false;
+      if (fc == LANG_BEGIN) {
+        auto next = frag.advance_language(idx);
+        if (!next.has_value()) {
+          break;
+        }
+        idx = *next;
+        continue;
+      }
+      else if (fc == PARENTHESIS) {
+        const string_view_t text = frag.get_fragment_text(idx);
+        if (text == "(" || text == "[" || text == "{") {
+          depth += 1;
+        }
+        else if (text == ")" || text == "]" || text == "}") {
+          depth -= 1;
+          is_separator = (depth == 0 && text == "}");
+        }
+      }
+      else if (fc == OPERATOR && depth == 0) {
+        is_separator = (frag.get_fragment_text(idx) == ";");
+      }
+      idx += 1;
+      if (is_separator && idx - retval.back() >= min_chunk_fragments) {
+        while (idx < end && (!is_fragment_category_visible(frag.fragments[idx].category) ||
+                             frag.fragments[idx].category == SPACE ||
+                             frag.fragments[idx].category == LINEFEED)) {
+          idx += 1;
+        }
+        if (idx < end) {
+          retval.push_back(idx);
+        }
+      }
+    }
+    retval.push_back(end);
+    return retval;
+  }
+
+  struct parallel_chunk_t {
+    index_t begin = 0;
+    index_t end   = 0;
+    array_t<parse_tree_node_t> nodes;
+    bool is_parsed = false;
+
+    // The items looked at fragments after the end of the chunk.
+    bool is_open_ended = false;
+  };
+
+  // Heap-stacks for the threads of compiled_grammar_t::apply_parallel(), so that there are only
+  // as many of them as threads rather than one per chunk.
+  struct heap_stack_pool_t {
+    std::mutex mutex;
+    array_t<unique_ptr_t<heap_stack_t>> heap_stacks;
+
+    unique_ptr_t<heap_stack_t> acquire()
+    {
+      const std::lock_guard lock(mutex);
+      if (heap_stacks.empty()) {
+        return std::make_unique<heap_stack_t>();
+      }
+      auto retval = std::move(heap_stacks.back());
+      heap_stacks.pop_back();
+      return retval;
+    }
+
+    void release(unique_ptr_t<heap_stack_t> heap_stack)
+    {
+      const std::lock_guard lock(mutex);
+      heap_stacks.push_back(std::move(heap_stack));
+    }
+  };
+
+  void parse_chunk(const interpreter_t& se,
+                   const fragment_span_t& fs,
+                   const interpreter_t::language_data_t* lang_data,
+                   const name_id_t goal_rule_name,
+                   heap_stack_pool_t& heap_stack_pool,
+                   parallel_chunk_t& chunk)
+  {
+    interpreter_apply_nursery_t nursery(fs, se.bootstrap_interpreter.lexicon(), &se, lang_data);
+    auto heap_stack    = heap_stack_pool.acquire();
+    nursery.heap_stack = heap_stack.get();
+    chunk.is_parsed    = nursery.run_chunk(goal_rule_name, chunk.begin, chunk.end).has_value();
+    heap_stack_pool.release(std::move(heap_stack));
+    chunk.is_open_ended = (nursery.chunk_items_lookahead_end > chunk.end);
+    if (chunk.is_parsed) {
+      chunk.nodes = std::move(nursery.tree);
+    }
+  }
+
+  // The contexts of the calling thread that rule applications depend on, carried into tasks that
+  // run on other threads. The env-context (SEED_PROFILE, SEED_STACK_BUDGET, ...) is shared, while
+  // each task collects its profile in its own profile_context_t, which is merged into the caller's
+  // profile_context_t (if any) when the task is done.
+  struct task_contexts_t {
+    context_capture_t<env_context_t> env;
+    context_capture_t<profile_context_t> profile;
+    std::mutex profile_mutex;
+
+    template<typename Func>
+    void run(Func&& func)
+    {
+      const context_adopt_t<env_context_t> env_adopt(env);
+      const auto caller_profile = profile.get();
+      if (caller_profile.is_nullptr()) {
+        func();
+        return;
+      }
+      profile_context_t task_profile;
+      func();
+      const std::lock_guard lock(profile_mutex);
+      caller_profile->profile.merge(task_profile.profile);
+    }
   };
 }
 
@@ -909,6 +1687,7 @@ namespace silva::seed {
   {
     is_compiled = false;
     resolved_names.clear();
+    fragment_category_tokens.clear();
     for (auto& [_, axe]: axes) {
       axe.compile_reset();
     }
@@ -948,58 +1727,204 @@ namespace silva::seed {
       SILVA_EXPECT_FWD(axe.compile(lexicon, rule_exprs));
     }
 
+    for (const auto& [fc, _]: enum_hashmap_to_string<fragment_category_t>()) {
+      fragment_category_tokens[fc] = fragment_category_to_token_id(*sfp, fc);
+    }
+
+    // parse_tree_span_t::token() adds unknown tokens to the syntax_farm_t, so this has to happen
+    // for all tokens of the rules before they are applied.
+    for (const auto& [rule_name, rule_data]: rule_exprs) {
+      const parse_tree_span_t& pts = rule_data.expr;
+      for (index_t i = 0; i < pts.subtree_size(); ++i) {
+        if (pts.node_at(i).allow_token) {
+          SILVA_EXPECT_FWD(pts.subspan_at(i).token());
+        }
+      }
+    }
+
+    const bool seed_optimize = SILVA_ENV_CONTEXT_AS("SEED_OPTIMIZE", bool, true);
+    if (seed_optimize) {
+      SILVA_EXPECT_FWD(optimize(*this));
+    }
+    else {
+      for (auto& [_, rule_data]: rule_exprs) {
+        rule_data.expr_compiled = rule_data.expr;
+      }
+      for (auto& [_, lang_data]: languages) {
+        if (lang_data.skip_rule_expr.has_value()) {
+          lang_data.skip_rule_expr->expr_compiled = lang_data.skip_rule_expr->expr;
+        }
+      }
+    }
+
     is_compiled = true;
+    compile_count += 1;
     return {};
   }
 
-  expected_t<parse_tree_ptr_t> interpreter_t::apply(fragment_span_t fs,
-                                                    const name_id_t goal_rule_name)
+  expected_t<compiled_grammar_t> interpreter_t::compiled()
   {
     if (!is_compiled) {
       SILVA_EXPECT_FWD(compile());
     }
+    return compiled_grammar_t{.se = this};
+  }
 
-    name_id_t curr = goal_rule_name;
-    while (sfp->get(curr).parent_name.is_valid()) {
-      curr = sfp->get(curr).parent_name;
-    }
-    const token_id_t lang_name = sfp->get(curr).base_name;
-    const auto lang_it         = languages.find(lang_name);
-    SILVA_EXPECT(lang_it != languages.end(),
-                 MINOR,
-                 "unknown language {}",
-                 sfp->token_id_wrap(lang_name));
+  expected_t<parse_tree_ptr_t> interpreter_t::apply(fragment_span_t fs,
+                                                    const name_id_t goal_rule_name,
+                                                    const error_policy_t error_policy)
+  {
+    const compiled_grammar_t cg = SILVA_EXPECT_FWD(compiled());
+    auto pt = SILVA_EXPECT_FWD_PLAIN(cg.apply(std::move(fs), goal_rule_name, error_policy));
+    return sfp->add(std::move(pt));
+  }
+
+  expected_t<parse_tree_ptr_t> interpreter_t::apply(fragment_span_t fs,
+                                                    const name_id_t goal_rule_name,
+                                                    parse_session_t& session,
+                                                    const error_policy_t error_policy)
+  {
+    const compiled_grammar_t cg = SILVA_EXPECT_FWD(compiled());
+    auto pt =
+        SILVA_EXPECT_FWD_PLAIN(cg.apply(std::move(fs), goal_rule_name, session, error_policy));
+    return sfp->add(std::move(pt));
+  }
 
-    impl::interpreter_apply_nursery_t nursery(fs,
-                                              bootstrap_interpreter.lexicon(),
-                                              this,
-                                              &lang_it->second);
+  expected_t<parse_tree_ptr_t> interpreter_t::apply_parallel(fragment_span_t fs,
+                                                             const name_id_t goal_rule_name,
+                                                             const parallel_options_t& options)
+  {
+    const compiled_grammar_t cg = SILVA_EXPECT_FWD(compiled());
+    auto pt = SILVA_EXPECT_FWD_PLAIN(cg.apply_parallel(std::move(fs), goal_rule_name, options));
+    return sfp->add(std::move(pt));
+  }
 
-    const auto do_trace =
-        SILVA_EXPECT_FWD_IF(MAJOR, env_context_get_as<bool>("SEED_EXEC_TRACE")).value_or(false);
-    scope_exit_t trace_exit([do_trace, &nursery] {
-      if (do_trace) {
-        fmt::print("{}", SILVA_ASSERT_FWD(std::move(nursery.exec_trace).as_tree_to_string()));
+  expected_t<document_t> interpreter_t::apply_sections(parse_tree_ptr_t document,
+                                                       const section_goal_rule_t& section_goal_rule,
+                                                       const index_t num_threads)
+  {
+    const compiled_grammar_t cg = SILVA_EXPECT_FWD(compiled());
+
+    struct found_section_t {
+      parse_tree_span_t pts_language;
+      index_t parent = -1;
+      name_id_t goal_rule_name;
+      unique_ptr_t<parse_tree_t> pt;
+      optional_t<detached_error_t> error;
+    };
+    // A deque, so that tasks can hold on to their section while further sections are found.
+    std::mutex found_mutex;
+    std::deque<found_section_t> found;
+    impl::task_contexts_t task_contexts;
+    // Execution traces are printed when each parse is done, so they would interleave.
+    const bool do_trace = SILVA_ENV_CONTEXT_AS("SEED_EXEC_TRACE", bool, false);
+    task_group_t task_group(do_trace ? 1 : num_threads);
+
+    function_t<void(const parse_tree_span_t&, index_t)> find_sections;
+    find_sections = [&](const parse_tree_span_t& pts, const index_t parent) {
+      for (index_t i = 0; i < pts.subtree_size(); ++i) {
+        const parse_tree_span_t pts_node = pts.subspan_at(i);
+        for (const auto pts_child: pts_node.children_range()) {
+          if (pts_child.rule_name() != name_id_language) {
+            continue;
+          }
+          const name_id_t section_rule_name = section_goal_rule(pts_node, pts_child);
+          if (!section_rule_name.is_valid()) {
+            continue;
+          }
+          index_t section_index    = 0;
+          found_section_t* section = nullptr;
+          {
+            const std::lock_guard lock(found_mutex);
+            section_index = found.size();
+            section       = &found.emplace_back(found_section_t{
+                .pts_language   = pts_child,
+                .parent         = parent,
+                .goal_rule_name = section_rule_name,
+            });
+          }
+          task_group.spawn([&, section, section_index] {
+            task_contexts.run([&] {
+              auto result =
+                  cg.apply(section->pts_language.fragment_span(), section->goal_rule_name);
+              if (!result.has_value()) {
+                section->error = std::move(result).error().detach();
+                return;
+              }
+              section->pt = std::move(result).value();
+              find_sections(section->pt->span(), section_index);
+            });
+          });
+        }
       }
+    };
+    find_sections(document->span(), -1);
+    task_group.run();
+
+    array_t<index_t> order(found.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::sort(order, [&](const index_t lhs, const index_t rhs) {
+      return found[lhs].pts_language.node_at(0).fragment_begin <
+          found[rhs].pts_language.node_at(0).fragment_begin;
     });
+    for (const index_t i: order) {
+      if (found[i].error.has_value()) {
+        return std::unexpected(std::move(*found[i].error).attach());
+      }
+    }
 
-    SILVA_EXPECT_ASSERT(nursery.init(goal_rule_name, nursery.lexicon));
-    SILVA_EXPECT_FWD(nursery.skip());
-    SILVA_EXPECT_FWD(nursery.check());
-    auto ptn = SILVA_EXPECT_FWD(nursery.handle_rule(goal_rule_name),
-                                "seed::interpreter_t::apply({}) failed to parse",
-                                nursery.lexicon.name_id_wrap(goal_rule_name));
-    if (nursery.fragment_index + 1 != fs.end) {
-      SILVA_EXPECT(!ptn.last_error.is_empty(),
-                   MAJOR,
-                   "could not parse entire text of {}",
-                   fs.fp->filepath);
-      return std::unexpected(std::move(ptn.last_error));
+    document_t retval{.ptp = std::move(document)};
+    hash_map_t<index_t, index_t> new_index;
+    for (const index_t i: order) {
+      found_section_t& section = found[i];
+      new_index[i]             = retval.sections.size();
+      retval.sections.push_back(section_t{
+          .pts_language   = section.pts_language,
+          .parent         = (section.parent == -1) ? -1 : new_index.at(section.parent),
+          .goal_rule_name = section.goal_rule_name,
+          .ptp            = sfp->add(std::move(section.pt)),
+      });
     }
-    SILVA_EXPECT(ptn.node.num_children == 1, ASSERT);
-    SILVA_EXPECT(ptn.node.subtree_size == nursery.tree.size(), ASSERT);
+    return retval;
+  }
 
-    return std::move(nursery).finish();
+  expected_t<void> interpreter_t::apply_events(fragment_span_t fs,
+                                               const name_id_t goal_rule_name,
+                                               parse_event_consumer_t* consumer)
+  {
+    const compiled_grammar_t cg = SILVA_EXPECT_FWD(compiled());
+    return cg.apply_events(std::move(fs), goal_rule_name, consumer);
+  }
+
+  expected_t<incremental_parse_t>
+  interpreter_t::apply_incremental(fragmentization_ptr_t fp,
+                                   const name_id_t goal_rule_name,
+                                   const incremental_parse_t* previous)
+  {
+    if (!is_compiled) {
+      SILVA_EXPECT_FWD(compile());
+    }
+    const auto* lang_data         = SILVA_EXPECT_FWD(impl::language_data_of(*this, goal_rule_name));
+    const lexicon_t& lexicon      = bootstrap_interpreter.lexicon();
+    const fragmentization_t& frag = *fp;
+    impl::interpreter_apply_nursery_t nursery(std::move(fp), lexicon, this, lang_data);
+    auto& inc = nursery.incremental.emplace();
+    if (previous != nullptr && previous->se == this && previous->compile_count == compile_count &&
+        previous->goal_rule_name == goal_rule_name) {
+      impl::incremental_init(inc, *previous, frag);
+    }
+    SILVA_EXPECT_FWD_PLAIN(nursery.run(goal_rule_name));
+    nursery.incremental_flush();
+
+    incremental_parse_t retval{
+        .goal_rule_name   = goal_rule_name,
+        .se               = this,
+        .compile_count    = compile_count,
+        .applications     = std::move(inc.applications),
+        .num_reused_nodes = inc.num_reused_nodes,
+    };
+    retval.ptp = sfp->add(SILVA_EXPECT_FWD_PLAIN(std::move(nursery).finish_owned()));
+    return retval;
   }
 
   expected_t<parse_tree_ptr_t>
@@ -1009,3 +1934,157 @@ namespace silva::seed {
     return apply(std::move(ff), goal_rule_name);
   }
 }
+
+namespace silva::seed {
+  expected_t<unique_ptr_t<parse_tree_t>>
+  compiled_grammar_t::apply(fragment_span_t fs,
+                            const name_id_t goal_rule_name,
+                            const error_policy_t error_policy) const
+  {
+    SILVA_EXPECT(se->is_compiled, MAJOR, "seed::compiled_grammar_t of uncompiled interpreter_t");
+    const auto* lang_data    = SILVA_EXPECT_FWD(impl::language_data_of(*se, goal_rule_name));
+    const lexicon_t& lexicon = se->bootstrap_interpreter.lexicon();
+    impl::interpreter_apply_nursery_t nursery(fs, lexicon, se, lang_data);
+    if (error_policy == error_policy_t::FURTHEST_FAILURE) {
+      nursery.furthest_failure.emplace();
+    }
+    SILVA_EXPECT_FWD_PLAIN(nursery.run(goal_rule_name));
+    return std::move(nursery).finish_owned();
+  }
+
+  expected_t<unique_ptr_t<parse_tree_t>>
+  compiled_grammar_t::apply(fragment_span_t fs,
+                            const name_id_t goal_rule_name,
+                            parse_session_t& session,
+                            const error_policy_t error_policy) const
+  {
+    SILVA_EXPECT(se->is_compiled, MAJOR, "seed::compiled_grammar_t of uncompiled interpreter_t");
+    const auto* lang_data    = SILVA_EXPECT_FWD(impl::language_data_of(*se, goal_rule_name));
+    const lexicon_t& lexicon = se->bootstrap_interpreter.lexicon();
+    impl::interpreter_apply_nursery_t nursery(fs, lexicon, se, lang_data);
+    if (error_policy == error_policy_t::FURTHEST_FAILURE) {
+      nursery.furthest_failure.emplace();
+    }
+    nursery.heap_stack = &session.heap_stack;
+    nursery.tree       = std::move(session.tree);
+    nursery.tree.clear();
+    // If parsing fails, the buffer is still in the nursery.
+    scope_exit_t session_exit([&] {
+      if (nursery.tree.capacity() > session.tree.capacity()) {
+        session.tree = std::move(nursery.tree);
+      }
+    });
+    SILVA_EXPECT_FWD_PLAIN(nursery.run(goal_rule_name));
+    auto pt = SILVA_EXPECT_FWD_PLAIN(std::move(nursery).finish_owned());
+    array_t<parse_tree_node_t> nodes(pt->nodes.begin(), pt->nodes.end());
+    session.tree = std::exchange(pt->nodes, std::move(nodes));
+    return pt;
+  }
+
+  expected_t<unique_ptr_t<parse_tree_t>>
+  compiled_grammar_t::apply_parallel(fragment_span_t fs,
+                                     const name_id_t goal_rule_name,
+                                     const parallel_options_t& options) const
+  {
+    SILVA_EXPECT(se->is_compiled, MAJOR, "seed::compiled_grammar_t of uncompiled interpreter_t");
+    const auto* lang_data = SILVA_EXPECT_FWD(impl::language_data_of(*se, goal_rule_name));
+    // Chunks are neither profiled nor traced.
+    const bool do_profile = SILVA_ENV_CONTEXT_AS("SEED_PROFILE", bool, false);
+    const bool do_trace   = SILVA_ENV_CONTEXT_AS("SEED_EXEC_TRACE", bool, false);
+    if (options.num_threads <= 1 || !impl::is_repetition_rule(*se, goal_rule_name) ||
+        fs.end - fs.begin < 2 || do_profile || do_trace) {
+      return apply(std::move(fs), goal_rule_name);
+    }
+    const index_t num_fragments       = fs.end - fs.begin;
+    const index_t min_chunk_fragments = std::max(options.min_chunk_fragments,
+                                                 num_fragments / (4 * options.num_threads));
+    const array_t<index_t> bounds     = impl::chunk_bounds(fs, min_chunk_fragments);
+    array_t<impl::parallel_chunk_t> chunks;
+    for (index_t i = 0; i + 1 < index_t(bounds.size()); ++i) {
+      chunks.push_back(impl::parallel_chunk_t{.begin = bounds[i], .end = bounds[i + 1]});
+    }
+
+    // Chunks that couldn't be parsed on their own are merged with their neighbour and parsed
+    // again, until either all chunks are parsed or only a single chunk is left. Open-ended chunks
+    // are merged with the next one, where their last item might continue.
+    impl::task_contexts_t task_contexts;
+    impl::heap_stack_pool_t heap_stack_pool;
+    while (chunks.size() >= 2) {
+      array_t<impl::parallel_chunk_t*> todo;
+      for (auto& chunk: chunks) {
+        if (!chunk.is_parsed) {
+          todo.push_back(&chunk);
+        }
+      }
+      if (todo.empty()) {
+        break;
+      }
+      parallel_for(todo.size(), options.num_threads, [&](const index_t i) {
+        task_contexts.run([&] {
+          impl::parse_chunk(*se, fs, lang_data, goal_rule_name, heap_stack_pool, *todo[i]);
+        });
+      });
+      array_t<impl::parallel_chunk_t> merged;
+      for (index_t i = 0; i < index_t(chunks.size()); ++i) {
+        impl::parallel_chunk_t& chunk = chunks[i];
+        if (chunk.is_parsed) {
+          merged.push_back(std::move(chunk));
+        }
+        else if (chunk.is_open_ended && i + 1 < index_t(chunks.size())) {
+          chunks[i + 1].begin     = chunk.begin;
+          chunks[i + 1].is_parsed = false;
+          chunks[i + 1].nodes.clear();
+        }
+        else if (!merged.empty()) {
+          merged.back().end       = chunk.end;
+          merged.back().is_parsed = false;
+          merged.back().nodes.clear();
+        }
+        else if (i + 1 < index_t(chunks.size())) {
+          chunks[i + 1].begin     = chunk.begin;
+          chunks[i + 1].is_parsed = false;
+          chunks[i + 1].nodes.clear();
+        }
+        else {
+          merged.push_back(std::move(chunk));
+        }
+      }
+      chunks = std::move(merged);
+    }
+    if (chunks.size() < 2) {
+      return apply(std::move(fs), goal_rule_name);
+    }
+
+    // Each chunk's tree consists of a node for the goal-rule with the items as children.
+    array_t<parse_tree_node_t> nodes;
+    nodes.push_back(chunks.front().nodes.front());
+    nodes.front().num_children = 0;
+    for (const auto& chunk: chunks) {
+      const parse_tree_node_t& chunk_root = chunk.nodes.front();
+      SILVA_EXPECT(chunk_root.rule_name == goal_rule_name &&
+                       chunk_root.subtree_size == index_t(chunk.nodes.size()),
+                   ASSERT);
+      nodes.front().num_children += chunk_root.num_children;
+      nodes.insert(nodes.end(), chunk.nodes.begin() + 1, chunk.nodes.end());
+    }
+    nodes.front().subtree_size = nodes.size();
+    nodes.front().fragment_end = chunks.back().nodes.front().fragment_end;
+    return std::make_unique<parse_tree_t>(parse_tree_t{
+        .fp    = fs.fp,
+        .nodes = std::move(nodes),
+    });
+  }
+
+  expected_t<void> compiled_grammar_t::apply_events(fragment_span_t fs,
+                                                    const name_id_t goal_rule_name,
+                                                    parse_event_consumer_t* consumer) const
+  {
+    SILVA_EXPECT(se->is_compiled, MAJOR, "seed::compiled_grammar_t of uncompiled interpreter_t");
+    const auto* lang_data    = SILVA_EXPECT_FWD(impl::language_data_of(*se, goal_rule_name));
+    const lexicon_t& lexicon = se->bootstrap_interpreter.lexicon();
+    impl::interpreter_apply_nursery_t nursery(fs, lexicon, se, lang_data);
+    nursery.consumer = consumer;
+    SILVA_EXPECT_FWD_PLAIN(nursery.run(goal_rule_name));
+    return {};
+  }
+}
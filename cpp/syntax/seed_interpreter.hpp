@@ -2,8 +2,135 @@
 
 #include "seed.hpp"
 #include "seed_axe.hpp"
+#include "seed_profile.hpp"
+
+#include "canopy/heap_stack.hpp"
+#include "canopy/parallel.hpp"
 
 namespace silva::seed {
+  // Receives the result of interpreter_t::apply_events() as a stream of events, in the order in
+  // which the corresponding nodes would appear in the parse_tree_t. Nodes of twig-rules (and
+  // literal nodes) are reported as a single token event, covering their whole subtree. Other nodes
+  // are reported by an enter and an exit event with their children in between. Events are only
+  // delivered once the interpreter has committed to them, i.e., no event is ever retracted because
+  // of backtracking. Any error returned by the consumer aborts the parse.
+  struct parse_event_consumer_t {
+    virtual ~parse_event_consumer_t() = default;
+
+    virtual expected_t<void> on_rule_enter(name_id_t rule_name, index_t fragment_begin) = 0;
+    virtual expected_t<void>
+    on_rule_exit(name_id_t rule_name, index_t fragment_begin, index_t fragment_end) = 0;
+    virtual expected_t<void>
+    on_token(name_id_t rule_name, index_t fragment_begin, index_t fragment_end) = 0;
+  };
+
+  struct compiled_grammar_t;
+  struct interpreter_t;
+
+  // A section of a document in an embedded language (e.g., delimited by « and »), see
+  // interpreter_t::apply_sections().
+  struct section_t {
+    // The "language" node in the parse-tree of the enclosing section or of the document.
+    parse_tree_span_t pts_language;
+
+    // Index of the enclosing section in "document_t::sections", or -1 if there is none.
+    index_t parent = -1;
+
+    name_id_t goal_rule_name;
+    parse_tree_ptr_t ptp;
+  };
+
+  struct document_t {
+    parse_tree_ptr_t ptp;
+
+    // All parsed sections in the order in which they appear in the document. Sections always come
+    // after their enclosing section.
+    array_t<section_t> sections;
+  };
+
+  // Given a "language" node and its parent, returns the goal-rule for parsing the section, or the
+  // invalid name_id_t to leave the section alone. Is called concurrently, so it may not modify the
+  // syntax_farm_t (e.g., by using name_id_of()).
+  using section_goal_rule_t = function_t<name_id_t(const parse_tree_span_t& pts_parent,
+                                                   const parse_tree_span_t& pts_language)>;
+
+  // One successful application of a rule at the top-level of a parse (i.e., not inside a
+  // twig-rule or a seed-axe), see incremental_parse_t.
+  struct rule_application_t {
+    name_id_t rule_name;
+
+    // Twig-rules depend on these flags of the rule in which they are used.
+    bool is_literal_nodes = false;
+    bool is_no_whitespace = false;
+
+    // The fragments [fragment_begin, fragment_end) were consumed, including the ones skipped at the
+    // end. Only the fragments before "lookahead_end" were looked at.
+    index_t fragment_begin = 0;
+    index_t fragment_end   = 0;
+    index_t lookahead_end  = 0;
+
+    // The nodes [node_begin, node_end) of the parse-tree were created by this application and
+    // "proto_node" was returned to the enclosing rule.
+    index_t node_begin = 0;
+    index_t node_end   = 0;
+    parse_tree_node_t proto_node;
+
+    // The application also returned the error that ended its last repetition. That error only
+    // explains failures of the enclosing rules and isn't kept, so such applications are parsed
+    // again instead of being reused.
+    bool has_last_error = false;
+
+    // The applications nested in this one are the ones from this index up to this one.
+    index_t nested_begin = 0;
+  };
+
+  // Result of interpreter_t::apply_incremental(). Besides the parse-tree it has all rule
+  // applications whose nodes are part of it, so that the sub-trees that an edit of the text doesn't
+  // affect can be reused by the next apply_incremental().
+  struct incremental_parse_t {
+    parse_tree_ptr_t ptp;
+    name_id_t goal_rule_name;
+
+    // The interpreter_t that produced this parse, and its "compile_count" at the time.
+    const interpreter_t* se = nullptr;
+    index_t compile_count   = 0;
+
+    array_t<rule_application_t> applications;
+
+    // Number of nodes that were copied from the previous parse instead of being parsed again.
+    index_t num_reused_nodes = 0;
+  };
+
+  // How interpreter_t::apply() reports that it couldn't parse its input.
+  enum class error_policy_t {
+    // The full tree of the errors of all alternatives that were tried.
+    ERROR_TREE,
+
+    // Only the furthest fragment at which a terminal (or a twig-rule) failed, together with all
+    // terminals expected there. Nothing is recorded in the error_context_t while parsing.
+    FURTHEST_FAILURE,
+  };
+
+  // Buffers that each parse needs, kept across the parses of a thread so that parsing many small
+  // documents doesn't allocate them anew every time. Error storage needs no such treatment, as it
+  // already lives in the (persistent) error_context_t of the calling thread. A parse_session_t may
+  // only be used by one parse at a time.
+  struct parse_session_t {
+    // Nodes of the parse-tree under construction. Its capacity grows to that of the largest parse
+    // so far; each finished parse-tree is handed out as a right-sized copy.
+    array_t<parse_tree_node_t> tree;
+
+    // The recursive descent runs on this (see SEED_STACK_BUDGET).
+    heap_stack_t heap_stack;
+  };
+
+  struct parallel_options_t {
+    index_t num_threads = parallel_default_num_threads();
+
+    // Items are grouped into chunks of at least this many fragments.
+    index_t min_chunk_fragments = 4096;
+  };
+
   // Driver for a program in the Seed language.
   struct interpreter_t {
     syntax_farm_ptr_t sfp;
@@ -11,12 +138,16 @@ namespace silva::seed {
 
     struct rule_expr_data_t {
       parse_tree_span_t expr;
+
+      // What is actually applied for "expr" (see seed_optimizer.hpp). Set by compile().
+      parse_tree_span_t expr_compiled;
+
       bool is_twig_rule     = false;
       bool is_no_node       = false;
       bool is_no_whitespace = false;
       bool is_literal_nodes = false;
     };
-    hash_map_t<name_id_t, rule_expr_data_t> rule_exprs;
+    flat_hash_map_t<name_id_t, rule_expr_data_t> rule_exprs;
 
     // Maps the rule-name of a seed-axe to the corresponding seed-axe.
     hash_map_t<name_id_t, axe_t> axes;
@@ -42,12 +173,97 @@ namespace silva::seed {
     expected_t<void> compile();
     bool is_compiled = false;
 
+    // Incremented by each compile(), so that results of different compilations can be told apart.
+    index_t compile_count = 0;
+
+    // Compiles the interpreter (if necessary) and returns a compiled_grammar_t for it.
+    expected_t<compiled_grammar_t> compiled();
+
+    // Token of each fragment_category_t, so that applying the interpreter doesn't have to add them
+    // to the syntax_farm_t.
+    hash_map_t<fragment_category_t, token_id_t> fragment_category_tokens;
+
     // For each node-index that is a "_.Seed.Nonterminal", gives the full name of the rule that this
     // nonterminal references, taking into account the relative scope in which the rule was
     // encountered.
-    hash_set_t<name_id_ref_t> resolved_names;
+    flat_hash_set_t<name_id_ref_t> resolved_names;
 
-    expected_t<parse_tree_ptr_t> apply(fragment_span_t, name_id_t goal_rule_name);
+    expected_t<parse_tree_ptr_t> apply(fragment_span_t,
+                                       name_id_t goal_rule_name,
+                                       error_policy_t = error_policy_t::ERROR_TREE);
+    expected_t<parse_tree_ptr_t> apply(fragment_span_t,
+                                       name_id_t goal_rule_name,
+                                       parse_session_t&,
+                                       error_policy_t = error_policy_t::ERROR_TREE);
     expected_t<parse_tree_ptr_t> apply_text(filepath_t, string_t, name_id_t goal_rule_name);
+
+    // Like apply(), but for a goal-rule of the form "X *" the fragments are split into chunks of
+    // items that are parsed concurrently (see compiled_grammar_t::apply_parallel()).
+    expected_t<parse_tree_ptr_t>
+    apply_parallel(fragment_span_t, name_id_t goal_rule_name, const parallel_options_t& = {});
+
+    // Parses all sections of an already parsed document concurrently, including the sections
+    // nested in other sections, which are spawned as tasks of a task_group_t as soon as their
+    // enclosing section has been parsed. If any section fails to parse, the error of the first one
+    // in document order is returned. The tasks see the env-context of the caller, and their
+    // profiles are merged into the caller's profile_context_t. With SEED_EXEC_TRACE, the sections
+    // are parsed one after another.
+    expected_t<document_t> apply_sections(parse_tree_ptr_t document,
+                                          const section_goal_rule_t&,
+                                          index_t num_threads = parallel_default_num_threads());
+
+    // Like apply(), but also records the rule applications of the parse. If given the result of a
+    // previous parse of an earlier version of the text, the first and the last fragments that
+    // differ between the two fragmentizations delimit the damaged region. The sub-trees of all
+    // previous rule applications that start after it, or that start and look ahead only before it,
+    // are copied instead of being parsed again, so that only the rules enclosing the edit are
+    // actually applied. The resulting parse-tree is always the same as that of apply().
+    expected_t<incremental_parse_t> apply_incremental(fragmentization_ptr_t,
+                                                      name_id_t goal_rule_name,
+                                                      const incremental_parse_t* = nullptr);
+
+    // Like apply(), but streams the parse-tree into the given consumer instead of materializing
+    // it. Only the nodes that may still be backtracked are buffered, so for grammars like "⊙ = X *"
+    // memory use is proportional to the nesting depth rather than the size of the input. If
+    // parsing fails, the consumer may already have received the events for a prefix of the input.
+    expected_t<void>
+    apply_events(fragment_span_t, name_id_t goal_rule_name, parse_event_consumer_t*);
+  };
+
+  // Read-only handle to a compiled interpreter_t. Any number of threads may apply it concurrently:
+  // neither the interpreter_t nor its syntax_farm_t is modified, each call uses its own nursery and
+  // the error_context_t of the calling thread, and the resulting parse_tree_t is owned by the
+  // caller instead of being added to the syntax_farm_t. While any thread is using it, nothing may
+  // modify the interpreter_t or the syntax_farm_t (e.g., the fragmentize() of the inputs has to
+  // happen beforehand).
+  struct compiled_grammar_t {
+    const interpreter_t* se = nullptr;
+
+    expected_t<unique_ptr_t<parse_tree_t>>
+    apply(fragment_span_t,
+          name_id_t goal_rule_name,
+          error_policy_t = error_policy_t::ERROR_TREE) const;
+
+    // Like apply(), but with the buffers of the given session instead of freshly allocated ones.
+    expected_t<unique_ptr_t<parse_tree_t>>
+    apply(fragment_span_t,
+          name_id_t goal_rule_name,
+          parse_session_t&,
+          error_policy_t = error_policy_t::ERROR_TREE) const;
+
+    // Guesses where the items of a goal-rule "X *" start from the bracket structure of the input
+    // (after each ';' or '}' outside of any parentheses) and parses chunks of items concurrently,
+    // each in its own nursery. The resulting sub-trees are spliced together in order. A chunk that
+    // can't be parsed on its own (or doesn't end exactly where the next one starts) is merged with
+    // its neighbour and parsed again, falling back to apply() once only one chunk is left, which
+    // also gives the same errors as apply(). The same happens to a chunk whose items looked at the
+    // fragments after it, as its last item might have continued there (e.g., with an "else"); the
+    // chunk is then merged with the next one. Goal-rules of any other form, and all parses with
+    // SEED_PROFILE or SEED_EXEC_TRACE, are done by apply().
+    expected_t<unique_ptr_t<parse_tree_t>> apply_parallel(fragment_span_t,
+                                                          name_id_t goal_rule_name,
+                                                          const parallel_options_t& = {}) const;
+    expected_t<void>
+    apply_events(fragment_span_t, name_id_t goal_rule_name, parse_event_consumer_t*) const;
   };
 }
@@ -3,6 +3,9 @@
 #include "fragmentization.hpp"
 #include "syntax.hpp"
 
+#include "canopy/env_context.hpp"
+#include "canopy/time.hpp"
+
 #include <catch2/catch_all.hpp>
 
 namespace silva::seed::test {
@@ -206,6 +209,102 @@ language Testor:
     CHECK(result == expected.substr(1));
   }
 
+  TEST_CASE("apply-furthest-failure", "[seed-interpreter][seed::compiled_grammar_t]")
+  {
+    using enum error_policy_t;
+    const string_view_t valuer_seed = R"'(
+language Valuer:
+  ⊙ = Assign *
+  skip = skip.freeForm
+  Assign = identifier '=' Value ';'
+  Value = identifier | 'nil' | '(' Value ')'
+)'";
+    syntax_farm_t sf;
+    auto se = standard_seed_interpreter(sf.ptr());
+    SILVA_REQUIRE(se->add_seed_text("valuer.seed", string_t{valuer_seed}));
+    const compiled_grammar_t cg = SILVA_REQUIRE(se->compiled());
+    const name_id_t goal        = sf.name_id_of("Valuer");
+
+    const auto fp     = SILVA_REQUIRE(fragmentize(sf.ptr(), "good.src", "x = (a);
+y = nil;
+"));
+    const auto bad_fp = SILVA_REQUIRE(fragmentize(sf.ptr(), "bad.src", "x = (a);
+y = ;
+z = a;
+"));
+
+    index_t error_tree_capacity = 0;
+    unique_ptr_t<parse_tree_t> expected;
+    {
+      error_context_t error_context;
+      expected            = SILVA_REQUIRE(cg.apply(fp, goal, ERROR_TREE));
+      error_tree_capacity = error_context.tree.nodes.capacity();
+    }
+    {
+      // Only the lookups of unset environment variables leave a trace.
+      error_context_t error_context;
+      const auto pt = SILVA_REQUIRE(cg.apply(fp, goal, FURTHEST_FAILURE));
+      CHECK(pt->nodes == expected->nodes);
+      CHECK(index_t(error_context.tree.nodes.capacity()) <= 4);
+      CHECK(index_t(error_context.tree.nodes.capacity()) < error_tree_capacity);
+    }
+    {
+      // The parse gets furthest at the ';' of the second line, where all alternatives of "Value"
+      // fail. That the second "Assign" failed as a whole isn't reported, nor is anything deeper
+      // inside the twig-rule "identifier".
+      error_context_t error_context;
+      auto result = cg.apply(bad_fp, goal, FURTHEST_FAILURE);
+      REQUIRE(!result.has_value());
+      CHECK(result.error().level == error_level_t::MINOR);
+      CHECK(error_context.tree.nodes.size() == 1);
+      CHECK(result.error().to_string_plain().as_string() ==
+            "[bad.src:2:5] expected one of: identifier, token[ nil ], token[ ( ]\n");
+    }
+    CHECK(!cg.apply(bad_fp, goal).has_value());
+  }
+
+  TEST_CASE("apply-parallel", "[seed-interpreter][seed::compiled_grammar_t]")
+  {
+    // The chunks of apply_parallel() start after ';' and '}', but an "If" or a "Try" continues
+    // after them with an "Else" or a "Catch". As these also parse as items on their own, cutting
+    // there would give a different parse-tree rather than an error.
+    const string_view_t guard_seed = R"'(
+language Guard:
+  ⊙ = Stmt *
+  skip = skip.freeForm
+  Stmt = If | Try | Else | Catch | Simple
+  If = 'if' identifier Stmt Else ?
+  Else = 'else' Stmt
+  Try = 'try' Block Catch ?
+  Catch = 'catch' Block
+  Block = '{' Stmt * '}'
+  Simple = identifier ';'
+)'";
+    syntax_farm_t sf;
+    auto se = standard_seed_interpreter(sf.ptr());
+    SILVA_REQUIRE(se->add_seed_text("guard.seed", string_t{guard_seed}));
+    const name_id_t goal = sf.name_id_of("Guard");
+
+    string_t text;
+    for (index_t i = 0; i < 100; ++i) {
+      text += fmt::format("if a{0} b; else c;\ntry {{ d; }} catch {{ e; }}\nf{0};\n", i);
+    }
+    const auto fp       = SILVA_REQUIRE(fragmentize(sf.ptr(), "guard.src", text));
+    const auto expected = SILVA_REQUIRE(se->apply(fp, goal));
+    CHECK(expected->span().num_children() == 300);
+    for (const index_t num_threads: {2, 8}) {
+      for (const index_t min_chunk_fragments: {1, 16}) {
+        INFO(num_threads << " threads, " << min_chunk_fragments << " fragments");
+        const parallel_options_t options{
+            .num_threads         = num_threads,
+            .min_chunk_fragments = min_chunk_fragments,
+        };
+        const auto pt = SILVA_REQUIRE(se->apply_parallel(fp, goal, options));
+        CHECK(pt->nodes == expected->nodes);
+      }
+    }
+  }
+
   TEST_CASE("multiple-texts", "[seed-interpreter]")
   {
     const string_view_t text1_seed = R"'(
@@ -237,4 +336,205 @@ Bar:
     const string_t result_str{SILVA_REQUIRE(pt->span().to_string())};
     CHECK(result_str == expected.substr(1));
   }
+
+  TEST_CASE("deep-nesting", "[seed-interpreter]")
+  {
+    const string_view_t nest_seed = R"'(
+language Nest:
+  ⊙ = Item
+  skip = ( SPACE | LINEFEED | COMMENT | WHITESPACE | INDENT | DEDENT | NEWLINE ) *
+  Item = '(' Item ')' | 'x'
+)'";
+    syntax_farm_t sf;
+    interpreter_t se(sf.ptr());
+    SILVA_REQUIRE(se.add_seed_text("nest.seed", string_t{nest_seed}));
+
+    const index_t depth = 2'000;
+    string_t text;
+    for (index_t i = 0; i < depth; ++i) {
+      text += '(';
+    }
+    text += 'x';
+    for (index_t i = 0; i < depth; ++i) {
+      text += ')';
+    }
+    text += '\n';
+
+    {
+      const auto pt = SILVA_REQUIRE(se.apply_text("", text, sf.name_id_of("Nest")));
+      CHECK(pt->nodes.size() == depth + 2);
+    }
+    {
+      env_context_t env_context;
+      env_context.variables["SEED_STACK_BUDGET"_sov] = "1000000"_sov;
+      const auto result = se.apply_text("", text, sf.name_id_of("Nest"));
+      REQUIRE(!result.has_value());
+      CHECK(result.error().level == error_level_t::FATAL);
+    }
+  }
+
+  TEST_CASE("deep-nesting-performance", "[seed-interpreter][.]")
+  {
+    // The same number of "Item"s, once nested as deeply as possible and once side by side. Every
+    // level of nesting is a native call frame on the heap-stack (see run_goal_rule()), so if
+    // recursion itself was the cost, the deep text would take longer per node than the flat one.
+    const string_view_t nest_seed = R"'(
+language Nest:
+  ⊙ = Item *
+  skip = ( SPACE | LINEFEED | COMMENT | WHITESPACE | INDENT | DEDENT | NEWLINE ) *
+  Item = '(' Item ')' | 'x'
+)'";
+    syntax_farm_t sf;
+    interpreter_t se(sf.ptr());
+    SILVA_REQUIRE(se.add_seed_text("nest.seed", string_t{nest_seed}));
+    const name_id_t goal = sf.name_id_of("Nest");
+
+    constexpr index_t num_items = 20'000;
+    string_t text_deep;
+    for (index_t i = 0; i + 1 < num_items; ++i) {
+      text_deep += '(';
+    }
+    text_deep += 'x';
+    for (index_t i = 0; i + 1 < num_items; ++i) {
+      text_deep += ')';
+    }
+    text_deep += '\n';
+    string_t text_flat;
+    for (index_t i = 0; i < num_items / 2; ++i) {
+      text_flat += "(x)\n";
+    }
+
+    env_context_t env_context;
+    env_context.variables["SEED_STACK_BUDGET"_sov] = "1073741824"_sov;
+    parse_session_t session;
+    for (const auto& [name, text]: array_t<pair_t<string_view_t, string_view_t>>{
+             {"deep", text_deep},
+             {"flat", text_flat},
+         }) {
+      constexpr index_t num_repetitions = 20;
+      const auto fp     = SILVA_REQUIRE(fragmentize(sf.ptr(), "", string_t{text}));
+      index_t num_nodes = 0;
+      const auto start  = time_point_t::now();
+      for (index_t i = 0; i < num_repetitions; ++i) {
+        const auto pt = SILVA_REQUIRE(se.apply(fp, goal, session));
+        num_nodes     = pt->nodes.size();
+      }
+      const auto took = time_point_t::now() - start;
+      fmt::println("{}: {} nodes, {} fragments, {} per parse, {:.1f} ns per node",
+                   name,
+                   num_nodes,
+                   fp->fragments.size(),
+                   time_span_t{took.nanos / num_repetitions},
+                   double(took.nanos) / double(num_repetitions * num_nodes));
+    }
+  }
+
+  namespace {
+    struct event_log_t : public parse_event_consumer_t {
+      string_t log;
+
+      expected_t<void> on_rule_enter(const name_id_t rule_name, const index_t fragment_begin) override
+      {
+        log += fmt::format("enter {} {}\n", rule_name.val, fragment_begin);
+        return {};
+      }
+      expected_t<void> on_rule_exit(const name_id_t rule_name,
+                                    const index_t fragment_begin,
+                                    const index_t fragment_end) override
+      {
+        log += fmt::format("exit {} {} {}\n", rule_name.val, fragment_begin, fragment_end);
+        return {};
+      }
+      expected_t<void> on_token(const name_id_t rule_name,
+                                const index_t fragment_begin,
+                                const index_t fragment_end) override
+      {
+        log += fmt::format("token {} {} {}\n", rule_name.val, fragment_begin, fragment_end);
+        return {};
+      }
+    };
+
+    string_t event_log_of(const parse_tree_t& pt)
+    {
+      event_log_t retval;
+      array_t<const parse_tree_node_t*> open_nodes;
+      const auto exit_until = [&](const index_t node_index) {
+        while (!open_nodes.empty() &&
+               (open_nodes.back() - pt.nodes.data()) + open_nodes.back()->subtree_size <=
+                   node_index) {
+          const auto* node = open_nodes.back();
+          SILVA_REQUIRE(
+              retval.on_rule_exit(node->rule_name, node->fragment_begin, node->fragment_end));
+          open_nodes.pop_back();
+        }
+      };
+      index_t node_index = 0;
+      while (node_index < index_t(pt.nodes.size())) {
+        exit_until(node_index);
+        const auto& node = pt.nodes[node_index];
+        if (node.allow_token) {
+          SILVA_REQUIRE(retval.on_token(node.rule_name, node.fragment_begin, node.fragment_end));
+          node_index += node.subtree_size;
+        }
+        else {
+          SILVA_REQUIRE(retval.on_rule_enter(node.rule_name, node.fragment_begin));
+          open_nodes.push_back(&node);
+          node_index += 1;
+        }
+      }
+      exit_until(node_index);
+      return std::move(retval.log);
+    }
+  }
+
+  TEST_CASE("apply-events", "[seed-interpreter]")
+  {
+    const string_view_t lang_seed = R"'(
+language Frog:
+  ⊙ = Rule *
+  skip = ( SPACE | LINEFEED | COMMENT | WHITESPACE | INDENT | DEDENT | NEWLINE ) *
+  identifier = ID_START ID_CONTINUE *
+  number = DIGIT +
+  Rule = RuleName Expr
+  RuleName = no_node Keyword
+  Expr = Primary + Calc ?
+  Primary = not Keyword but_then identifier
+  Keyword:
+    ⊙ = 'keyword1' | 'keyword2' | 'keyword3'
+  Calc = '=' Value
+  Value = axe Atom operator
+    Add = ltr infix '+'
+    Mult = ltr infix '*'
+  Atom = number | identifier | '(' Value ')'
+  operator = OPERATOR
+)'";
+    syntax_farm_t sf;
+    interpreter_t se(sf.ptr());
+    SILVA_REQUIRE(se.add_seed_text("frog.seed", string_t{lang_seed}));
+
+    const string_view_t chunk = R"'(
+    keyword1 a b c = 1 + 2 * ( x + 3 )
+    keyword2 d e
+    keyword1 f = g
+    keyword3 g h i
+)'";
+    for (const index_t repetitions: {1, 1000}) {
+      string_t text;
+      for (index_t i = 0; i < repetitions; ++i) {
+        text += chunk;
+      }
+      const auto fp = SILVA_REQUIRE(fragmentize(sf.ptr(), "frog.txt", std::move(text)));
+      const auto pt = SILVA_REQUIRE(se.apply(fp, sf.name_id_of("Frog")));
+      event_log_t event_log;
+      SILVA_REQUIRE(se.apply_events(fp, sf.name_id_of("Frog"), &event_log));
+      CHECK(event_log.log == event_log_of(*pt));
+    }
+
+    {
+      const auto fp = SILVA_REQUIRE(fragmentize(sf.ptr(), "frog.txt", "keyword1 a keyword2\n"));
+      CHECK(!se.apply(fp, sf.name_id_of("Frog")).has_value());
+      event_log_t event_log;
+      CHECK(!se.apply_events(fp, sf.name_id_of("Frog"), &event_log).has_value());
+    }
+  }
 }
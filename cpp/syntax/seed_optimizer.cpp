@@ -0,0 +1,377 @@
+#include "seed_optimizer.hpp"
+
+#include <algorithm>
+
+using enum silva::error_level_t;
+
+namespace silva::seed::impl {
+  namespace {
+    struct rule_optimizer_t {
+      interpreter_t& se;
+      const lexicon_t& lexicon;
+      const optimizer_options_t& options;
+      const interpreter_t::rule_expr_data_t& host;
+
+      array_t<parse_tree_node_t> nodes;
+
+      // Node-indexes of the Nonterminals in "nodes" together with the name they resolve to.
+      array_t<pair_t<index_t, name_id_t>> nonterminals;
+
+      // Rules whose expressions are currently being inlined (starting with the optimized rule).
+      array_t<name_id_t> inline_stack;
+
+      bool changed = false;
+
+      struct alternative_t {
+        // The alternative as it appears in the original Or-expression.
+        parse_tree_span_t pts;
+
+        // Items of the concatenation (or just "pts" itself if it isn't a concatenation).
+        array_t<parse_tree_span_t> items;
+
+        // If the leading items of "pts" have been factored out of this alternative.
+        bool is_remainder = false;
+      };
+
+      bool is_concat(const parse_tree_span_t& pts) const
+      {
+        return se.sfp->name_id_is_parent(lexicon.ni_expr_concat, pts.rule_name());
+      }
+
+      // Leading string-terminals of concatenations make all later errors in that concatenation
+      // non-backtrackable (see "s_expr_concat"), so they need special care.
+      bool is_string_terminal(const parse_tree_span_t& pts) const
+      {
+        return pts.rule_name() == lexicon.ni_term && pts.num_children() == 1 &&
+            pts.node_at(1).rule_name == lexicon.ni_string;
+      }
+
+      expected_t<name_id_t> resolved_name(const parse_tree_span_t& pts_nt) const
+      {
+        const auto it = se.resolved_names.find(name_id_ref_t{pts_nt});
+        SILVA_EXPECT(it != se.resolved_names.end(), MAJOR, "{} couldn't lookup nonterminal", pts_nt);
+        return it->resolved_name;
+      }
+
+      bool is_equal(const parse_tree_span_t& lhs, const parse_tree_span_t& rhs) const
+      {
+        if (lhs.subtree_size() != rhs.subtree_size()) {
+          return false;
+        }
+        for (index_t i = 0; i < lhs.subtree_size(); ++i) {
+          const parse_tree_node_t& lhs_node = lhs.node_at(i);
+          const parse_tree_node_t& rhs_node = rhs.node_at(i);
+          if (lhs_node.rule_name != rhs_node.rule_name ||
+              lhs_node.num_children != rhs_node.num_children ||
+              lhs_node.allow_token != rhs_node.allow_token) {
+            return false;
+          }
+          if (lhs_node.rule_name == lexicon.ni_nt) {
+            const auto lhs_name = resolved_name(lhs.subspan_at(i));
+            const auto rhs_name = resolved_name(rhs.subspan_at(i));
+            if (!lhs_name || !rhs_name || *lhs_name != *rhs_name) {
+              return false;
+            }
+          }
+          if (lhs_node.allow_token) {
+            const auto lhs_token = lhs.subspan_at(i).token();
+            const auto rhs_token = rhs.subspan_at(i).token();
+            if (!lhs_token || !rhs_token || *lhs_token != *rhs_token) {
+              return false;
+            }
+          }
+        }
+        return true;
+      }
+
+      const interpreter_t::rule_expr_data_t* inline_candidate(const name_id_t rule_name) const
+      {
+        if (index_t(inline_stack.size()) > options.inline_max_depth ||
+            std::ranges::find(inline_stack, rule_name) != inline_stack.end()) {
+          return nullptr;
+        }
+        const auto it = se.rule_exprs.find(rule_name);
+        if (it == se.rule_exprs.end()) {
+          return nullptr;
+        }
+        const interpreter_t::rule_expr_data_t& rule_data = it->second;
+        if (!rule_data.is_no_node || rule_data.is_twig_rule ||
+            rule_data.is_no_whitespace != host.is_no_whitespace ||
+            rule_data.is_literal_nodes != host.is_literal_nodes) {
+          return nullptr;
+        }
+        const parse_tree_span_t& expr = rule_data.expr;
+        if (expr.ptp.is_nullptr() || expr.ptp->fp != host.expr.ptp->fp ||
+            expr.rule_name() != lexicon.ni_expr || expr.subtree_size() > options.inline_max_nodes) {
+          return nullptr;
+        }
+        return &rule_data;
+      }
+
+      index_t begin_node(parse_tree_node_t node)
+      {
+        const index_t retval = nodes.size();
+        node.num_children    = 0;
+        node.subtree_size    = 1;
+        nodes.push_back(node);
+        return retval;
+      }
+
+      void end_node(const index_t node_index)
+      {
+        nodes[node_index].subtree_size = index_t(nodes.size()) - node_index;
+      }
+
+      expected_t<void> copy_subtree(const parse_tree_span_t& pts)
+      {
+        const index_t offset = nodes.size();
+        for (index_t i = 0; i < pts.subtree_size(); ++i) {
+          nodes.push_back(pts.node_at(i));
+          if (pts.node_at(i).rule_name == lexicon.ni_nt) {
+            const name_id_t name = SILVA_EXPECT_FWD(resolved_name(pts.subspan_at(i)));
+            nonterminals.emplace_back(offset + i, name);
+          }
+        }
+        return {};
+      }
+
+      // Each call of "emit" adds exactly one sub-tree to "nodes".
+      expected_t<void> emit(const parse_tree_span_t& pts, const bool in_concat)
+      {
+        const name_id_t name = pts.rule_name();
+        if (name == lexicon.ni_expr) {
+          const auto [pts_child] = SILVA_EXPECT_FWD(pts.get_children<1>());
+          if (in_concat && is_string_terminal(pts_child)) {
+            return emit_children(pts, false);
+          }
+          changed = true;
+          return emit(pts_child, in_concat);
+        }
+        else if (name == lexicon.ni_nt) {
+          const name_id_t rule_name                     = SILVA_EXPECT_FWD(resolved_name(pts));
+          const interpreter_t::rule_expr_data_t* inlined = inline_candidate(rule_name);
+          if (inlined == nullptr) {
+            return copy_subtree(pts);
+          }
+          changed = true;
+          inline_stack.push_back(rule_name);
+          SILVA_EXPECT_FWD(emit(inlined->expr, in_concat));
+          inline_stack.pop_back();
+          return {};
+        }
+        else if (is_concat(pts)) {
+          return emit_children(pts, true);
+        }
+        else if (se.sfp->name_id_is_parent(lexicon.ni_expr_or, name)) {
+          array_t<alternative_t> alternatives;
+          for (const auto pts_child: pts.children_range()) {
+            if (pts_child.rule_name() == lexicon.ni_oper) {
+              continue;
+            }
+            alternative_t alt{.pts = pts_child};
+            if (is_concat(pts_child)) {
+              for (const auto pts_item: pts_child.children_range()) {
+                alt.items.push_back(pts_item);
+              }
+            }
+            else {
+              alt.items.push_back(pts_child);
+            }
+            alternatives.push_back(std::move(alt));
+          }
+          return emit_or(pts.node_at(0), alternatives);
+        }
+        else if (se.sfp->name_id_is_parent(lexicon.ni_expr_prefix, name) ||
+                 se.sfp->name_id_is_parent(lexicon.ni_expr_postfix, name) ||
+                 se.sfp->name_id_is_parent(lexicon.ni_expr_and, name) ||
+                 se.sfp->name_id_is_parent(lexicon.ni_expr_followup, name) ||
+                 name == lexicon.ni_alternation) {
+          return emit_children(pts, false);
+        }
+        else {
+          return copy_subtree(pts);
+        }
+      }
+
+      expected_t<void> emit_children(const parse_tree_span_t& pts, const bool in_concat)
+      {
+        const index_t node_index = begin_node(pts.node_at(0));
+        for (const auto pts_child: pts.children_range()) {
+          SILVA_EXPECT_FWD(emit(pts_child, in_concat));
+          nodes[node_index].num_children += 1;
+        }
+        end_node(node_index);
+        return {};
+      }
+
+      // Emits the items of a concatenation that was created by left-factoring. Such
+      // concatenations must not start with a string-terminal, as that would make errors in the
+      // later items non-backtrackable.
+      expected_t<void> emit_concat_item(const parse_tree_span_t& pts_item, const bool is_first)
+      {
+        if (!is_first || !is_string_terminal(pts_item)) {
+          return emit(pts_item, true);
+        }
+        parse_tree_node_t wrapper  = pts_item.node_at(0);
+        wrapper.rule_name          = lexicon.ni_expr;
+        wrapper.allow_token        = false;
+        const index_t node_index   = begin_node(wrapper);
+        nodes[node_index].num_children = 1;
+        SILVA_EXPECT_FWD(copy_subtree(pts_item));
+        end_node(node_index);
+        return {};
+      }
+
+      expected_t<void> emit_alternative(const alternative_t& alt)
+      {
+        if (!alt.is_remainder) {
+          return emit(alt.pts, false);
+        }
+        if (alt.items.size() == 1) {
+          return emit(alt.items.front(), false);
+        }
+        const index_t node_index = begin_node(alt.pts.node_at(0));
+        for (index_t i = 0; i < index_t(alt.items.size()); ++i) {
+          SILVA_EXPECT_FWD(emit_concat_item(alt.items[i], i == 0));
+          nodes[node_index].num_children += 1;
+        }
+        end_node(node_index);
+        return {};
+      }
+
+      // Alternatives may be factored if they are concatenations whose first item is not a leading
+      // string-terminal (or if that property was already taken care of by an earlier factoring).
+      // For "no_whitespace" rules, the gaps would be checked at different boundaries.
+      bool is_factorable(const alternative_t& alt) const
+      {
+        return !host.is_no_whitespace && alt.items.size() >= 2 &&
+            (alt.is_remainder || !is_string_terminal(alt.items[0]));
+      }
+
+      // Returns the end of the run of alternatives starting at "begin" that share a common prefix
+      // and the length of that prefix. Each alternative keeps at least one item of its own.
+      pair_t<index_t, index_t> factor_run(const span_t<const alternative_t> alts, const index_t begin)
+      {
+        if (!is_factorable(alts[begin])) {
+          return {begin + 1, 0};
+        }
+        index_t end           = begin + 1;
+        index_t prefix_length = index_t(alts[begin].items.size()) - 1;
+        while (end < index_t(alts.size()) && is_factorable(alts[end]) &&
+               is_equal(alts[begin].items[0], alts[end].items[0])) {
+          index_t common = 1;
+          while (common < prefix_length && common + 1 < index_t(alts[end].items.size()) &&
+                 is_equal(alts[begin].items[common], alts[end].items[common])) {
+            common += 1;
+          }
+          prefix_length = common;
+          end += 1;
+        }
+        if (end - begin < 2) {
+          return {begin + 1, 0};
+        }
+        return {end, prefix_length};
+      }
+
+      expected_t<void> emit_or(const parse_tree_node_t& or_node,
+                               const span_t<const alternative_t> alts)
+      {
+        const index_t node_index = begin_node(or_node);
+        index_t begin            = 0;
+        while (begin < index_t(alts.size())) {
+          const auto [end, prefix_length] = factor_run(alts, begin);
+          if (prefix_length == 0) {
+            SILVA_EXPECT_FWD(emit_alternative(alts[begin]));
+          }
+          else {
+            changed = true;
+            SILVA_EXPECT_FWD(emit_factored(or_node, alts.subspan(begin, end - begin), prefix_length));
+          }
+          nodes[node_index].num_children += 1;
+          begin = end;
+        }
+        end_node(node_index);
+        return {};
+      }
+
+      // "A B | A C" becomes "A ( B | C )".
+      expected_t<void> emit_factored(const parse_tree_node_t& or_node,
+                                     const span_t<const alternative_t> alts,
+                                     const index_t prefix_length)
+      {
+        const alternative_t& first = alts.front();
+        const index_t node_index   = begin_node(first.pts.node_at(0));
+        for (index_t i = 0; i < prefix_length; ++i) {
+          SILVA_EXPECT_FWD(emit_concat_item(first.items[i], i == 0));
+          nodes[node_index].num_children += 1;
+        }
+        array_t<alternative_t> remainders;
+        for (const alternative_t& alt: alts) {
+          remainders.push_back(alternative_t{
+              .pts          = alt.pts,
+              .items        = array_t<parse_tree_span_t>(alt.items.begin() + prefix_length,
+                                                  alt.items.end()),
+              .is_remainder = true,
+          });
+        }
+        SILVA_EXPECT_FWD(emit_or(or_node, remainders));
+        nodes[node_index].num_children += 1;
+        end_node(node_index);
+        return {};
+      }
+    };
+  }
+}
+
+namespace silva::seed {
+  expected_t<void> optimize(interpreter_t& se, const optimizer_options_t& options)
+  {
+    const lexicon_t& lexicon = se.bootstrap_interpreter.lexicon();
+    for (auto& [rule_name, rule_data]: se.rule_exprs) {
+      rule_data.expr_compiled      = rule_data.expr;
+      const parse_tree_span_t& pts = rule_data.expr;
+      if (pts.ptp.is_nullptr() || pts.rule_name() == lexicon.ni_axe ||
+          pts.rule_name() == lexicon.ni_axe_level) {
+        continue;
+      }
+      impl::rule_optimizer_t ro{
+          .se           = se,
+          .lexicon      = lexicon,
+          .options      = options,
+          .host         = rule_data,
+          .inline_stack = {rule_name},
+      };
+      SILVA_EXPECT_FWD(ro.emit(pts, false), "while optimizing {}", lexicon.name_id_wrap(rule_name));
+      if (!ro.changed) {
+        continue;
+      }
+      SILVA_EXPECT(ro.nodes.front().subtree_size == index_t(ro.nodes.size()), ASSERT);
+      const parse_tree_ptr_t ptp = se.sfp->add(std::make_unique<parse_tree_t>(parse_tree_t{
+          .fp    = pts.ptp->fp,
+          .nodes = std::move(ro.nodes),
+      }));
+      rule_data.expr_compiled = ptp->span();
+      for (const auto& [node_index, resolved_name]: ro.nonterminals) {
+        const auto [it, inserted] =
+            se.resolved_names.emplace(rule_data.expr_compiled.subspan_at(node_index));
+        SILVA_EXPECT(inserted, ASSERT);
+        it->resolved_name = resolved_name;
+      }
+    }
+
+    for (auto& [_, lang_data]: se.languages) {
+      if (!lang_data.skip_rule_expr.has_value()) {
+        continue;
+      }
+      auto& skip_rule_expr         = lang_data.skip_rule_expr.value();
+      skip_rule_expr.expr_compiled = skip_rule_expr.expr;
+      for (const auto& [_, rule_data]: se.rule_exprs) {
+        if (rule_data.expr == skip_rule_expr.expr) {
+          skip_rule_expr.expr_compiled = rule_data.expr_compiled;
+          break;
+        }
+      }
+    }
+    return {};
+  }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "seed_interpreter.hpp"
+
+namespace silva::seed {
+  struct optimizer_options_t {
+    // Only "no_node" rules with at most this many nodes in their expression are inlined.
+    index_t inline_max_nodes = 16;
+
+    // Limits the inlining of rules into (the inlined expressions of) other rules.
+    index_t inline_max_depth = 4;
+  };
+
+  // Sets "rule_expr_data_t::expr_compiled" of all rules to an expression that is cheaper to
+  // interpret than "rule_expr_data_t::expr". Applying the interpreter results in exactly the same
+  // parse-trees, only error messages, execution traces, and profiles may differ. Must be called after
+  // the names of the interpreter have been resolved.
+  //
+  // The rewrites are:
+  //  - "Expr" wrappers are removed.
+  //  - Non-recursive branch-rules that are "no_node" and small are inlined.
+  //  - Adjacent alternatives with a common prefix are left-factored, i.e., "A B | A C" becomes
+  //    "A ( B | C )". This is only done when it doesn't change which errors may be backtracked (see
+  //    the handling of leading string-terminals in concatenations).
+  expected_t<void> optimize(interpreter_t&, const optimizer_options_t& = {});
+}
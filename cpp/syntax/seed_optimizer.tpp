@@ -0,0 +1,187 @@
+#include "seed_optimizer.hpp"
+
+#include "fragmentization.hpp"
+#include "seed.globals.hpp"
+#include "syntax.hpp"
+
+#include "canopy/env_context.hpp"
+#include "zoo/cedar/cedar.hpp"
+#include "zoo/fern/fern.hpp"
+#include "zoo/toml/toml.hpp"
+
+#include <catch2/catch_all.hpp>
+
+namespace silva::seed::test {
+  namespace {
+    // Applies the same grammar with and without optimizer and checks that the results agree, also
+    // for all prefixes of the inputs that can still be fragmentized.
+    struct differential_t {
+      syntax_farm_t sf;
+      unique_ptr_t<interpreter_t> optimized   = standard_seed_interpreter(sf.ptr());
+      unique_ptr_t<interpreter_t> unoptimized = standard_seed_interpreter(sf.ptr());
+
+      // The seed texts are added to both interpreters before they are compiled.
+      differential_t(const array_t<pair_t<filepath_t, string_view_t>>& seed_texts = {})
+      {
+        for (const auto& [filepath, seed_text]: seed_texts) {
+          SILVA_REQUIRE(optimized->add_seed_text(filepath, string_t{seed_text}));
+          SILVA_REQUIRE(unoptimized->add_seed_text(filepath, string_t{seed_text}));
+        }
+        SILVA_REQUIRE(optimized->compile());
+        env_context_t env_context;
+        env_context.variables["SEED_OPTIMIZE"_sov] = "false"_sov;
+        SILVA_REQUIRE(unoptimized->compile());
+      }
+
+      void check_one(const string_view_t text, const name_id_t goal)
+      {
+        auto fp = fragmentize(sf.ptr(), "", string_t{text});
+        if (!fp) {
+          return;
+        }
+        auto lhs = optimized->apply(*fp, goal);
+        auto rhs = unoptimized->apply(*fp, goal);
+        INFO(text);
+        REQUIRE(lhs.has_value() == rhs.has_value());
+        if (lhs.has_value()) {
+          CHECK((*lhs)->nodes == (*rhs)->nodes);
+        }
+      }
+
+      void check(const string_view_t text, const name_id_t goal)
+      {
+        check_one(text, goal);
+        const index_t step = std::max<index_t>(text.size() / 32, 1);
+        for (index_t len = 0; len < index_t(text.size()); len += step) {
+          check_one(text.substr(0, len), goal);
+        }
+      }
+    };
+  }
+
+  TEST_CASE("seed-optimizer", "[seed-optimizer][seed-interpreter]")
+  {
+    differential_t diff;
+    const lexicon_t& lexicon = diff.optimized->bootstrap_interpreter.lexicon();
+
+    index_t num_optimized = 0;
+    for (const auto& [rule_name, rule_data]: diff.optimized->rule_exprs) {
+      CHECK(!rule_data.expr_compiled.ptp.is_nullptr());
+      if (rule_data.expr_compiled != rule_data.expr) {
+        num_optimized += 1;
+        INFO(lexicon.name_id_str(rule_name));
+        CHECK(rule_data.expr_compiled.subtree_size() > 0);
+      }
+    }
+    CHECK(num_optimized > 0);
+    for (const auto& [_, rule_data]: diff.unoptimized->rule_exprs) {
+      CHECK(rule_data.expr_compiled == rule_data.expr);
+    }
+
+    const name_id_t ni_seed = diff.sf.name_id_of("Seed");
+    for (const string_view_t text:
+         {globals_str, seed_str, axe_str, fern::seed_str, silva::seed_str}) {
+      diff.check(text, ni_seed);
+    }
+    diff.check(R"([
+  none
+  true
+  'test' : 'Hello'
+  42
+  []
+  [ 1 'two' : 2 3 ]
+]
+)",
+               diff.sf.name_id_of("Fern"));
+  }
+
+  TEST_CASE("seed-optimizer-cedar", "[seed-optimizer][seed-interpreter][cedar]")
+  {
+    // Cedar has many rules with literal alternatives and deep expression axes, which are where
+    // most of the rewrites apply.
+    differential_t diff({{"cedar.seed", cedar::seed_str}});
+    const name_id_t ni_cedar = diff.sf.name_id_of("Cedar");
+    diff.check(R"(
+extern void* stdout;
+extern int fprintf(void* stream, const char* format, ...);
+typedef unsigned long size_t;
+static const int table[3] = { 1, 2, 3, };
+struct point { int x; int y; };
+enum color { RED, GREEN = 2, BLUE };
+int (*(*test_4)())[3];
+char* (*(**test_5[][8])())[];
+
+int
+main(int argc, char* argv[])
+{
+  for (int i = 0; i < argc; i++) {
+    fprintf(stdout, "[%d] = %s\n", i, argv[i]);
+  }
+  int n = sizeof(int) * 2 + (argc << 1) % 7;
+  while (n > 0 && !(n & 1) || n == 3) {
+    n -= argc > 1 ? 2 : 1;
+  }
+  switch (n) {
+    case 0:
+      break;
+    default:
+      goto done;
+  }
+  do {
+    n++;
+  } while (n < 10);
+done:
+  return n ? -n : ~n;
+}
+)",
+               ni_cedar);
+  }
+
+  TEST_CASE("seed-optimizer-toml", "[seed-optimizer][seed-interpreter][toml]")
+  {
+    // The values of TOML are a long alternation of rules from the standard library (strings, dates,
+    // times, numbers), which the optimizer inlines and factors.
+    differential_t diff({{"toml.seed", toml::seed_str}});
+    const name_id_t ni_toml = diff.sf.name_id_of("Toml");
+    diff.check(R"(
+# Keys
+bare_key = "value"
+bare-key-dash = 'literal'
+"quoted key" = ""
+physical.property.color = "blue"
+
+[numbers]
+positive = +99
+negative = -17
+hexadecimal = 0xDEADBEEF
+octal = 0o755
+binary = 0b11010010
+normal = +3.14159
+exponent = -6.23e-4
+infinity = -inf
+not_a_number = nan
+
+[datetimes]
+offset_utc = 1979-05-27T07:32:00Z
+offset_with_ms = 1979-05-27T00:32:00.999999-07:00
+local_date_time = 1979-05-27T07:32:00
+local_date = 1979-05-27
+local_time = 07:32:00.999999
+
+[arrays.and.tables]
+flags = [true, false]
+nested = [[1, 2], [3, 4, 5], ]
+mixed = [1, "two", ["three", 4], 5.0, 1979-05-27]
+inline = { first = "Tom", nested = { id = 42 }, empty = {} }
+
+[[products]]
+name = "Hammer"
+
+[[products]]
+
+[[products.categories]]
+name = "Fasteners"
+)",
+               ni_toml);
+  }
+}
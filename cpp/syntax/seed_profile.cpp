@@ -0,0 +1,178 @@
+#include "seed_profile.hpp"
+
+#include "rfl/json/write.hpp"
+
+#include <algorithm>
+
+namespace silva::seed {
+  void rule_profile_t::merge(const rule_profile_t& other)
+  {
+    invocations += other.invocations;
+    successes += other.successes;
+    failures += other.failures;
+    backtracked_fragments += other.backtracked_fragments;
+
+    time_inclusive      = time_inclusive + other.time_inclusive;
+    time_exclusive      = time_exclusive + other.time_exclusive;
+    max_recursion_depth = std::max(max_recursion_depth, other.max_recursion_depth);
+  }
+
+  void profile_t::merge(const profile_t& other)
+  {
+    if (rules.size() < other.rules.size()) {
+      const index_t old_size = rules.size();
+      rules.resize(other.rules.size());
+      for (index_t i = old_size; i < index_t(rules.size()); ++i) {
+        rules[i].rule_name = name_id_t{i};
+      }
+    }
+    for (index_t i = 0; i < index_t(other.rules.size()); ++i) {
+      rules[i].merge(other.rules[i]);
+    }
+  }
+
+  array_t<rule_profile_t> profile_t::sorted() const
+  {
+    array_t<rule_profile_t> retval;
+    for (const rule_profile_t& rp: rules) {
+      if (rp.invocations > 0) {
+        retval.push_back(rp);
+      }
+    }
+    std::ranges::stable_sort(retval, [](const rule_profile_t& lhs, const rule_profile_t& rhs) {
+      return lhs.time_exclusive > rhs.time_exclusive;
+    });
+    return retval;
+  }
+
+  namespace {
+    double as_millis(const time_span_t ts)
+    {
+      return double(ts.nanos) / 1'000'000.0;
+    }
+
+    struct json_rule_t {
+      string_t rule;
+      index_t invocations           = 0;
+      index_t successes             = 0;
+      index_t failures              = 0;
+      index_t backtracked_fragments = 0;
+      time_repr_t time_inclusive_ns = 0;
+      time_repr_t time_exclusive_ns = 0;
+      index_t max_recursion_depth   = 0;
+    };
+  }
+
+  string_t profile_t::to_string(const silva::lexicon_t& lexicon) const
+  {
+    string_t retval = fmt::format("{:<40} {:>10} {:>10} {:>10} {:>12} {:>12} {:>12} {:>6}\n",
+                                  "rule",
+                                  "calls",
+                                  "success",
+                                  "failure",
+                                  "backtracked",
+                                  "incl [ms]",
+                                  "excl [ms]",
+                                  "depth");
+    for (const rule_profile_t& rp: sorted()) {
+      retval += fmt::format("{:<40} {:>10} {:>10} {:>10} {:>12} {:>12.3f} {:>12.3f} {:>6}\n",
+                            lexicon.name_id_str(rp.rule_name),
+                            rp.invocations,
+                            rp.successes,
+                            rp.failures,
+                            rp.backtracked_fragments,
+                            as_millis(rp.time_inclusive),
+                            as_millis(rp.time_exclusive),
+                            rp.max_recursion_depth);
+    }
+    return retval;
+  }
+
+  string_t profile_t::to_json(const silva::lexicon_t& lexicon) const
+  {
+    array_t<json_rule_t> json_rules;
+    for (const rule_profile_t& rp: sorted()) {
+      json_rules.push_back(json_rule_t{
+          .rule                  = lexicon.name_id_str(rp.rule_name),
+          .invocations           = rp.invocations,
+          .successes             = rp.successes,
+          .failures              = rp.failures,
+          .backtracked_fragments = rp.backtracked_fragments,
+          .time_inclusive_ns     = rp.time_inclusive.nanos,
+          .time_exclusive_ns     = rp.time_exclusive.nanos,
+          .max_recursion_depth   = rp.max_recursion_depth,
+      });
+    }
+    return rfl::json::write(json_rules);
+  }
+
+  profiler_t::profiler_t(const index_t num_names)
+  {
+    profile.rules.resize(num_names);
+    for (index_t i = 0; i < num_names; ++i) {
+      profile.rules[i].rule_name = name_id_t{i};
+    }
+    recursion_depths.resize(num_names, 0);
+    rule_ticks.resize(num_names);
+  }
+
+  void profiler_t::enter(const name_id_t rule_name, const index_t fragment_index)
+  {
+    rule_profile_t& rp = profile.rules[rule_name.val];
+    rp.invocations += 1;
+    index_t& depth = recursion_depths[rule_name.val];
+    depth += 1;
+    rp.max_recursion_depth = std::max(rp.max_recursion_depth, depth);
+    frames.push_back(frame_t{
+        .start            = fast_clock_t::now(),
+        .fragment_begin   = fragment_index,
+        .fragment_reached = fragment_index,
+    });
+  }
+
+  void profiler_t::exit(const name_id_t rule_name, const index_t fragment_index, const bool success)
+  {
+    const fast_ticks_t now = fast_clock_t::now();
+    const frame_t frame    = frames.back();
+    frames.pop_back();
+    const fast_ticks_t ticks_inclusive = now - frame.start;
+    const index_t fragment_reached     = std::max(frame.fragment_reached, fragment_index);
+
+    rule_profile_t& rp = profile.rules[rule_name.val];
+    rule_ticks_t& rt   = rule_ticks[rule_name.val];
+    index_t& depth     = recursion_depths[rule_name.val];
+    depth -= 1;
+    if (depth == 0) {
+      rt.inclusive += ticks_inclusive;
+    }
+    rt.exclusive += ticks_inclusive - frame.ticks_nested;
+    if (success) {
+      rp.successes += 1;
+    }
+    else {
+      rp.failures += 1;
+      rp.backtracked_fragments += fragment_reached - frame.fragment_begin;
+    }
+
+    if (!frames.empty()) {
+      frame_t& parent = frames.back();
+      parent.ticks_nested += ticks_inclusive;
+      parent.fragment_reached = std::max(parent.fragment_reached, fragment_reached);
+    }
+  }
+
+  void profiler_t::finish(const silva::lexicon_t& lexicon) &&
+  {
+    for (index_t i = 0; i < index_t(rule_ticks.size()); ++i) {
+      profile.rules[i].time_inclusive = fast_clock_t::to_time_span(rule_ticks[i].inclusive);
+      profile.rules[i].time_exclusive = fast_clock_t::to_time_span(rule_ticks[i].exclusive);
+    }
+    auto pc = profile_context_t::get();
+    if (!pc.is_nullptr()) {
+      pc->profile.merge(profile);
+    }
+    else {
+      fmt::print("{}", profile.to_string(lexicon));
+    }
+  }
+}
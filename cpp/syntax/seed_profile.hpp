@@ -0,0 +1,83 @@
+#pragma once
+
+#include "syntax_farm.hpp"
+
+#include "canopy/context.hpp"
+#include "canopy/fast_clock.hpp"
+#include "canopy/time.hpp"
+
+namespace silva::seed {
+  // Aggregated statistics about the invocations of a single rule.
+  struct rule_profile_t {
+    name_id_t rule_name;
+
+    index_t invocations = 0;
+    index_t successes   = 0;
+    index_t failures    = 0;
+
+    // Number of fragments that failed invocations of the rule had already advanced over (as seen
+    // at the boundaries of the rules they invoked) before giving up.
+    index_t backtracked_fragments = 0;
+
+    // Inclusive time only counts the outermost invocation of recursive rules.
+    time_span_t time_inclusive;
+    time_span_t time_exclusive;
+
+    index_t max_recursion_depth = 0;
+
+    void merge(const rule_profile_t&);
+  };
+
+  struct profile_t {
+    // Indexed by "name_id_t::val".
+    array_t<rule_profile_t> rules;
+
+    void merge(const profile_t&);
+
+    // All rules that were invoked at least once, by descending exclusive time.
+    array_t<rule_profile_t> sorted() const;
+
+    string_t to_string(const silva::lexicon_t&) const;
+    string_t to_json(const silva::lexicon_t&) const;
+  };
+
+  // If the env-context variable SEED_PROFILE is true, interpreter_t::apply() profiles the rules of
+  // the grammar. The results are merged into the current profile_context_t or, if there is none,
+  // printed after each parse.
+  struct profile_context_t : public context_t<profile_context_t> {
+    constexpr static bool context_use_default = false;
+    constexpr static bool context_mutable_get = true;
+
+    profile_t profile;
+  };
+
+  // Used by the interpreter to collect a profile_t. Times are measured in fast_clock_t ticks and
+  // only converted to time_span_t in finish().
+  struct profiler_t {
+    profile_t profile;
+
+    struct frame_t {
+      fast_ticks_t start        = 0;
+      fast_ticks_t ticks_nested = 0;
+      index_t fragment_begin    = 0;
+      index_t fragment_reached  = 0;
+    };
+    array_t<frame_t> frames;
+    array_t<index_t> recursion_depths;
+
+    // Indexed by "name_id_t::val".
+    struct rule_ticks_t {
+      fast_ticks_t inclusive = 0;
+      fast_ticks_t exclusive = 0;
+    };
+    array_t<rule_ticks_t> rule_ticks;
+
+    profiler_t(index_t num_names);
+
+    void enter(name_id_t, index_t fragment_index);
+    void exit(name_id_t, index_t fragment_index, bool success);
+
+    // Merges into the current profile_context_t or prints a report.
+    void finish(const silva::lexicon_t&) &&;
+  };
+}
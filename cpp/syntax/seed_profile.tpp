@@ -0,0 +1,78 @@
+#include "seed_profile.hpp"
+
+#include "seed_interpreter.hpp"
+
+#include "canopy/env_context.hpp"
+
+#include <catch2/catch_all.hpp>
+
+namespace silva::seed::test {
+  TEST_CASE("seed-profile", "[seed::profile_t][seed-interpreter]")
+  {
+    const string_view_t prof_seed = R"'(
+language Prof:
+  ⊙ = Item *
+  skip = ( SPACE | LINEFEED | COMMENT | WHITESPACE | INDENT | DEDENT | NEWLINE ) *
+  Item = Pair | List | Name
+  Pair = Name ':' Name
+  List = '(' Item * ')'
+  Name = identifier
+  identifier = ID_START ID_CONTINUE *
+)'";
+    syntax_farm_t sf;
+    interpreter_t se(sf.ptr());
+    SILVA_REQUIRE(se.add_seed_text("prof.seed", string_t{prof_seed}));
+    const string_t text = "a : b ( c ( d ) ) e\n";
+
+    profile_context_t profile_context;
+    SILVA_REQUIRE(se.apply_text("", text, sf.name_id_of("Prof")));
+    CHECK(profile_context.profile.rules.empty());
+
+    env_context_t env_context;
+    env_context.variables["SEED_PROFILE"_sov] = "true"_sov;
+    SILVA_REQUIRE(se.apply_text("", text, sf.name_id_of("Prof")));
+    const profile_t& profile = profile_context.profile;
+    const auto rule_at       = [&](const name_id_t rule_name) -> const rule_profile_t& {
+      REQUIRE(rule_name.val < index_t(profile.rules.size()));
+      return profile.rules[rule_name.val];
+    };
+
+    const rule_profile_t& root = rule_at(sf.name_id_of("Prof"));
+    CHECK(root.invocations == 1);
+    CHECK(root.successes == 1);
+    CHECK(root.max_recursion_depth == 1);
+    CHECK(root.time_exclusive <= root.time_inclusive);
+
+    const rule_profile_t& item = rule_at(sf.name_id_of("Prof", "Item"));
+    CHECK(item.invocations == 9);
+    CHECK(item.successes == 6);
+    CHECK(item.failures == 3);
+    CHECK(item.max_recursion_depth == 3);
+    CHECK(item.time_inclusive <= root.time_inclusive);
+
+    const rule_profile_t& pair = rule_at(sf.name_id_of("Prof", "Pair"));
+    CHECK(pair.invocations == 9);
+    CHECK(pair.successes == 1);
+    CHECK(pair.failures == 8);
+    CHECK(pair.backtracked_fragments > 0);
+
+    const rule_profile_t& list = rule_at(sf.name_id_of("Prof", "List"));
+    CHECK(list.invocations == 8);
+    CHECK(list.successes == 2);
+    CHECK(list.max_recursion_depth == 2);
+
+    for (const rule_profile_t& rp: profile.sorted()) {
+      CHECK(rp.invocations == rp.successes + rp.failures);
+    }
+
+    const string_t report = profile.to_string(se.bootstrap_interpreter.lexicon());
+    CHECK(report.contains("Pair"));
+    const string_t json = profile.to_json(se.bootstrap_interpreter.lexicon());
+    CHECK(json.contains(R"("invocations":9)"));
+
+    // Profiles of further parses are accumulated.
+    SILVA_REQUIRE(se.apply_text("", text, sf.name_id_of("Prof")));
+    CHECK(rule_at(sf.name_id_of("Prof")).invocations == 2);
+    CHECK(rule_at(sf.name_id_of("Prof", "Pair")).failures == 16);
+  }
+}
@@ -2,8 +2,10 @@
 
 #include "seed_interpreter.hpp"
 
+#include "canopy/inplace_function.hpp"
+
 namespace silva {
-  using parser_t = silva::function_t<expected_t<parse_tree_ptr_t>(fragment_span_t, name_id_t)>;
+  using parser_t = inplace_function_t<expected_t<parse_tree_ptr_t>(fragment_span_t, name_id_t)>;
 
   parser_t as_parser(seed::interpreter_t*);
 
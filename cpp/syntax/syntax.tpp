@@ -106,4 +106,42 @@ language Expr:
     const string_t result{SILVA_REQUIRE(expr_pt->span().to_string())};
     CHECK(result == expected_parse_tree.substr(1));
   }
+
+  TEST_CASE("apply-sections", "[seed::interpreter_t]")
+  {
+    const string_t silva_text = R"(
+Fern «
+[ 1 'two' : 2 ]
+»
+Fern «
+[ [] none ]
+»
+)";
+    syntax_farm_t sf;
+    const auto si              = standard_seed_interpreter(sf.ptr());
+    const name_id_t ni_silva   = sf.name_id_of("Silva");
+    const name_id_t ni_fern    = sf.name_id_of("Fern");
+    const name_id_t ni_section = sf.name_id_of(ni_silva, "Section");
+    const auto pt              = SILVA_REQUIRE(si->apply_text("", silva_text, ni_silva));
+
+    for (const index_t num_threads: {1, 4}) {
+      const auto document = SILVA_REQUIRE(si->apply_sections(
+          pt,
+          [&](const parse_tree_span_t& pts_parent, const parse_tree_span_t&) {
+            return pts_parent.rule_name() == ni_section ? ni_fern : name_id_t{};
+          },
+          num_threads));
+      CHECK(document.ptp == pt);
+      REQUIRE(document.sections.size() == 2);
+      for (const seed::section_t& section: document.sections) {
+        CHECK(section.parent == -1);
+        CHECK(section.goal_rule_name == ni_fern);
+        const auto expected =
+            SILVA_REQUIRE(si->apply(section.pts_language.fragment_span(), ni_fern));
+        CHECK(section.ptp->nodes == expected->nodes);
+      }
+      CHECK(document.sections[0].pts_language.fragment_begin() <
+            document.sections[1].pts_language.fragment_begin());
+    }
+  }
 }
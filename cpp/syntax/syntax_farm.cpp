@@ -104,7 +104,7 @@ namespace silva {
 
   token_id_t syntax_farm_t::token_id(const string_view_t token_str)
   {
-    const auto it = token_lookup.find(string_t{token_str});
+    const auto it = token_lookup.find(token_str);
     if (it != token_lookup.end()) {
       return it->second;
     }
@@ -121,6 +121,22 @@ namespace silva {
     return token_id(fs.as_string_view());
   }
 
+  token_id_t syntax_farm_t::token_id_find(const string_view_t token_str) const
+  {
+    const auto it = token_lookup.find(token_str);
+    if (it != token_lookup.end()) {
+      return it->second;
+    }
+    else {
+      return token_id_t{};
+    }
+  }
+
+  token_id_t syntax_farm_t::token_id_find(const fragment_span_t fs) const
+  {
+    return token_id_find(fs.as_string_view());
+  }
+
   expected_t<token_id_t> syntax_farm_t::token_id_in_string(const token_id_t ti)
   {
     const auto& token_info = get(ti);
@@ -140,6 +156,18 @@ namespace silva {
     return it->second;
   }
 
+  name_id_t syntax_farm_t::name_id_find(const name_id_t parent_name,
+                                        const token_id_t base_name) const
+  {
+    const auto it = name_lookup.find(name_info_t{parent_name, base_name});
+    if (it != name_lookup.end()) {
+      return it->second;
+    }
+    else {
+      return name_id_t{};
+    }
+  }
+
   name_id_t syntax_farm_t::name_id_span(const name_id_t parent_name,
                                         const span_t<const token_id_t> token_ids)
   {
@@ -2,6 +2,7 @@
 
 #include "canopy/assert.hpp"
 #include "canopy/expected.hpp"
+#include "canopy/flat_hash.hpp"
 
 namespace silva {
 
@@ -79,10 +80,10 @@ namespace silva {
 
   struct syntax_farm_t : public menhir_t {
     array_t<token_info_t> token_infos;
-    hash_map_t<string_t, token_id_t> token_lookup;
+    flat_hash_map_t<string_t, token_id_t> token_lookup;
 
     array_t<name_info_t> name_infos;
-    hash_map_t<name_info_t, name_id_t> name_lookup;
+    flat_hash_map_t<name_info_t, name_id_t> name_lookup;
 
     hash_map_t<std::type_index, unique_ptr_t<const lexicon_t>> lexicons;
 
@@ -98,9 +99,18 @@ namespace silva {
     token_id_t token_id(string_view_t);
     token_id_t token_id(fragment_span_t);
 
+    // Like token_id(), but never adds a new token. Returns the invalid token_id_t if the given
+    // string is not a known token.
+    token_id_t token_id_find(string_view_t) const;
+    token_id_t token_id_find(fragment_span_t) const;
+
     expected_t<token_id_t> token_id_in_string(token_id_t);
 
     name_id_t name_id(name_id_t parent_name, token_id_t base_name);
+
+    // Like name_id(), but never adds a new name. Returns the invalid name_id_t if the name is not
+    // known.
+    name_id_t name_id_find(name_id_t parent_name, token_id_t base_name) const;
     name_id_t name_id_span(name_id_t parent_name, span_t<const token_id_t>);
     bool name_id_is_parent(name_id_t parent_name, name_id_t child_name) const;
 
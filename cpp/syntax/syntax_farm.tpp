@@ -0,0 +1,65 @@
+#include "syntax_farm.hpp"
+
+#include "canopy/flat_hash.hpp"
+#include "canopy/time.hpp"
+
+#include <catch2/catch_all.hpp>
+
+namespace silva::test {
+  namespace {
+    template<typename Map, typename Key>
+    void run_hash_map_benchmark(const string_view_t name, const array_t<Key>& keys)
+    {
+      // The first half of the keys is inserted, the second half is only used for misses.
+      const index_t half = keys.size() / 2;
+      Map map;
+      const auto start_insert = time_point_t::now();
+      for (index_t i = 0; i < half; ++i) {
+        map.emplace(keys[i], i);
+      }
+      const auto took_insert = time_point_t::now() - start_insert;
+
+      index_t num_found    = 0;
+      const auto start_hit = time_point_t::now();
+      for (index_t i = 0; i < half; ++i) {
+        num_found += map.contains(keys[i]) ? 1 : 0;
+      }
+      const auto took_hit   = time_point_t::now() - start_hit;
+      const auto start_miss = time_point_t::now();
+      for (index_t i = half; i < index_t(keys.size()); ++i) {
+        num_found += map.contains(keys[i]) ? 1 : 0;
+      }
+      const auto took_miss = time_point_t::now() - start_miss;
+      CHECK(num_found == half);
+      fmt::println("{:32} insert {}  hit {}  miss {}", name, took_insert, took_hit, took_miss);
+    }
+
+    template<typename Key>
+    void run_hash_map_benchmarks(const string_view_t key_name, const array_t<Key>& keys)
+    {
+      run_hash_map_benchmark<hash_map_t<Key, index_t>>(fmt::format("hash_map_t<{}>", key_name),
+                                                       keys);
+      run_hash_map_benchmark<flat_hash_map_t<Key, index_t>>(
+          fmt::format("flat_hash_map_t<{}>", key_name),
+          keys);
+    }
+  }
+
+  TEST_CASE("syntax-farm-lookup-performance", "[syntax_farm_t][flat_hash_map_t][.]")
+  {
+    constexpr index_t num_keys = 1'000'000;
+    array_t<string_t> string_keys;
+    array_t<token_id_t> token_keys;
+    array_t<name_id_t> name_keys;
+    for (index_t i = 0; i < num_keys; ++i) {
+      // Visits all values in [0, num_keys) in a scrambled order.
+      const index_t val = index_t(int64_t(i) * 7'919 % num_keys);
+      string_keys.push_back(fmt::format("token_{}", val));
+      token_keys.push_back(token_id_t{val});
+      name_keys.push_back(name_id_t{val});
+    }
+    run_hash_map_benchmarks("string_t", string_keys);
+    run_hash_map_benchmarks("token_id_t", token_keys);
+    run_hash_map_benchmarks("name_id_t", name_keys);
+  }
+}
@@ -0,0 +1,70 @@
+#include "cedar.hpp"
+
+#include "syntax/parse_tree_binary.hpp"
+
+#include "canopy/filesystem.hpp"
+#include "canopy/time.hpp"
+
+#include <catch2/catch_all.hpp>
+
+namespace silva::cedar::test {
+  TEST_CASE("cedar-parse-tree-binary-performance", "[cedar][parse_tree_binary][.]")
+  {
+    // The functions of "test.cedar", repeated with different names.
+    const string_view_t function_template = R"(
+int (*(*test_{0})())[3];
+int
+func_{0}(int argc, char* argv[])
+{{
+  for (int i = 0; i < argc; i++) {{
+    fprintf(stdout, "[%d] = %s\n", i, argv[i] + {0});
+  }}
+  return argc * {0};
+}}
+)";
+    string_t source_code = R"(
+extern void* stdout;
+extern int fprintf(void* stream, const char* format, ...);
+)";
+
+    constexpr index_t num_functions = 20'000;
+    for (index_t i = 0; i < num_functions; ++i) {
+      source_code += fmt::format(fmt::runtime(function_template), i);
+    }
+
+    syntax_farm_t sf;
+    const auto si = seed_interpreter(sf.ptr());
+
+    const auto start_parse = time_point_t::now();
+    const auto fp          = SILVA_REQUIRE(fragmentize(sf.ptr(), "large.cedar", source_code));
+    const auto ptp         = SILVA_REQUIRE(si->apply(fp, sf.name_id_of("Cedar")));
+    const auto took_parse  = time_point_t::now() - start_parse;
+
+    temp_dir_t td;
+    const filepath_t path = td.get_dir_path() / "large.cedar.pt";
+    const auto start_save = time_point_t::now();
+    SILVA_REQUIRE(parse_tree_binary_save(*ptp, path));
+    const auto took_save = time_point_t::now() - start_save;
+
+    // Into the same syntax_farm_t, where the rule names stay the same.
+    const auto start_load = time_point_t::now();
+    const auto ptp_same   = SILVA_REQUIRE(parse_tree_binary_load(sf.ptr(), path));
+    const auto took_load  = time_point_t::now() - start_load;
+    CHECK(ptp_same->nodes == ptp->nodes);
+
+    // Into a fresh syntax_farm_t, where the rule names have to be translated.
+    syntax_farm_t sf_other;
+    const auto start_load_other = time_point_t::now();
+    const auto ptp_other        = SILVA_REQUIRE(parse_tree_binary_load(sf_other.ptr(), path));
+    const auto took_load_other  = time_point_t::now() - start_load_other;
+    CHECK(ptp_other->nodes.size() == ptp->nodes.size());
+
+    fmt::println("{} nodes, {} bytes: parse {}  save {}  load {}  load (other syntax_farm_t) {}",
+                 ptp->nodes.size(),
+                 std::filesystem::file_size(path),
+                 took_parse,
+                 took_save,
+                 took_load,
+                 took_load_other);
+  }
+}
@@ -3,14 +3,17 @@
 #include <chrono>
 
 namespace silva::lox {
-  expected_t<hash_map_t<token_id_t, object_ref_t>>
-  make_builtins(syntax_farm_ptr_t sfp, const parser_t& parser, object_pool_t& object_pool)
+  expected_t<hash_map_t<token_id_t, object_ref_t>> make_builtins(syntax_farm_ptr_t sfp,
+                                                                 const parser_t& parser,
+                                                                 object_pool_t& object_pool,
+                                                                 byte_sink_t* print_target,
+                                                                 byte_source_t* input_source)
   {
     struct builtin_decl_t {
       token_id_t name;
-      silva::function_t<expected_t<object_ref_t>(object_pool_t&, span_t<const object_ref_t>)> impl;
+      builtin_impl_t impl;
     };
-    array_t<builtin_decl_t> builtin_decls{
+    array_fixed_t<builtin_decl_t, 5> builtin_decls{
         builtin_decl_t{
             .name = sfp->token_id("clock"),
             .impl = [](object_pool_t& object_pool,
@@ -25,11 +28,20 @@ namespace silva::lox {
         },
         builtin_decl_t{
             .name = sfp->token_id("getc"),
-            .impl = [](object_pool_t& object_pool,
-                       const span_t<const object_ref_t> params) -> expected_t<object_ref_t> {
+            .impl = [print_target, input_source](
+                        object_pool_t& object_pool,
+                        const span_t<const object_ref_t> params) -> expected_t<object_ref_t> {
               SILVA_EXPECT(params.size() == 0, RUNTIME);
-              const char retval_char = getchar();
-              return object_pool.make(double(retval_char));
+              SILVA_EXPECT(input_source != nullptr, RUNTIME, "getc() has no input to read from");
+              if (print_target != nullptr) {
+                print_target->flush();
+              }
+              // Like getchar() converted to char, i.e., -1 at the end of the input.
+              const optional_t<byte_t> next = input_source->get();
+              if (!next.has_value()) {
+                return object_pool.make(-1.0);
+              }
+              return object_pool.make(double(std::to_integer<char>(*next)));
             },
         },
         builtin_decl_t{
@@ -86,7 +98,7 @@ namespace silva::lox {
     const auto pts_builtin = SILVA_EXPECT_FWD(parser(fp, sfp->name_id_of("Lox")))->span();
 
     auto [it, end] = pts_builtin.children_range();
-    for (const builtin_decl_t& builtin_decl: builtin_decls) {
+    for (builtin_decl_t& builtin_decl: builtin_decls) {
       SILVA_EXPECT(it != end, ASSERT);
       const auto pts_fun        = (*it).subspan_at(1).subspan_at(1);
       const auto pts_fun_id     = SILVA_EXPECT_FWD(pts_fun.iterate_to_child(0));
@@ -96,7 +108,7 @@ namespace silva::lox {
                    "expected function '{}', but found '{}'",
                    sfp->token_id_wrap(lox_name),
                    sfp->token_id_wrap(builtin_decl.name));
-      function_builtin_t fb{{pts_fun}, builtin_decl.impl};
+      function_builtin_t fb{{pts_fun}, std::move(builtin_decl.impl)};
       // fb.closure           = scopes.root();
       ++it;
       retval[lox_name] = object_pool.make(std::move(fb));
@@ -4,8 +4,15 @@
 
 #include "syntax/syntax.hpp"
 
+#include "canopy/byte_sink.hpp"
+#include "canopy/byte_source.hpp"
+
 namespace silva::lox {
-  // The parser needs to be able to parse Lox.
-  expected_t<hash_map_t<token_id_t, object_ref_t>>
-  make_builtins(syntax_farm_ptr_t, const parser_t&, object_pool_t&);
+  // The parser needs to be able to parse Lox. The getc() builtin reads from "input_source", after
+  // flushing "print_target" so that a prompt printed before is visible while it waits.
+  expected_t<hash_map_t<token_id_t, object_ref_t>> make_builtins(syntax_farm_ptr_t,
+                                                                 const parser_t&,
+                                                                 object_pool_t&,
+                                                                 byte_sink_t* print_target,
+                                                                 byte_source_t* input_source);
 }
@@ -3,6 +3,8 @@
 #include "lox.hpp"
 #include "zoo/lox/object.hpp"
 
+#include "canopy/memory_context.hpp"
+
 namespace silva::lox {
 
   using enum opcode_t;
@@ -28,7 +30,7 @@ namespace silva::lox {
       struct local_t {
         token_id_t var_name;
       };
-      array_t<local_t> locals;
+      memory_array_t<local_t> locals;
 
       struct upvalue_info_t {
         index_t index = 0;
@@ -36,11 +38,11 @@ namespace silva::lox {
 
         friend auto operator<=>(const upvalue_info_t&, const upvalue_info_t&) = default;
       };
-      array_t<upvalue_info_t> upvalue_infos;
+      memory_array_t<upvalue_info_t> upvalue_infos;
 
       func_scope_t(syntax_farm_ptr_t sfp) : chunk{std::make_unique<bytecode_chunk_t>(sfp)} {}
     };
-    array_t<func_scope_t> func_scopes;
+    memory_array_t<func_scope_t> func_scopes;
 
     // returns index into "upvalue_infos" of the "func_scopes" entry with index "fs_idx".
     optional_t<index_t> resolve_upvalue(const index_t fs_idx, const token_id_t ti)
@@ -95,7 +97,7 @@ namespace silva::lox {
       };
       ~block_scope_guard_t()
       {
-        array_t<index_t> upvalue_locals;
+        memory_array_t<index_t> upvalue_locals;
         while (compile_run->cfs().upvalue_infos.size() > start_num_upvalue_infos) {
           if (compile_run->cfs().upvalue_infos.back().is_local) {
             upvalue_locals.push_back(compile_run->cfs().upvalue_infos.back().index);
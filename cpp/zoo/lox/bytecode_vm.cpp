@@ -6,10 +6,23 @@ namespace silva::lox {
 
   using enum opcode_t;
 
+  namespace {
+    // A single reader, so that bytes that one bytecode_vm_t read ahead aren't lost to the others.
+    byte_source_t* default_input_source()
+    {
+      static byte_source_stdin_t retval;
+      return &retval;
+    }
+  }
+
   bytecode_vm_t::bytecode_vm_t(syntax_farm_ptr_t sfp,
                                object_pool_t* object_pool,
-                               byte_sink_t* print_target)
-    : sfp(sfp), object_pool(object_pool), print_target(print_target)
+                               byte_sink_t* print_target,
+                               byte_source_t* input_source)
+    : sfp(sfp)
+    , object_pool(object_pool)
+    , print_target(print_target)
+    , input_source(input_source != nullptr ? input_source : default_input_source())
   {
   }
 
@@ -29,7 +42,8 @@ namespace silva::lox {
 
   expected_t<void> bytecode_vm_t::load_builtins(const parser_t& parser)
   {
-    auto builtins = SILVA_EXPECT_FWD(make_builtins(sfp, parser, *object_pool));
+    auto builtins =
+        SILVA_EXPECT_FWD(make_builtins(sfp, parser, *object_pool, print_target, input_source));
     for (auto& [name, builtin]: builtins) {
       globals[name] = std::move(builtin);
     }
@@ -294,8 +308,8 @@ namespace silva::lox {
                    RUNTIME,
                    "{} bytecode instruction PRINT needs non-empty stack",
                    curr_info_at_instr());
-      auto x = vm.stack.back();
-      vm.print_target->format("{}\n", pretty_string(std::move(x)));
+      pretty_write(vm.stack.back(), vm.print_target);
+      vm.print_target->write_str("\n");
       vm.stack.pop_back();
       curr_ip() += 1;
       return {};
@@ -5,6 +5,7 @@
 #include "syntax/syntax.hpp"
 
 #include "canopy/byte_sink.hpp"
+#include "canopy/byte_source.hpp"
 
 namespace silva::lox {
   struct bytecode_vm_t {
@@ -12,7 +13,7 @@ namespace silva::lox {
     object_pool_t* object_pool = nullptr;
     array_t<object_ref_t> stack;
     array_t<object_ref_t> open_upvalues;
-    hash_map_t<token_id_t, object_ref_t> globals;
+    flat_hash_map_t<token_id_t, object_ref_t> globals;
 
     struct call_frame_t {
       object_ref_t closure;
@@ -27,7 +28,11 @@ namespace silva::lox {
 
     byte_sink_t* print_target = nullptr;
 
-    bytecode_vm_t(syntax_farm_ptr_t, object_pool_t*, byte_sink_t*);
+    // Read by the getc() builtin. Without one, all bytecode_vm_t share a reader of stdin, which is
+    // not meant to be used by several threads at once.
+    byte_source_t* input_source = nullptr;
+
+    bytecode_vm_t(syntax_farm_ptr_t, object_pool_t*, byte_sink_t*, byte_source_t* = nullptr);
 
     // The parser needs to be able to parse Lox.
     expected_t<void> load_builtins(const parser_t&);
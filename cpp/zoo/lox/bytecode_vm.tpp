@@ -1,11 +1,14 @@
 #include "bytecode.hpp"
 #include "bytecode_compiler.hpp"
 #include "bytecode_vm.hpp"
+#include "canopy/memory_context.hpp"
 #include "canopy/time.hpp"
 
 #include "lox.hpp"
 #include "test_suite.hpp"
 
+#include "syntax/syntax.hpp"
+
 #include <catch2/catch_all.hpp>
 
 namespace silva::lox::test {
@@ -110,6 +113,25 @@ CONSTANT 3 3
     }
   }
 
+  TEST_CASE("lox-getc-flushes-output", "[lox][bytecode]")
+  {
+    // Records what was printed whenever the sink is asked to pass its content on.
+    struct flush_recorder_t : public byte_sink_memory_t {
+      array_t<string_t> flushed;
+      void flush() override { flushed.push_back(string_t{content_str()}); }
+    };
+    flush_recorder_t print_buffer;
+    byte_source_memory_t input("a");
+
+    test_harness_t th;
+    bytecode_vm_t vm{th.sf.ptr(), &th.object_pool, &print_buffer, &input};
+    SILVA_REQUIRE(vm.load_builtins(as_parser(th.si.get())));
+    const auto [ptp, chunk] = th.make_chunk("print 'prompt';\nprint getc();\n");
+    SILVA_REQUIRE(vm.run(*chunk));
+    CHECK(print_buffer.flushed == array_t<string_t>{"prompt\n"});
+    CHECK(print_buffer.content_str() == "prompt\n97\n");
+  }
+
   TEST_CASE("lox-bytecode-performance", "[lox][bytecode][.]")
   {
     test_harness_t th;
@@ -125,4 +147,36 @@ CONSTANT 3 3
     const auto end = time_point_t::now();
     fmt::println("FIBS TOOK {}\n", end - start);
   }
+
+  TEST_CASE("lox-compile-scratch-memory-context", "[lox][bytecode][memory_context_t][.]")
+  {
+    // Compiles each test case of the test suite inside its own memory_context_t. Only the scope
+    // tables of the compile run are allocated from the context; the parse-trees are made up front
+    // and the bytecode chunks stay on the heap. So this shows what the context costs or saves for
+    // that scratch data, not how fast parsing and compiling could be with arenas throughout.
+    test_harness_t th;
+    array_t<parse_tree_ptr_t> ptps;
+    for (const auto& chapter: test_suite()) {
+      for (const auto& test_case: chapter.test_cases) {
+        ptps.push_back(SILVA_REQUIRE(
+            th.si->apply_text("test.lox", string_t{test_case.lox_code}, th.sf.name_id_of("Lox"))));
+      }
+    }
+    using enum memory_resource_kind_t;
+    for (const auto& [kind, name]: array_t<pair_t<memory_resource_kind_t, string_view_t>>{
+             {HEAP, "HEAP"},
+             {ARENA, "ARENA"},
+             {POOL, "POOL"},
+         }) {
+      const auto start = time_point_t::now();
+      for (index_t repetition = 0; repetition < 20; ++repetition) {
+        for (const parse_tree_ptr_t& ptp: ptps) {
+          memory_context_t mc(kind);
+          const auto chunk = SILVA_REQUIRE(th.compiler.compile(ptp->span()));
+        }
+      }
+      const auto end = time_point_t::now();
+      fmt::println("{:6} compiling {} test cases 20 times took {}", name, ptps.size(), end - start);
+    }
+  }
 }
@@ -0,0 +1,446 @@
+#include "lox.hpp"
+#include "test_suite.hpp"
+
+#include "canopy/env_context.hpp"
+#include "canopy/time.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <random>
+#include <thread>
+
+namespace silva::lox::test {
+  namespace {
+    struct corpus_t {
+      syntax_farm_t sf;
+      unique_ptr_t<seed::interpreter_t> si = seed_interpreter(sf.ptr());
+      array_t<fragmentization_ptr_t> fps;
+
+      corpus_t(const index_t repetitions)
+      {
+        const auto ts = test_suite();
+        for (index_t i = 0; i < repetitions; ++i) {
+          for (const auto& chapter: ts) {
+            for (const auto& test_case: chapter.test_cases) {
+              fps.push_back(
+                  SILVA_REQUIRE(fragmentize(sf.ptr(), "test.lox", string_t{test_case.lox_code})));
+            }
+          }
+        }
+      }
+
+      struct result_t {
+        unique_ptr_t<parse_tree_t> pt;
+        string_t error_message;
+      };
+
+      // Parses the whole corpus with "num_threads" threads that share a single
+      // seed::compiled_grammar_t. Errors are turned into strings on their own thread, as they
+      // belong to that thread's error_context_t.
+      array_t<result_t> parse(const index_t num_threads)
+      {
+        const seed::compiled_grammar_t cg = SILVA_REQUIRE(si->compiled());
+        const name_id_t goal              = sf.name_id_of("Lox");
+        array_t<result_t> retval(fps.size());
+        {
+          array_t<std::jthread> threads;
+          for (index_t t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&, t] {
+              for (index_t i = t; i < index_t(fps.size()); i += num_threads) {
+                auto result = cg.apply(fps[i], goal);
+                if (result.has_value()) {
+                  retval[i].pt = std::move(result).value();
+                }
+                else {
+                  retval[i].error_message = pretty_string(std::move(result).error());
+                }
+              }
+            });
+          }
+        }
+        return retval;
+      }
+    };
+
+    // All test cases of the test suite as a single Lox program.
+    string_t test_suite_text(const index_t repetitions = 1)
+    {
+      string_t retval;
+      for (index_t i = 0; i < repetitions; ++i) {
+        for (const auto& chapter: test_suite()) {
+          for (const auto& test_case: chapter.test_cases) {
+            retval += test_case.lox_code;
+            retval += "\n";
+          }
+        }
+      }
+      return retval;
+    }
+  }
+
+  TEST_CASE("lox-compiled-grammar", "[lox][seed::compiled_grammar_t]")
+  {
+    corpus_t corpus(4);
+    const name_id_t goal = corpus.sf.name_id_of("Lox");
+    array_t<parse_tree_ptr_t> expected;
+    for (const auto& fp: corpus.fps) {
+      expected.push_back(SILVA_REQUIRE(corpus.si->apply(fp, goal)));
+    }
+
+    const index_t num_tokens      = corpus.sf.token_infos.size();
+    const index_t num_names       = corpus.sf.name_infos.size();
+    const index_t num_parse_trees = corpus.sf.parse_trees.size();
+    const auto results            = corpus.parse(8);
+    CHECK(corpus.sf.token_infos.size() == num_tokens);
+    CHECK(corpus.sf.name_infos.size() == num_names);
+    CHECK(corpus.sf.parse_trees.size() == num_parse_trees);
+
+    REQUIRE(results.size() == expected.size());
+    for (index_t i = 0; i < index_t(results.size()); ++i) {
+      INFO(results[i].error_message);
+      REQUIRE(results[i].pt);
+      CHECK(results[i].pt->fp == expected[i]->fp);
+      CHECK(results[i].pt->nodes == expected[i]->nodes);
+    }
+  }
+
+  TEST_CASE("lox-seed-optimizer", "[lox][seed-optimizer]")
+  {
+    corpus_t corpus(1);
+    const name_id_t goal   = corpus.sf.name_id_of("Lox");
+    const auto unoptimized = seed_interpreter(corpus.sf.ptr());
+    {
+      env_context_t env_context;
+      env_context.variables["SEED_OPTIMIZE"_sov] = "false"_sov;
+      SILVA_REQUIRE(unoptimized->compile());
+    }
+    for (const auto& fp: corpus.fps) {
+      const auto lhs = SILVA_REQUIRE(corpus.si->apply(fp, goal));
+      const auto rhs = SILVA_REQUIRE(unoptimized->apply(fp, goal));
+      CHECK(lhs->nodes == rhs->nodes);
+    }
+  }
+
+  TEST_CASE("lox-apply-parallel", "[lox][seed::compiled_grammar_t]")
+  {
+    syntax_farm_t sf;
+    const auto si        = seed_interpreter(sf.ptr());
+    const name_id_t goal = sf.name_id_of("Lox");
+    const string_t text  = test_suite_text();
+    const auto fp        = SILVA_REQUIRE(fragmentize(sf.ptr(), "all.lox", text));
+    const auto expected = SILVA_REQUIRE(si->apply(fp, goal));
+    for (const index_t num_threads: {1, 2, 8}) {
+      for (const index_t min_chunk_fragments: {1, 16, 1024}) {
+        INFO(num_threads << " threads, " << min_chunk_fragments << " fragments");
+        const seed::parallel_options_t options{
+            .num_threads         = num_threads,
+            .min_chunk_fragments = min_chunk_fragments,
+        };
+        const auto pt = SILVA_REQUIRE(si->apply_parallel(fp, goal, options));
+        CHECK(pt->nodes == expected->nodes);
+      }
+    }
+
+    const string_t bad_text = text + "var x = ;\n" + text;
+    const auto bad_fp       = SILVA_REQUIRE(fragmentize(sf.ptr(), "bad.lox", bad_text));
+    CHECK(!si->apply(bad_fp, goal).has_value());
+    CHECK(!si->apply_parallel(bad_fp, goal, {.num_threads = 4, .min_chunk_fragments = 1})
+               .has_value());
+  }
+
+  TEST_CASE("lox-apply-incremental", "[lox][seed::interpreter_t]")
+  {
+    syntax_farm_t sf;
+    const auto si        = seed_interpreter(sf.ptr());
+    const name_id_t goal = sf.name_id_of("Lox");
+    string_t text        = test_suite_text();
+    const auto fp        = SILVA_REQUIRE(fragmentize(sf.ptr(), "edit.lox", text));
+    auto prev            = SILVA_REQUIRE(si->apply_incremental(fp, goal));
+    CHECK(prev.num_reused_nodes == 0);
+    CHECK(prev.ptp->nodes == SILVA_REQUIRE(si->apply(fp, goal))->nodes);
+
+    // Random edits, each applied to the last text that could be parsed. Each parse of an edited
+    // text must give the same result as parsing it from scratch, including the same error.
+    const array_t<string_view_t> snippets{
+        "x", "1", " ", "\n", ";", "(", ")", "{", "}", "+", "=", "var", "print", "\"s\"", "// c\n",
+    };
+    std::mt19937 rng(42);
+    index_t num_parsed       = 0;
+    index_t num_failed       = 0;
+    index_t num_reused_nodes = 0;
+    for (index_t round = 0; round < 200; ++round) {
+      string_t edited   = text;
+      const index_t pos = rng() % (edited.size() + 1);
+      const index_t len = std::min<index_t>(rng() % 4, edited.size() - pos);
+      switch (rng() % 3) {
+        case 0:
+          edited.insert(pos, snippets[rng() % snippets.size()]);
+          break;
+        case 1:
+          edited.erase(pos, len);
+          break;
+        default:
+          edited.replace(pos, len, snippets[rng() % snippets.size()]);
+          break;
+      }
+      auto edited_fp = fragmentize(sf.ptr(), "edit.lox", edited);
+      if (!edited_fp.has_value()) {
+        continue;
+      }
+      INFO(fmt::format("round {}, edit at byte {}", round, pos));
+      const auto expected = si->apply(*edited_fp, goal);
+      auto result         = si->apply_incremental(*edited_fp, goal, &prev);
+      REQUIRE(result.has_value() == expected.has_value());
+      if (result.has_value()) {
+        CHECK(result->ptp->nodes == (*expected)->nodes);
+        num_parsed += 1;
+        num_reused_nodes += result->num_reused_nodes;
+        text = std::move(edited);
+        prev = std::move(result).value();
+      }
+      else {
+        CHECK(result.error().to_string_plain().as_string() ==
+              expected.error().to_string_plain().as_string());
+        num_failed += 1;
+      }
+    }
+    CHECK(num_parsed > 0);
+    CHECK(num_failed > 0);
+    CHECK(num_reused_nodes > 0);
+  }
+
+  TEST_CASE("lox-error-context-bounded", "[lox][error_context_t]")
+  {
+    // Failed alternatives create lots of errors, but only the ones of enclosing rule applications
+    // are alive at any time, so the peak size of the error_context_t doesn't grow with the input.
+    syntax_farm_t sf;
+    const auto si                     = seed_interpreter(sf.ptr());
+    const seed::compiled_grammar_t cg = SILVA_REQUIRE(si->compiled());
+    const name_id_t goal              = sf.name_id_of("Lox");
+
+    const auto peak_error_nodes = [&](const index_t repetitions) {
+      const auto fp = SILVA_REQUIRE(fragmentize(sf.ptr(), "all.lox", test_suite_text(repetitions)));
+
+      bool success   = false;
+      index_t retval = 0;
+      // A fresh thread starts out with an empty default error_context_t.
+      std::thread([&] {
+        success = cg.apply(fp, goal).has_value();
+        retval  = error_context_t::get()->tree.nodes.capacity();
+      }).join();
+      CHECK(success);
+      return retval;
+    };
+    const index_t small = peak_error_nodes(1);
+    const index_t large = peak_error_nodes(8);
+    CHECK(small > 0);
+    CHECK(large <= small);
+  }
+
+  TEST_CASE("lox-token-hash-quality", "[lox][hash_bytes][hash_combiner_t]")
+  {
+    // The tokens and names interned while fragmentizing the test suite are hashed into as many
+    // buckets as the next power of two. A good hash has about as many keys in an already occupied
+    // bucket as random numbers would have, and no collisions in all 64 bits.
+    const auto check_hashes = [](const array_t<hash_value_t>& hashes) {
+      const index_t n = hashes.size();
+      const index_t m = std::bit_ceil(uint32_t(n));
+      hash_set_t<hash_value_t> full;
+      hash_set_t<hash_value_t> buckets;
+      for (const hash_value_t hv: hashes) {
+        full.insert(hv);
+        buckets.insert(hv & (m - 1));
+      }
+      const double expected = n - m * (1.0 - std::pow(1.0 - 1.0 / m, n));
+      const index_t actual  = n - buckets.size();
+      INFO("keys " << n << ", buckets " << m << ", expected " << expected << ", actual " << actual);
+      CHECK(index_t(full.size()) == n);
+      CHECK(actual <= expected + 5 * std::sqrt(expected) + 5);
+    };
+
+    corpus_t corpus(1);
+    const syntax_farm_t& sf = corpus.sf;
+    array_t<hash_value_t> token_hashes;
+    for (const token_info_t& ti: sf.token_infos) {
+      token_hashes.push_back(hash(ti.str));
+    }
+    array_t<hash_value_t> name_hashes;
+    for (const name_info_t& ni: sf.name_infos) {
+      name_hashes.push_back(hash(ni));
+    }
+    REQUIRE(token_hashes.size() > 100);
+    REQUIRE(name_hashes.size() > 10);
+    check_hashes(token_hashes);
+    check_hashes(name_hashes);
+  }
+
+  TEST_CASE("lox-threads-detached-errors", "[lox][seed::compiled_grammar_t][detached_error_t]")
+  {
+    // Documents are parsed on 16 threads, each with its own error_context_t. Failures are detached
+    // on the parsing thread and reported by the main thread.
+    corpus_t corpus(1);
+    const seed::compiled_grammar_t cg = SILVA_REQUIRE(corpus.si->compiled());
+    const name_id_t goal              = corpus.sf.name_id_of("Lox");
+    array_t<fragmentization_ptr_t> fps;
+    for (index_t i = 0; i < index_t(corpus.fps.size()); ++i) {
+      fps.push_back(corpus.fps[i]);
+      const string_t bad_text = fmt::format("var x{} = ;\n", i);
+      fps.push_back(SILVA_REQUIRE(fragmentize(corpus.sf.ptr(), "bad.lox", bad_text)));
+    }
+
+    struct result_t {
+      unique_ptr_t<parse_tree_t> pt;
+      optional_t<detached_error_t> error;
+    };
+    constexpr index_t num_threads = 16;
+    array_t<result_t> results(fps.size());
+    {
+      array_t<std::jthread> threads;
+      for (index_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+          for (index_t i = t; i < index_t(fps.size()); i += num_threads) {
+            auto result = cg.apply(fps[i], goal);
+            if (result.has_value()) {
+              results[i].pt = std::move(result).value();
+            }
+            else {
+              results[i].error = std::move(result).error().detach();
+            }
+          }
+        });
+      }
+    }
+
+    for (index_t i = 0; i < index_t(fps.size()); ++i) {
+      auto expected = cg.apply(fps[i], goal);
+      if (expected.has_value()) {
+        REQUIRE(results[i].pt);
+        CHECK(results[i].pt->nodes == expected.value()->nodes);
+      }
+      else {
+        REQUIRE(results[i].error.has_value());
+        const silva::error_t error = std::move(*results[i].error).attach();
+        CHECK(error.level == expected.error().level);
+        CHECK(error.to_string_plain().as_string() ==
+              expected.error().to_string_plain().as_string());
+      }
+    }
+    CHECK(std::ranges::count_if(results, [](const result_t& x) { return !x.pt; }) ==
+          index_t(corpus.fps.size()));
+  }
+
+  TEST_CASE("lox-parse-session", "[lox][seed::compiled_grammar_t]")
+  {
+    corpus_t corpus(2);
+    const seed::compiled_grammar_t cg = SILVA_REQUIRE(corpus.si->compiled());
+    const name_id_t goal              = corpus.sf.name_id_of("Lox");
+    const auto bad_fp =
+        SILVA_REQUIRE(fragmentize(corpus.sf.ptr(), "bad.lox", string_t{"var x = ;"}));
+    seed::parse_session_t session;
+    for (const auto& fp: corpus.fps) {
+      const auto expected = SILVA_REQUIRE(cg.apply(fp, goal));
+      const auto pt       = SILVA_REQUIRE(cg.apply(fp, goal, session));
+      CHECK(pt->fp == expected->fp);
+      CHECK(pt->nodes == expected->nodes);
+      CHECK(index_t(session.tree.capacity()) >= index_t(pt->nodes.size()));
+      CHECK(!cg.apply(bad_fp, goal, session).has_value());
+    }
+  }
+
+  TEST_CASE("lox-apply-incremental-performance", "[lox][seed::interpreter_t][.]")
+  {
+    syntax_farm_t sf;
+    const auto si        = seed_interpreter(sf.ptr());
+    const name_id_t goal = sf.name_id_of("Lox");
+    string_t text        = test_suite_text(20);
+    const auto fp        = SILVA_REQUIRE(fragmentize(sf.ptr(), "big.lox", text));
+    const auto prev      = SILVA_REQUIRE(si->apply_incremental(fp, goal));
+
+    // Changes a single number token in the middle of the text.
+    const index_t pos = text.find_first_of("0123456789", text.size() / 2);
+    REQUIRE(pos != index_t(string_t::npos));
+    text[pos]            = (text[pos] == '1') ? '2' : '1';
+    const auto edited_fp = SILVA_REQUIRE(fragmentize(sf.ptr(), "big.lox", text));
+
+    const auto start_full = time_point_t::now();
+    const auto expected   = SILVA_REQUIRE(si->apply(edited_fp, goal));
+    const auto took_full  = time_point_t::now() - start_full;
+    const auto start_inc  = time_point_t::now();
+    const auto result     = SILVA_REQUIRE(si->apply_incremental(edited_fp, goal, &prev));
+    const auto took_inc   = time_point_t::now() - start_inc;
+    CHECK(result.ptp->nodes == expected->nodes);
+    fmt::println("{} fragments, {} nodes", edited_fp->size(), expected->nodes.size());
+    fmt::println("full parse:          {}", took_full);
+    fmt::println("incremental reparse: {} ({} nodes reused, speedup {:.2f})",
+                 took_inc,
+                 result.num_reused_nodes,
+                 double(took_full.nanos) / double(took_inc.nanos));
+  }
+
+  TEST_CASE("lox-compiled-grammar-performance", "[lox][seed::compiled_grammar_t][.]")
+  {
+    corpus_t corpus(200);
+    const index_t max_threads = std::max<index_t>(std::thread::hardware_concurrency(), 1);
+    fmt::println("parsing {} Lox documents", corpus.fps.size());
+    time_span_t single_thread;
+    for (index_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+      const auto start   = time_point_t::now();
+      const auto results = corpus.parse(num_threads);
+      const auto took    = time_point_t::now() - start;
+      for (const auto& result: results) {
+        REQUIRE(result.pt);
+      }
+      if (num_threads == 1) {
+        single_thread = took;
+      }
+      fmt::println("{:3} threads: {} (speedup {:.2f})",
+                   num_threads,
+                   took,
+                   double(single_thread.nanos) / double(took.nanos));
+    }
+  }
+
+  TEST_CASE("lox-parse-session-performance", "[lox][seed::compiled_grammar_t][.]")
+  {
+    syntax_farm_t sf;
+    const auto si                     = seed_interpreter(sf.ptr());
+    const seed::compiled_grammar_t cg = SILVA_REQUIRE(si->compiled());
+    const name_id_t goal              = sf.name_id_of("Lox");
+
+    // Documents of about 1 KB each, made of consecutive test cases.
+    array_t<fragmentization_ptr_t> fps;
+    string_t text;
+    while (fps.size() < 10'000) {
+      for (const auto& chapter: test_suite()) {
+        for (const auto& test_case: chapter.test_cases) {
+          text += test_case.lox_code;
+          text += "\n";
+          if (text.size() >= 1024) {
+            fps.push_back(SILVA_REQUIRE(fragmentize(sf.ptr(), "doc.lox", std::move(text))));
+            text.clear();
+          }
+        }
+      }
+    }
+    fmt::println("parsing {} Lox documents of about 1 KB", fps.size());
+
+    const auto start_plain = time_point_t::now();
+    for (const auto& fp: fps) {
+      REQUIRE(cg.apply(fp, goal).has_value());
+    }
+    const auto took_plain    = time_point_t::now() - start_plain;
+    const auto start_session = time_point_t::now();
+    seed::parse_session_t session;
+    for (const auto& fp: fps) {
+      REQUIRE(cg.apply(fp, goal, session).has_value());
+    }
+    const auto took_session = time_point_t::now() - start_session;
+    fmt::println("without session: {}", took_plain);
+    fmt::println("with session:    {} (speedup {:.2f})",
+                 took_session,
+                 double(took_plain.nanos) / double(took_session.nanos));
+  }
+}
@@ -6,6 +6,8 @@
 #include "object_pool.hpp"
 
 #include "canopy/expected.hpp"
+#include "canopy/flat_hash.hpp"
+#include "canopy/inplace_function.hpp"
 
 #include "syntax/parse_tree.hpp"
 
@@ -52,8 +54,11 @@ namespace silva::lox {
     friend bool operator==(const upvalue_t&, const upvalue_t&);
   };
 
+  using builtin_impl_t =
+      inplace_function_t<expected_t<object_ref_t>(object_pool_t&, span_t<const object_ref_t>)>;
+
   struct function_builtin_t : public function_t {
-    silva::function_t<expected_t<object_ref_t>(object_pool_t&, span_t<const object_ref_t>)> impl;
+    builtin_impl_t impl;
 
     friend bool operator==(const function_builtin_t&, const function_builtin_t&);
   };
@@ -68,7 +73,7 @@ namespace silva::lox {
 
   struct class_instance_t {
     object_ref_t _class;
-    hash_map_t<token_id_t, object_ref_t> fields;
+    flat_hash_map_t<token_id_t, object_ref_t> fields;
 
     friend bool operator==(const class_instance_t&, const class_instance_t&);
   };
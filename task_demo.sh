@@ -12,12 +12,15 @@ TEMPFILE=$( mktemp )
 trap 'rm -f "$TEMPFILE"' EXIT
 
 # Simple parsing (including error message)
+# The error message and the execution trace show the rules as written, without the inlining and
+# factoring of the seed optimizer.
 "./${BUILD_DIR}/cpp/silva_fragmentization" silva/syntax/01-simple.fern
 "./${BUILD_DIR}/cpp/silva_fern" silva/syntax/01-simple.fern
-"./${BUILD_DIR}/cpp/silva_fern" silva/syntax/01-broken.fern 2>"$TEMPFILE" || true
+SEED_OPTIMIZE=false "./${BUILD_DIR}/cpp/silva_fern" silva/syntax/01-broken.fern 2>"$TEMPFILE" || true
 cat "$TEMPFILE"
 "./${BUILD_DIR}/cpp/silva_syntax" silva/syntax/01-simplest.fern
-SEED_EXEC_TRACE=true "./${BUILD_DIR}/cpp/silva_syntax" silva/syntax/01-simplest.fern --action=none
+SEED_OPTIMIZE=false SEED_EXEC_TRACE=true "./${BUILD_DIR}/cpp/silva_syntax" \
+    silva/syntax/01-simplest.fern --action=none
 
 # Parsing user-defined languages
 "./${BUILD_DIR}/cpp/silva_syntax" silva/syntax/02-example.silva